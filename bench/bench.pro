@@ -0,0 +1,66 @@
+#
+#    diecat
+#    A2L/HEX file reader.
+#
+#    File: bench.pro
+#
+#    Copyright (C) 2013-2014 Artem Petrov <pa2311@gmail.com>
+#
+#    This program is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation, either version 3 of the License, or
+#    (at your option) any later version.
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+
+# Load-time benchmark with a synthetic corpus generator.
+# QtGui is needed by the item models only, no widgets are created.
+
+QT = core gui concurrent
+
+TARGET = diecat-bench
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+include(../diecat-core.pri)
+
+INCLUDEPATH += $$PWD
+
+SOURCES += benchmain.cpp \
+    corpusgenerator.cpp \
+    ../src/labelsmodel.cpp \
+    ../src/valuesmodel.cpp
+
+HEADERS += corpusgenerator.hpp \
+    ../src/labelsmodel.hpp \
+    ../src/valuesmodel.hpp
+
+QMAKE_CXXFLAGS += -std=c++11 -W -pedantic
+
+unix: {
+    DESTDIR = ../build/unix/bin
+    MOC_DIR = ../build/unix/bench/moc
+    CONFIG (debug, debug|release) {
+        OBJECTS_DIR = ../build/unix/bench/debug
+    }
+    else {
+        OBJECTS_DIR = ../build/unix/bench/release
+    }
+}
+
+win32: {
+    DESTDIR = ../build/win/bin
+    MOC_DIR = ../build/win/bench/moc
+    CONFIG (debug, debug|release) {
+        OBJECTS_DIR = ../build/win/bench/debug
+    }
+    else {
+        OBJECTS_DIR = ../build/win/bench/release
+    }
+}
@@ -0,0 +1,316 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: benchmain.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "corpusgenerator.hpp"
+#include "constants.hpp"
+#include "a2l.hpp"
+#include "ecuscalar.hpp"
+#include "intelhex.hpp"
+#include "memoryimage.hpp"
+#include "scalarcodec.hpp"
+#include "labelindex.hpp"
+#include "labelsmodel.hpp"
+#include "valuesmodel.hpp"
+#include "trace.hpp"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QTemporaryDir>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QElapsedTimer>
+#include <QDateTime>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QSharedPointer>
+
+#include <algorithm>
+#include <cstdio>
+
+// Load-time benchmark: generates an a2l/hex corpus per size and measures
+// the load phases separately. Results are written as JSON.
+
+static const char *phaseNames[] = { "parse", "convert", "hexRead", "decode", "display" };
+static const ptrdiff_t phasesNum = sizeof(phaseNames) / sizeof(phaseNames[0]);
+
+static double elapsedMs(const QElapsedTimer &timer) {
+    return double(timer.nsecsElapsed()) / 1e6;
+}
+
+static QJsonObject summary(QVector<double> samples) {
+
+    std::sort(samples.begin(), samples.end());
+
+    QJsonObject obj;
+    obj["min_ms"] = samples.first();
+    obj["median_ms"] = samples[samples.size() / 2];
+    obj["max_ms"] = samples.last();
+
+    return obj;
+}
+
+static bool runOnce(const QString &a2lPath, const QString &hexPath, QVector< QVector<double> > &samples) {
+
+    QElapsedTimer timer;
+
+    // parse
+
+    timer.start();
+
+    A2L a2l(a2lPath);
+
+    if ( !a2l.readFile() ) {
+        return false;
+    }
+
+    samples[0].push_back(elapsedMs(timer));
+
+    // convert: parsed blocks -> scalars
+
+    timer.start();
+
+    QVector< QSharedPointer<ECUScalar> > scalars;
+    a2l.fillScalarsInfo(scalars);
+
+    samples[1].push_back(elapsedMs(timer));
+
+    // hex read
+
+    timer.start();
+
+    bool ok = false;
+    const MemoryImage image = IntelHEX::load(hexPath, &ok);
+
+    if ( !ok ) {
+        return false;
+    }
+
+    samples[2].push_back(elapsedMs(timer));
+
+    // decode
+
+    timer.start();
+
+    for ( ptrdiff_t i=0; i<scalars.size(); i++ ) {
+
+        double val = 0;
+
+        if ( !ScalarCodec::decode(*scalars[i], image, val) ) {
+            return false;
+        }
+
+        scalars[i]->setValue(ScalarCodec::toString(*scalars[i], val));
+        scalars[i]->setPhysValue(val);
+    }
+
+    samples[3].push_back(elapsedMs(timer));
+
+    // display: models and search index as the GUI builds them, every
+    // label shown in the values table, every cell fetched once
+
+    timer.start();
+
+    LabelsModel labelsModel;
+    ValuesModel valuesModel;
+    LabelIndex labelIndex;
+
+    labelsModel.setScalars(scalars);
+    valuesModel.setScalars(scalars);
+    labelIndex.build(scalars);
+
+    QVector<ptrdiff_t> all(scalars.size());
+
+    for ( ptrdiff_t i=0; i<all.size(); i++ ) {
+        all[i] = i;
+    }
+
+    valuesModel.addScalars(all);
+    labelsModel.setInTable(all, true);
+
+    ptrdiff_t chars = 0;
+
+    for ( ptrdiff_t row=0; row<valuesModel.rowCount(); row++ ) {
+
+        chars += labelsModel.data(labelsModel.index(row, 0)).toString().size();
+
+        for ( ptrdiff_t col=0; col<valuesModel.columnCount(); col++ ) {
+            chars += valuesModel.data(valuesModel.index(row, col)).toString().size();
+        }
+    }
+
+    samples[4].push_back(elapsedMs(timer));
+
+    return chars > 0;
+}
+
+int main(int argc, char *argv[]) {
+
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QString(PROGNAME) + "-bench");
+    QCoreApplication::setApplicationVersion(QString(PROGVER));
+
+    QTextStream err(stderr);
+
+    //
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Measures a2l/hex load phases on generated files.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    const QCommandLineOption sizesOption("sizes", "Comma separated numbers of characteristics.", "list", "1000,10000,100000");
+    const QCommandLineOption methodsOption("compu-methods", "Numeric conversion methods (default: one per 20 characteristics).", "num", "0");
+    const QCommandLineOption vtabShareOption("vtab-share", "Part of the characteristics with a value table.", "share", "0.1");
+    const QCommandLineOption vtabEntriesOption("vtab-entries", "Entries per value table.", "num", "8");
+    const QCommandLineOption segmentsOption("segments", "Memory segments (fragmentation of the image).", "num", "16");
+    const QCommandLineOption imageSizeOption("image-size", "Minimal image size in bytes.", "bytes", "0");
+    const QCommandLineOption repeatOption("repeat", "Runs per size.", "num", "3");
+    const QCommandLineOption seedOption("seed", "Random seed of the generator.", "num", "1");
+    const QCommandLineOption corpusOption("corpus-dir", "Keep the generated files in this directory.", "dir");
+    const QCommandLineOption outputOption(QStringList() << "o" << "output", "JSON result file (standard output by default).", "file");
+
+    parser.addOption(sizesOption);
+    parser.addOption(methodsOption);
+    parser.addOption(vtabShareOption);
+    parser.addOption(vtabEntriesOption);
+    parser.addOption(segmentsOption);
+    parser.addOption(imageSizeOption);
+    parser.addOption(repeatOption);
+    parser.addOption(seedOption);
+    parser.addOption(corpusOption);
+    parser.addOption(outputOption);
+    parser.process(app);
+
+    Trace::instance().setEnabled(false); // the phases are timed here
+
+    const QStringList sizes = parser.value(sizesOption).split(',', SKIPEMPTYPARTS);
+    const ptrdiff_t repeat = qMax(1, parser.value(repeatOption).toInt());
+
+    QTemporaryDir tmpDir;
+    const QString corpusDir = parser.isSet(corpusOption) ? parser.value(corpusOption) : tmpDir.path();
+
+    if ( !QDir().mkpath(corpusDir) ) {
+        err << "Can not create " << corpusDir << "!\n";
+        return 1;
+    }
+
+    //
+
+    QJsonArray runs;
+
+    for ( ptrdiff_t n=0; n<sizes.size(); n++ ) {
+
+        CorpusGenerator gen;
+        gen.setCharacteristics(sizes[n].toLongLong());
+        gen.setCompuMethods(parser.value(methodsOption).toLongLong());
+        gen.setVTabShare(parser.value(vtabShareOption).toDouble());
+        gen.setVTabEntries(parser.value(vtabEntriesOption).toLongLong());
+        gen.setSegments(parser.value(segmentsOption).toLongLong());
+        gen.setImageSize(parser.value(imageSizeOption).toUInt());
+        gen.setSeed(parser.value(seedOption).toUInt());
+
+        const QString base = corpusDir + "/bench_" + QString::number(gen.characteristics());
+        const QString a2lPath = base + ".a2l";
+        const QString hexPath = base + ".hex";
+
+        err << "Generating " << gen.characteristics() << " characteristics...\n";
+        err.flush();
+
+        QElapsedTimer timer;
+        timer.start();
+
+        if ( !gen.generate(a2lPath, hexPath) ) {
+            err << "Can not write the corpus to " << corpusDir << "!\n";
+            return 1;
+        }
+
+        const double genMs = elapsedMs(timer);
+
+        QVector< QVector<double> > samples(phasesNum);
+
+        for ( ptrdiff_t r=0; r<repeat; r++ ) {
+
+            if ( !runOnce(a2lPath, hexPath, samples) ) {
+                err << "Loading of " << a2lPath << " failed!\n";
+                return 1;
+            }
+        }
+
+        QJsonObject phases;
+        QVector<double> totals(repeat, 0);
+
+        for ( ptrdiff_t p=0; p<phasesNum; p++ ) {
+
+            phases[phaseNames[p]] = summary(samples[p]);
+
+            for ( ptrdiff_t r=0; r<repeat; r++ ) {
+                totals[r] += samples[p][r];
+            }
+        }
+
+        phases["total"] = summary(totals);
+
+        QJsonObject run;
+        run["characteristics"] = double(gen.characteristics());
+        run["compuMethods"] = double(gen.compuMethods());
+        run["vtabShare"] = gen.vTabShare();
+        run["segments"] = double(gen.segments());
+        run["a2lBytes"] = double(QFileInfo(a2lPath).size());
+        run["hexBytes"] = double(QFileInfo(hexPath).size());
+        run["generate_ms"] = genMs;
+        run["phases"] = phases;
+
+        runs.append(run);
+    }
+
+    QJsonObject result;
+    result["program"] = QString(PROGNAME);
+    result["version"] = QString(PROGVER);
+    result["date"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    result["repeat"] = double(repeat);
+    result["runs"] = runs;
+
+    const QByteArray json = QJsonDocument(result).toJson();
+
+    QFile outFile;
+    bool ok = false;
+
+    if ( parser.isSet(outputOption) ) {
+        outFile.setFileName(parser.value(outputOption));
+        ok = outFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    }
+    else {
+        ok = outFile.open(stdout, QIODevice::WriteOnly);
+    }
+
+    if ( !ok || outFile.write(json) != json.size() ) {
+        err << "Can not write the results!\n";
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,270 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: corpusgenerator.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "corpusgenerator.hpp"
+#include "bufferedwriter.hpp"
+#include "memoryimage.hpp"
+#include "intelhex.hpp"
+
+#include <QFile>
+#include <QVector>
+#include <QByteArray>
+
+#include <random>
+#include <cstring>
+#include <cstdio>
+
+struct NumType {
+    const char *name;
+    ptrdiff_t len;
+    bool isSigned;
+    bool isFloat;
+};
+
+static const NumType numTypes[] = {
+    { "Wu8",  1, false, false },
+    { "Wu16", 2, false, false },
+    { "Wu32", 4, false, false },
+    { "Ws8",  1, true,  false },
+    { "Ws16", 2, true,  false },
+    { "Ws32", 4, true,  false },
+    { "Wr32", 4, true,  true  }
+};
+
+static const ptrdiff_t numTypesNum = sizeof(numTypes) / sizeof(numTypes[0]);
+
+static const quint32 imageBase = 0x80000000;
+
+static void writeLine(BufferedWriter &out, const char *str) {
+
+    out.write("    ", 4);
+    out.write(str);
+    out.put('\n');
+}
+
+static void writeLine(BufferedWriter &out, const char *prefix, qint64 num, const char *suffix = "") {
+
+    out.write("    ", 4);
+    out.write(prefix);
+    out.writeInt(num);
+    out.write(suffix);
+    out.put('\n');
+}
+
+CorpusGenerator::CorpusGenerator() {
+}
+
+void CorpusGenerator::setCharacteristics(ptrdiff_t num) {
+    m_characteristics = qMax(ptrdiff_t(1), num);
+}
+
+void CorpusGenerator::setCompuMethods(ptrdiff_t num) {
+    m_compuMethods = qMax(ptrdiff_t(0), num);
+}
+
+void CorpusGenerator::setVTabShare(double share) {
+    m_vtabShare = qBound(0.0, share, 1.0);
+}
+
+void CorpusGenerator::setVTabEntries(ptrdiff_t num) {
+    m_vtabEntries = qBound(ptrdiff_t(1), num, ptrdiff_t(256));
+}
+
+void CorpusGenerator::setSegments(ptrdiff_t num) {
+    m_segments = qMax(ptrdiff_t(1), num);
+}
+
+void CorpusGenerator::setImageSize(quint32 size) {
+    m_imageSize = size;
+}
+
+void CorpusGenerator::setSeed(quint32 seed) {
+    m_seed = seed;
+}
+
+bool CorpusGenerator::generate(const QString &a2lPath, const QString &hexPath) const {
+
+    std::mt19937 rng(m_seed);
+
+    const ptrdiff_t methodsNum = compuMethods();
+    const ptrdiff_t vtabChars = ptrdiff_t(m_characteristics * m_vtabShare);
+    const ptrdiff_t vtabsNum = vtabChars > 0 ? qMax(ptrdiff_t(1), vtabChars / 50) : 0;
+
+    // memory: equally sized segments with gaps between them
+
+    const quint32 segCapacity = qMax(m_imageSize / quint32(m_segments),
+                                     quint32((m_characteristics / m_segments + 1) * 8));
+    const quint32 segStride = ((segCapacity + 0x1000) + 0xFFFF) & ~quint32(0xFFFF);
+
+    QVector<QByteArray> segs(m_segments);
+    QVector<quint32> cursors(m_segments, 0);
+
+    for ( ptrdiff_t s=0; s<m_segments; s++ ) {
+
+        segs[s].resize(segCapacity);
+
+        for ( quint32 i=0; i<segCapacity; i++ ) {
+            segs[s][i] = char(rng() & 0xFF);
+        }
+    }
+
+    //
+
+    QFile a2lFile(a2lPath);
+
+    if ( !a2lFile.open(QIODevice::WriteOnly | QIODevice::Truncate) ) {
+        return false;
+    }
+
+    BufferedWriter out(&a2lFile);
+
+    out.write("ASAP2_VERSION 1 60\n/begin PROJECT bench \"\"\n/begin MODULE bench \"\"\n\n");
+
+    for ( ptrdiff_t m=0; m<methodsNum; m++ ) {
+
+        out.write("/begin COMPU_METHOD\n");
+        writeLine(out, "CM_", m);
+        writeLine(out, "\"bench conversion ", m, "\"");
+        writeLine(out, "RAT_FUNC");
+        writeLine(out, "\"%8.", m % 4, "\"");
+        writeLine(out, "\"u", m % 17, "\"");
+        writeLine(out, "COEFFS 0 1 ", m % 50, " 0 0 1");
+        out.write("/end COMPU_METHOD\n\n");
+    }
+
+    for ( ptrdiff_t v=0; v<vtabsNum; v++ ) {
+
+        out.write("/begin COMPU_METHOD\n");
+        writeLine(out, "CM_VT_", v);
+        writeLine(out, "\"bench verbal conversion ", v, "\"");
+        writeLine(out, "TAB_VERB");
+        writeLine(out, "\"%0.0\"");
+        writeLine(out, "\"\"");
+        writeLine(out, "COMPU_TAB_REF VT_", v);
+        out.write("/end COMPU_METHOD\n\n");
+
+        out.write("/begin COMPU_VTAB\n");
+        writeLine(out, "VT_", v);
+        writeLine(out, "\"bench table ", v, "\"");
+        writeLine(out, "TAB_VERB");
+        writeLine(out, "", m_vtabEntries);
+
+        for ( ptrdiff_t e=0; e<m_vtabEntries; e++ ) {
+            out.write("    ", 4);
+            out.writeInt(e);
+            out.write(" \"state_");
+            out.writeInt(e);
+            out.write("\"\n");
+        }
+
+        out.write("/end COMPU_VTAB\n\n");
+    }
+
+    for ( ptrdiff_t i=0; i<m_characteristics; i++ ) {
+
+        const bool vtab = i < vtabChars;
+        const NumType &type = vtab ? numTypes[i % 2] : numTypes[rng() % numTypesNum];
+
+        // address: round robin over the segments, aligned to the size
+
+        const ptrdiff_t s = i % m_segments;
+        cursors[s] = quint32(cursors[s] + type.len - 1) & ~quint32(type.len - 1);
+
+        const quint32 addr = imageBase + quint32(s) * segStride + cursors[s];
+        char *data = segs[s].data() + cursors[s];
+        cursors[s] += type.len;
+
+        if ( vtab ) {
+            const quint32 raw = rng() % quint32(m_vtabEntries);
+            memset(data, 0, type.len);
+            data[type.len-1] = char(raw);
+        }
+        else if ( type.isFloat ) {
+
+            const float val = float(rng() % 100000) / 100.0f;
+            quint32 bits = 0;
+            memcpy(&bits, &val, sizeof(bits));
+
+            for ( ptrdiff_t b=0; b<4; b++ ) {
+                data[b] = char(bits >> (8 * (3 - b)));
+            }
+        }
+
+        const qint64 maxRaw = (qint64(1) << (8 * type.len - (type.isSigned ? 1 : 0))) - 1;
+        const qint64 minRaw = type.isSigned ? -maxRaw - 1 : 0;
+
+        out.write("/begin CHARACTERISTIC\n");
+        writeLine(out, "C_", i);
+        writeLine(out, "\"bench characteristic ", i, "\"");
+        writeLine(out, "VALUE");
+
+        char addrStr[16];
+        snprintf(addrStr, sizeof(addrStr), "0x%08X", addr);
+        writeLine(out, addrStr);
+
+        out.write("    Scalar_");
+        out.write(type.name);
+        out.put('\n');
+        writeLine(out, "0");
+
+        if ( vtab ) {
+            writeLine(out, "CM_VT_", i % vtabsNum);
+            writeLine(out, "0");
+            writeLine(out, "", m_vtabEntries - 1);
+        }
+        else {
+            writeLine(out, "CM_", i % methodsNum);
+            writeLine(out, "", minRaw / 2);
+            writeLine(out, "", maxRaw / 2);
+        }
+
+        writeLine(out, "FORMAT \"%8.", i % 4, "\"");
+
+        out.write("    EXTENDED_LIMITS ");
+        out.writeInt(minRaw);
+        out.put(' ');
+        out.writeInt(maxRaw);
+        out.put('\n');
+
+        if ( (i % 10) == 0 ) {
+            writeLine(out, "READ_ONLY");
+        }
+
+        out.write("/end CHARACTERISTIC\n\n");
+    }
+
+    out.write("/end MODULE\n/end PROJECT\n");
+
+    if ( !out.flush() ) {
+        return false;
+    }
+
+    a2lFile.close();
+
+    //
+
+    MemoryImage image;
+
+    for ( ptrdiff_t s=0; s<m_segments; s++ ) {
+        image.write(imageBase + quint32(s) * segStride, segs[s].constData(), segs[s].size());
+    }
+
+    return IntelHEX::writeHex(hexPath, image);
+}
@@ -0,0 +1,66 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: corpusgenerator.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CORPUSGENERATOR_HPP
+#define CORPUSGENERATOR_HPP
+
+#include <QString>
+
+// Writes a synthetic a2l/hex pair in the subset of the format diecat reads.
+// The same settings and seed always give the same files.
+
+class CorpusGenerator {
+
+public:
+    CorpusGenerator();
+    void setCharacteristics(ptrdiff_t);
+    void setCompuMethods(ptrdiff_t);   // numeric methods, 0 - one per 20 characteristics
+    void setVTabShare(double);         // part of the characteristics with a VTAB
+    void setVTabEntries(ptrdiff_t);
+    void setSegments(ptrdiff_t);       // contiguous memory segments
+    void setImageSize(quint32);        // bytes, 0 - as small as possible
+    void setSeed(quint32);
+    bool generate(const QString &, const QString &) const; // a2l path, hex path
+
+    ptrdiff_t characteristics() const {
+        return m_characteristics;
+    }
+    ptrdiff_t compuMethods() const {
+        return m_compuMethods > 0 ? m_compuMethods : qMax(ptrdiff_t(1), m_characteristics / 20);
+    }
+    double vTabShare() const {
+        return m_vtabShare;
+    }
+    ptrdiff_t segments() const {
+        return m_segments;
+    }
+
+private:
+    ptrdiff_t m_characteristics = 1000;
+    ptrdiff_t m_compuMethods = 0;
+    double m_vtabShare = 0.1;
+    ptrdiff_t m_vtabEntries = 8;
+    ptrdiff_t m_segments = 16;
+    quint32 m_imageSize = 0;
+    quint32 m_seed = 1;
+
+};
+
+#endif // CORPUSGENERATOR_HPP
@@ -0,0 +1,33 @@
+#
+#    diecat
+#    A2L/HEX file reader.
+#
+#    File: diecat-all.pro
+#
+#    Copyright (C) 2013-2014 Artem Petrov <pa2311@gmail.com>
+#
+#    This program is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation, either version 3 of the License, or
+#    (at your option) any later version.
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+
+# Builds the GUI, the command-line tool, the query daemon, the XCP
+# recorder, libdiecat and the benchmark.
+
+TEMPLATE = subdirs
+
+SUBDIRS = gui cli daemon xcp lib bench
+
+gui.file = diecat.pro
+cli.file = diecat-cli.pro
+daemon.file = diecat-daemon.pro
+xcp.file = diecat-xcp.pro
+lib.file = libdiecat.pro
+bench.file = bench/bench.pro
@@ -0,0 +1,88 @@
+#
+#    diecat
+#    A2L/HEX file reader.
+#
+#    File: diecat-core.pri
+#
+#    Copyright (C) 2013-2014 Artem Petrov <pa2311@gmail.com>
+#
+#    This program is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation, either version 3 of the License, or
+#    (at your option) any later version.
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+
+# A2L/HEX code shared by the GUI and the command-line tool.
+# Depends on QtCore, QtConcurrent, zlib and liblzma.
+
+QT += concurrent
+
+INCLUDEPATH += $$PWD/src
+
+SOURCES += $$PWD/src/a2l.cpp \
+    $$PWD/src/ecuscalar.cpp \
+    $$PWD/src/intelhex.cpp \
+    $$PWD/src/memoryimage.cpp \
+    $$PWD/src/imageoverlay.cpp \
+    $$PWD/src/scalarcodec.cpp \
+    $$PWD/src/checksum.cpp \
+    $$PWD/src/imagediff.cpp \
+    $$PWD/src/fleetcompare.cpp \
+    $$PWD/src/limitcheck.cpp \
+    $$PWD/src/labelindex.cpp \
+    $$PWD/src/addressindex.cpp \
+    $$PWD/src/loadcontrol.cpp \
+    $$PWD/src/compressedfile.cpp \
+    $$PWD/src/a2lcache.cpp \
+    $$PWD/src/bufferedwriter.cpp \
+    $$PWD/src/valueexport.cpp \
+    $$PWD/src/dcmimport.cpp \
+    $$PWD/src/trace.cpp
+
+HEADERS += $$PWD/src/constants.hpp \
+    $$PWD/src/a2l.hpp \
+    $$PWD/src/ecuscalar.hpp \
+    $$PWD/src/intelhex.hpp \
+    $$PWD/src/memoryimage.hpp \
+    $$PWD/src/imageoverlay.hpp \
+    $$PWD/src/scalarcodec.hpp \
+    $$PWD/src/checksum.hpp \
+    $$PWD/src/imagediff.hpp \
+    $$PWD/src/fleetcompare.hpp \
+    $$PWD/src/limitcheck.hpp \
+    $$PWD/src/labelindex.hpp \
+    $$PWD/src/addressindex.hpp \
+    $$PWD/src/loadcontrol.hpp \
+    $$PWD/src/compressedfile.hpp \
+    $$PWD/src/a2lcache.hpp \
+    $$PWD/src/bufferedwriter.hpp \
+    $$PWD/src/valueexport.hpp \
+    $$PWD/src/dcmimport.hpp \
+    $$PWD/src/trace.hpp
+
+# qmake CONFIG+=trace_allocations counts heap allocations for the
+# performance summary (replaces the global operator new)
+
+trace_allocations {
+    DEFINES += DIECAT_TRACE_ALLOCATIONS
+}
+
+# gzip and xz input need zlib and liblzma; qmake CONFIG+=no_compression
+# builds without them and only reads plain files
+
+no_compression {
+    DEFINES += DIECAT_NO_COMPRESSION
+}
+else {
+    LIBS += -lz -llzma
+}
+
+win32: {
+    LIBS += -lpsapi
+}
@@ -0,0 +1,30 @@
+#
+#    diecat
+#    A2L/HEX file reader.
+#
+#    File: diecat-xcp.pri
+#
+#    Copyright (C) 2013-2014 Artem Petrov <pa2311@gmail.com>
+#
+#    This program is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation, either version 3 of the License, or
+#    (at your option) any later version.
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+
+# XCP-on-UDP measurement client and the localhost slave simulator.
+# Include after diecat-core.pri.
+
+QT += network
+
+SOURCES += $$PWD/src/xcpclient.cpp \
+    $$PWD/src/xcpsimulator.cpp
+
+HEADERS += $$PWD/src/xcpclient.hpp \
+    $$PWD/src/xcpsimulator.hpp
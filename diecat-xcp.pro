@@ -0,0 +1,57 @@
+#
+#    diecat
+#    A2L/HEX file reader.
+#
+#    File: diecat-xcp.pro
+#
+#    Copyright (C) 2013-2014 Artem Petrov <pa2311@gmail.com>
+#
+#    This program is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation, either version 3 of the License, or
+#    (at your option) any later version.
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+
+QT = core network concurrent
+
+TARGET = diecat-xcp
+TEMPLATE = app
+CONFIG += console
+CONFIG -= app_bundle
+
+include(diecat-core.pri)
+include(diecat-xcp.pri)
+
+SOURCES += src/xcpmain.cpp
+
+QMAKE_CXXFLAGS += -std=c++11 -W -pedantic
+
+unix: {
+    DESTDIR = build/unix/bin
+    MOC_DIR = build/unix/xcp/moc
+    CONFIG (debug, debug|release) {
+        OBJECTS_DIR = build/unix/xcp/debug
+    }
+    else {
+        OBJECTS_DIR = build/unix/xcp/release
+    }
+    target.path = $$PREFIX/bin
+    INSTALLS += target
+}
+
+win32: {
+    DESTDIR = build/win/bin
+    MOC_DIR = build/win/xcp/moc
+    CONFIG (debug, debug|release) {
+        OBJECTS_DIR = build/win/xcp/debug
+    }
+    else {
+        OBJECTS_DIR = build/win/xcp/release
+    }
+}
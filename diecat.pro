@@ -18,27 +18,50 @@
 #    along with this program. If not, see <http://www.gnu.org/licenses/>.
 #
 
-QT += core gui widgets
+QT += core gui widgets concurrent network
 
 TARGET = diecat
 TEMPLATE = app
 
+include(diecat-core.pri)
+include(diecat-xcp.pri)
+
 SOURCES += src/main.cpp \
     src/mainwindow.cpp \
-    src/a2l.cpp \
-    src/ecuscalar.cpp \
-    src/intelhex.cpp \
-    src/labelinfodialog.cpp
+    src/labelinfodialog.cpp \
+    src/tracedialog.cpp \
+    src/livemeasurementdialog.cpp \
+    src/liveplotwidget.cpp \
+    src/liveacquisition.cpp \
+    src/signalhistory.cpp \
+    src/samplering.cpp \
+    src/labelsmodel.cpp \
+    src/labelsfiltermodel.cpp \
+    src/valuesmodel.cpp \
+    src/valuesdelegate.cpp \
+    src/projectloader.cpp \
+    src/projectwidget.cpp
 
 HEADERS += src/mainwindow.hpp \
-    src/constants.hpp \
-    src/a2l.hpp \
-    src/ecuscalar.hpp \
-    src/intelhex.hpp \
-    src/labelinfodialog.hpp
+    src/labelinfodialog.hpp \
+    src/tracedialog.hpp \
+    src/livemeasurementdialog.hpp \
+    src/liveplotwidget.hpp \
+    src/liveacquisition.hpp \
+    src/signalhistory.hpp \
+    src/samplering.hpp \
+    src/labelsmodel.hpp \
+    src/labelsfiltermodel.hpp \
+    src/valuesmodel.hpp \
+    src/valuesdelegate.hpp \
+    src/projectloader.hpp \
+    src/projectwidget.hpp
 
 FORMS += forms/mainwindow.ui \
-    forms/labelinfodialog.ui
+    forms/labelinfodialog.ui \
+    forms/tracedialog.ui \
+    forms/livemeasurementdialog.ui \
+    forms/projectwidget.ui
 
 RESOURCES = res/diecat.qrc
 RC_FILE += res/diecat.rc
@@ -0,0 +1,70 @@
+#
+#    diecat
+#    A2L/HEX file reader.
+#
+#    File: libdiecat.pro
+#
+#    Copyright (C) 2013-2014 Artem Petrov <pa2311@gmail.com>
+#
+#    This program is free software: you can redistribute it and/or modify
+#    it under the terms of the GNU General Public License as published by
+#    the Free Software Foundation, either version 3 of the License, or
+#    (at your option) any later version.
+#    This program is distributed in the hope that it will be useful,
+#    but WITHOUT ANY WARRANTY; without even the implied warranty of
+#    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+#    GNU General Public License for more details.
+#    You should have received a copy of the GNU General Public License
+#    along with this program. If not, see <http://www.gnu.org/licenses/>.
+#
+
+# libdiecat: the a2l/hex core as a library with a C interface (src/diecat.h)
+# for in-process use from other tools. Shared by default,
+# qmake CONFIG+=diecat_static builds a static library.
+
+QT = core concurrent
+
+TARGET = diecat
+TEMPLATE = lib
+VERSION = 0.3.3
+
+DEFINES += DIECAT_LIBRARY
+
+diecat_static {
+    CONFIG += staticlib
+    DEFINES += DIECAT_STATIC
+}
+
+include(diecat-core.pri)
+
+SOURCES += src/diecatapi.cpp
+
+HEADERS += src/diecat.h
+
+QMAKE_CXXFLAGS += -std=c++11 -W -pedantic
+
+unix: {
+    DESTDIR = build/unix/lib
+    MOC_DIR = build/unix/lib/moc
+    CONFIG (debug, debug|release) {
+        OBJECTS_DIR = build/unix/lib/debug
+    }
+    else {
+        OBJECTS_DIR = build/unix/lib/release
+    }
+    target.path = $$PREFIX/lib
+    headers.files = src/diecat.h
+    headers.path = $$PREFIX/include
+    INSTALLS += target headers
+}
+
+win32: {
+    DESTDIR = build/win/lib
+    MOC_DIR = build/win/lib/moc
+    CONFIG (debug, debug|release) {
+        OBJECTS_DIR = build/win/lib/debug
+    }
+    else {
+        OBJECTS_DIR = build/win/lib/release
+    }
+}
@@ -20,30 +20,99 @@
 
 #include "a2l.hpp"
 #include "constants.hpp"
+#include "trace.hpp"
+#include "a2lcache.hpp"
+#include "compressedfile.hpp"
 
 #include <QVector>
 #include <QString>
-#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QSet>
 #include <QSharedPointer>
+#include <QtConcurrent/QtConcurrentMap>
 
 A2L::A2L(const QString &path) {
     m_a2lpath = path;
 }
 
+void A2L::setLoadControl(LoadControl *control) {
+    m_control = control;
+}
+
 bool A2L::readFile() {
 
-    QFile a2lfile(m_a2lpath);
+    TraceScope trace("a2l.parse");
+
+    clear();
+
+    CompressedFile a2lfile(m_a2lpath); // plain, gzip or xz
 
     if ( !a2lfile.open(QIODevice::ReadOnly | QIODevice::Text) ) {
         return false;
     }
 
+    A2LBlocks blocks;
+
+    if ( !parseBlocks(&a2lfile, blocks, m_control) || !a2lfile.isOk() ) {
+        a2lfile.close();
+        return false;
+    }
+
+    blocks.bytes = a2lfile.progressSize();
+
+    a2lfile.close();
+    appendBlocks(blocks);
+
+    // included files, level by level
+
+    const QString dir = QFileInfo(m_a2lpath).absolutePath();
+    QStringList pending;
+
+    for ( ptrdiff_t i=0; i<blocks.includes.size(); i++ ) {
+        pending.push_back(resolveInclude(blocks.includes[i], dir));
+    }
+
+    if ( !pending.isEmpty() && !readIncludes(pending) ) {
+        clear();
+        return false;
+    }
+
+    Trace::instance().count("a2l.bytes", blocks.bytes);
+    Trace::instance().count("a2l.characteristics", m_scalarsInfo.size());
+    Trace::instance().count("a2l.compuMethods", m_compumethodsInfo.size());
+    Trace::instance().count("a2l.compuVTabs", m_compuvtabsInfo.size());
+    Trace::instance().count("a2l.measurements", m_measurementsInfo.size());
+
+    return true;
+}
+
+bool A2L::parseBlocks(QIODevice *a2lfile, A2LBlocks &blocks, LoadControl *control) {
+
     QString str;
     QStringList strlst;
+    ptrdiff_t n = 0;
+
+    const CompressedFile *file = qobject_cast<const CompressedFile *>(a2lfile);
+
+    while ( !a2lfile->atEnd() ) {
+
+        if ( control && (++n % LOADCHECKINTERVAL) == 0 ) {
 
-    while ( !a2lfile.atEnd() ) {
+            if ( file ) {
+                control->setProgress(file->progressPos(), file->progressSize());
+            }
+            else {
+                control->setProgress(a2lfile->pos(), a2lfile->size());
+            }
+            control->setObjects(blocks.characteristics.size());
+
+            if ( control->isCanceled() ) {
+                return false;
+            }
+        }
 
-        str = a2lfile.readLine().simplified();
+        str = a2lfile->readLine().simplified();
 
         if ( str.isEmpty() ) {
             continue;
@@ -51,9 +120,9 @@ bool A2L::readFile() {
 
         if ( str == "/begin CHARACTERISTIC" ) {
 
-            while ( !a2lfile.atEnd() ) {
+            while ( !a2lfile->atEnd() ) {
 
-                str = a2lfile.readLine().simplified();
+                str = a2lfile->readLine().simplified();
 
                 if ( str.isEmpty() ) {
                     continue;
@@ -69,7 +138,7 @@ bool A2L::readFile() {
             if ( strlst.size() > A2LCHARBLOCKMINSIZE-1 ) {
 
                 if ( strlst[2] == "VALUE" ){  // temporary only clear scalaras
-                    m_scalarsInfo.push_back(strlst);
+                    blocks.characteristics.push_back(strlst);
                 }
             }
 
@@ -77,9 +146,9 @@ bool A2L::readFile() {
         }
         else if ( str == "/begin COMPU_METHOD" ) {
 
-            while ( !a2lfile.atEnd() ) {
+            while ( !a2lfile->atEnd() ) {
 
-                str = a2lfile.readLine().simplified();
+                str = a2lfile->readLine().simplified();
 
                 if ( str.isEmpty() ) {
                     continue;
@@ -93,16 +162,16 @@ bool A2L::readFile() {
             }
 
             if ( strlst.size() == A2LCOMPUMETHODSIZE ) {
-                m_compumethodsInfo.push_back(strlst);
+                blocks.compuMethods.push_back(strlst);
             }
 
             strlst.clear();
         }
         else if ( str == "/begin COMPU_VTAB" ) {
 
-            while ( !a2lfile.atEnd() ) {
+            while ( !a2lfile->atEnd() ) {
 
-                str = a2lfile.readLine().simplified();
+                str = a2lfile->readLine().simplified();
 
                 if ( str.isEmpty() ) {
                     continue;
@@ -116,20 +185,133 @@ bool A2L::readFile() {
             }
 
             if ( strlst.size() > A2LCOMPUVTABMINSIZE-1 ) {
-                m_compuvtabsInfo.push_back(strlst);
+                blocks.compuVTabs.push_back(strlst);
             }
 
             strlst.clear();
         }
+        else if ( str == "/begin MEASUREMENT" ) {
+
+            while ( !a2lfile->atEnd() ) {
+
+                str = a2lfile->readLine().simplified();
+
+                if ( str.isEmpty() ) {
+                    continue;
+                }
+
+                if ( str == "/end MEASUREMENT" ) {
+                    break;
+                }
+
+                strlst.push_back(str);
+            }
+
+            if ( strlst.size() > A2LMEASUREMENTMINSIZE-1 ) {
+                blocks.measurements.push_back(strlst);
+            }
+
+            strlst.clear();
+        }
+        else if ( str.startsWith("/include ") ) {
+            blocks.includes.push_back(str.mid(9));
+        }
     }
 
-    a2lfile.close();
+    return true;
+}
+
+QSharedPointer<const A2LBlocks> A2L::parseInclude(const QString &path) {
+
+    return A2LCache::instance().includeBlocks(path);
+}
+
+QString A2L::resolveInclude(const QString &directive, const QString &dir) {
+
+    QString name = directive.trimmed();
+
+    if ( name.size() > 1 && name.startsWith('"') && name.endsWith('"') ) {
+        name = name.mid(1, name.size() - 2);
+    }
+
+    name.replace('\\', '/');
+
+    const QFileInfo info(QDir(dir), name);
+
+    return info.exists() ? info.canonicalFilePath() : info.absoluteFilePath();
+}
+
+void A2L::appendBlocks(const A2LBlocks &blocks) {
+
+    m_scalarsInfo += blocks.characteristics;
+    m_compumethodsInfo += blocks.compuMethods;
+    m_compuvtabsInfo += blocks.compuVTabs;
+    m_measurementsInfo += blocks.measurements;
+}
+
+bool A2L::readIncludes(const QStringList &includes) {
+
+    TraceScope trace("a2l.includes");
+
+    QSet<QString> visited;
+    visited.insert(QFileInfo(m_a2lpath).canonicalFilePath());
+
+    QStringList pending = includes;
+
+    for ( ptrdiff_t depth=0; !pending.isEmpty(); depth++ ) {
+
+        if ( depth == A2LMAXINCLUDEDEPTH ) {
+            return false;
+        }
+
+        // every file once, an include cycle ends here
+
+        QStringList level;
+
+        for ( ptrdiff_t i=0; i<pending.size(); i++ ) {
+
+            if ( !visited.contains(pending[i]) ) {
+                visited.insert(pending[i]);
+                level.push_back(pending[i]);
+            }
+        }
+
+        const QList< QSharedPointer<const A2LBlocks> > parsed =
+                QtConcurrent::blockingMapped< QList< QSharedPointer<const A2LBlocks> > >(level, &A2L::parseInclude);
+
+        if ( m_control && m_control->isCanceled() ) {
+            return false;
+        }
+
+        pending.clear();
+
+        for ( ptrdiff_t i=0; i<parsed.size(); i++ ) {
+
+            if ( !parsed[i] ) { // missing or unreadable include
+                return false;
+            }
+
+            appendBlocks(*parsed[i]);
+            m_includedFiles.push_back(level[i]);
+
+            Trace::instance().count("a2l.includes", 1);
+            Trace::instance().count("a2l.bytes", parsed[i]->bytes);
+
+            const QString dir = QFileInfo(level[i]).absolutePath();
+
+            for ( ptrdiff_t j=0; j<parsed[i]->includes.size(); j++ ) {
+                pending.push_back(resolveInclude(parsed[i]->includes[j], dir));
+            }
+        }
+    }
 
     return true;
 }
 
 void A2L::fillScalarsInfo(QVector< QSharedPointer<ECUScalar> > &scalars) const {
 
+    TraceScope trace("a2l.convert");
+
     for ( ptrdiff_t i=0; i<m_scalarsInfo.size(); i++ ) {
 
         QSharedPointer<ECUScalar> scal(new ECUScalar());
@@ -167,12 +349,129 @@ void A2L::fillScalarsInfo(QVector< QSharedPointer<ECUScalar> > &scalars) const {
 
         scalars.push_back(scal);
     }
+
+    Trace::instance().count("a2l.scalars", m_scalarsInfo.size());
+}
+
+void A2L::fillMeasurementsInfo(QVector< QSharedPointer<ECUScalar> > &measurements) const {
+
+    // name, description, data type, conversion, resolution, accuracy,
+    // lower limit, upper limit, then optional keywords like ECU_ADDRESS
+
+    for ( ptrdiff_t i=0; i<m_measurementsInfo.size(); i++ ) {
+
+        const QStringList &info = m_measurementsInfo[i];
+        QString address;
+
+        for ( ptrdiff_t j=A2LMEASUREMENTMINSIZE; j<info.size(); j++ ) {
+
+            if ( info[j].startsWith("ECU_ADDRESS ") ) {
+                address = info[j].split(' ').last();
+                break;
+            }
+        }
+
+        const QString numType = measurementNumType(info[2]);
+
+        if ( address.isEmpty() || numType.isEmpty() ) { // virtual or unsupported
+            continue;
+        }
+
+        QSharedPointer<ECUScalar> meas(new ECUScalar());
+
+        const ptrdiff_t compuMethodInd = findCompuMethod(info[3]);
+
+        if ( compuMethodInd >= 0 ) {
+
+            if ( m_compumethodsInfo[compuMethodInd][2] == "RAT_FUNC" ) {
+                meas->setCoefficients(getCoeff(compuMethodInd));
+            }
+            else if ( m_compumethodsInfo[compuMethodInd][2] == "TAB_VERB" ) {
+
+                meas->setType(VARTYPE_SCALAR_VTAB);
+
+                const ptrdiff_t compuVTabInd = findCompuVTab(m_compumethodsInfo[compuMethodInd][5].split(' ').last());
+                meas->setVTable(getVTab(compuVTabInd));
+            }
+
+            meas->setPrecision(delQuotes(m_compumethodsInfo[compuMethodInd][3].split('.').last()).toInt());
+            meas->setDimension("[" + delQuotes(m_compumethodsInfo[compuMethodInd][4]) + "]");
+        }
+        else { // NO_COMPU_METHOD
+            meas->setDimension("[]");
+        }
+
+        meas->setName(info[0]);
+        meas->setShortDescription(delQuotes(info[1]));
+        meas->setAddress(address.split("x").last());
+        meas->setNumType(numType);
+        meas->setMinValueSoft(info[6].toDouble());
+        meas->setMaxValueSoft(info[7].toDouble());
+        meas->setMinValueHard(info[6].toDouble());
+        meas->setMaxValueHard(info[7].toDouble());
+        meas->setReadOnly(true);
+
+        measurements.push_back(meas);
+    }
 }
 
 void A2L::clear() {
 
     m_scalarsInfo.clear();
     m_compumethodsInfo.clear();
+    m_compuvtabsInfo.clear();
+    m_measurementsInfo.clear();
+    m_includedFiles.clear();
+}
+
+QVector< QSharedPointer<ECUScalar> > A2L::load(const QString &path, bool *ok, LoadControl *control,
+                                               QStringList *includedFiles,
+                                               QVector< QSharedPointer<ECUScalar> > *measurements) {
+
+    QVector< QSharedPointer<ECUScalar> > scalars;
+
+    A2L a2l(path);
+    a2l.setLoadControl(control);
+
+    const bool parsed = a2l.readFile();
+
+    if ( parsed ) {
+
+        a2l.fillScalarsInfo(scalars);
+
+        if ( measurements ) {
+            a2l.fillMeasurementsInfo(*measurements);
+        }
+    }
+
+    if ( includedFiles ) {
+        *includedFiles = a2l.includedFiles();
+    }
+
+    if ( ok ) {
+        *ok = parsed;
+    }
+
+    return scalars;
+}
+
+QVector< QSharedPointer<ECUScalar> > A2L::loadMeasurements(const QString &path, bool *ok) {
+
+    QVector< QSharedPointer<ECUScalar> > measurements;
+
+    A2L a2l(path);
+
+    const bool parsed = a2l.readFile();
+
+    if ( parsed ) {
+        a2l.fillMeasurementsInfo(measurements);
+    }
+
+    if ( ok ) {
+        *ok = parsed;
+    }
+
+    return measurements;
 }
 
 ptrdiff_t A2L::findCompuMethod(const QString &str) const {
@@ -281,3 +580,41 @@ const QString A2L::delQuotes(const QString &str) const {
 
     return ret;
 }
+
+QString A2L::measurementNumType(const QString &dataType) const {
+
+    // same names as the record layouts of the characteristics
+
+    if ( dataType == "UBYTE" ) {
+        return "Wu8";
+    }
+    else if ( dataType == "SBYTE" ) {
+        return "Ws8";
+    }
+    else if ( dataType == "UWORD" ) {
+        return "Wu16";
+    }
+    else if ( dataType == "SWORD" ) {
+        return "Ws16";
+    }
+    else if ( dataType == "ULONG" ) {
+        return "Wu32";
+    }
+    else if ( dataType == "SLONG" ) {
+        return "Ws32";
+    }
+    else if ( dataType == "A_UINT64" ) {
+        return "Wu64";
+    }
+    else if ( dataType == "A_INT64" ) {
+        return "Ws64";
+    }
+    else if ( dataType == "FLOAT32_IEEE" ) {
+        return "Wr32";
+    }
+    else if ( dataType == "FLOAT64_IEEE" ) {
+        return "Wr64";
+    }
+
+    return QString();
+}
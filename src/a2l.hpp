@@ -27,20 +27,57 @@
 #include <QSharedPointer>
 
 #include "ecuscalar.hpp"
+#include "loadcontrol.hpp"
+
+class QIODevice;
+
+struct A2LBlocks { // blocks of one file, lines simplified
+    QVector<QStringList> characteristics;
+    QVector<QStringList> compuMethods;
+    QVector<QStringList> compuVTabs;
+    QVector<QStringList> measurements;
+    QStringList includes; // /include file names as written
+    qint64 bytes = 0; // size of the file
+};
+
+// A2L file reader. /include directives are resolved relative to the
+// including file; the files of one nesting level are parsed in parallel
+// and every included file is cached by content (A2LCache), so a module
+// shared by several projects is parsed once.
 
 class A2L {
 
 public:
     A2L(const QString &); // takes a2l file path
+    void setLoadControl(LoadControl *);
     bool readFile();
     void fillScalarsInfo(QVector< QSharedPointer<ECUScalar> > &) const;
+    void fillMeasurementsInfo(QVector< QSharedPointer<ECUScalar> > &) const; // with ECU_ADDRESS only
     void clear();
 
+    QStringList includedFiles() const { // canonical paths, after readFile()
+        return m_includedFiles;
+    }
+
+    static QVector< QSharedPointer<ECUScalar> > load(const QString &, bool *ok = 0, LoadControl *control = 0,
+                                                     QStringList *includedFiles = 0,
+                                                     QVector< QSharedPointer<ECUScalar> > *measurements = 0);
+    static QVector< QSharedPointer<ECUScalar> > loadMeasurements(const QString &, bool *ok = 0);
+    static bool parseBlocks(QIODevice *, A2LBlocks &, LoadControl *control = 0); // one file, no includes
+
 private:
     QString m_a2lpath;
+    LoadControl *m_control = 0;
     QVector<QStringList> m_scalarsInfo;
     QVector<QStringList> m_compumethodsInfo;
     QVector<QStringList> m_compuvtabsInfo;
+    QVector<QStringList> m_measurementsInfo;
+    QStringList m_includedFiles;
+
+    static QSharedPointer<const A2LBlocks> parseInclude(const QString &);
+    static QString resolveInclude(const QString &, const QString &); // directive, directory
+    void appendBlocks(const A2LBlocks &);
+    bool readIncludes(const QStringList &);
 
     ptrdiff_t findCompuMethod(const QString &) const;
     ptrdiff_t findCompuVTab(const QString &) const;
@@ -48,6 +85,7 @@ private:
     QVector<double> getHardLimints(const QString &) const;
     bool isReadOnly(ptrdiff_t) const;
     QStringList getVTab(ptrdiff_t) const;
+    QString measurementNumType(const QString &) const;
     const QString delQuotes(const QString &) const;
 
 };
@@ -0,0 +1,311 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: a2lcache.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "a2lcache.hpp"
+#include "a2l.hpp"
+#include "constants.hpp"
+#include "trace.hpp"
+#include "compressedfile.hpp"
+
+#include <QFileInfo>
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QMutexLocker>
+
+static QVector< QSharedPointer<ECUScalar> > shallowCopy(const QVector< QSharedPointer<ECUScalar> > &defs) {
+
+    QVector< QSharedPointer<ECUScalar> > ret(defs.size());
+
+    for ( ptrdiff_t i=0; i<defs.size(); i++ ) {
+        ret[i] = QSharedPointer<ECUScalar>(new ECUScalar(*defs[i]));
+    }
+
+    return ret;
+}
+
+A2LCache::A2LCache() {
+}
+
+A2LCache &A2LCache::instance() {
+
+    static A2LCache cache;
+    return cache;
+}
+
+QVector< QSharedPointer<ECUScalar> > A2LCache::scalars(const QString &path, bool *ok, LoadControl *control) {
+
+    const Entry entry = load(path, ok, control);
+
+    if ( !entry.definitions ) {
+        return QVector< QSharedPointer<ECUScalar> >();
+    }
+
+    return shallowCopy(*entry.definitions);
+}
+
+QVector< QSharedPointer<ECUScalar> > A2LCache::measurements(const QString &path, bool *ok, LoadControl *control) {
+
+    const Entry entry = load(path, ok, control);
+
+    if ( !entry.measurements ) {
+        return QVector< QSharedPointer<ECUScalar> >();
+    }
+
+    return shallowCopy(*entry.measurements);
+}
+
+A2LCache::Entry A2LCache::load(const QString &path, bool *ok, LoadControl *control) {
+
+    const QFileInfo info(path);
+    const QString key = info.canonicalFilePath();
+
+    if ( ok ) {
+        *ok = false;
+    }
+
+    if ( key.isEmpty() ) { // file does not exist
+        return Entry();
+    }
+
+    const QDateTime modified = info.lastModified();
+    const qint64 size = info.size();
+
+    QMutexLocker locker(&m_mutex);
+
+    forever {
+
+        Entry entry = m_entries.value(key);
+
+        if ( entry.definitions && entry.modified == modified && entry.size == size ) {
+
+            // the included files are checked without holding up the other loaders
+
+            locker.unlock();
+            const bool current = isCurrent(entry.includes);
+            locker.relock();
+
+            const Entry now = m_entries.value(key);
+
+            if ( now.definitions != entry.definitions ) { // replaced meanwhile, look again
+                continue;
+            }
+
+            if ( current ) {
+
+                touch(key);
+                locker.unlock();
+
+                Trace::instance().count("a2lcache.hits", 1);
+
+                if ( ok ) {
+                    *ok = true;
+                }
+
+                return now;
+            }
+
+            entry = now;
+        }
+
+        if ( !entry.loading ) {
+            break;
+        }
+
+        m_loaded.wait(&m_mutex, 100); // another project parses this file
+
+        if ( control && control->isCanceled() ) {
+            return Entry();
+        }
+    }
+
+    m_entries[key].loading = true;
+    locker.unlock();
+
+    Trace::instance().count("a2lcache.misses", 1);
+
+    bool parsed = false;
+    QStringList includedFiles;
+    QVector< QSharedPointer<ECUScalar> > measurements;
+    const QVector< QSharedPointer<ECUScalar> > defs = A2L::load(path, &parsed, control, &includedFiles,
+                                                                &measurements);
+
+    QVector<FileStamp> includes;
+
+    for ( ptrdiff_t i=0; i<includedFiles.size(); i++ ) {
+
+        const QFileInfo includeInfo(includedFiles[i]);
+
+        FileStamp stamp;
+        stamp.path = includedFiles[i];
+        stamp.modified = includeInfo.lastModified();
+        stamp.size = includeInfo.size();
+
+        includes.push_back(stamp);
+    }
+
+    locker.relock();
+
+    Entry &entry = m_entries[key];
+    entry.loading = false;
+
+    Entry ret;
+
+    if ( parsed ) {
+
+        entry.definitions = QSharedPointer< const QVector< QSharedPointer<ECUScalar> > >(
+                    new QVector< QSharedPointer<ECUScalar> >(defs)
+                    );
+        entry.measurements = QSharedPointer< const QVector< QSharedPointer<ECUScalar> > >(
+                    new QVector< QSharedPointer<ECUScalar> >(measurements)
+                    );
+        entry.modified = modified;
+        entry.size = size;
+        entry.includes = includes;
+
+        ret = entry;
+        touch(key); // may rehash, entry is not valid after it
+    }
+    else {
+        m_entries.remove(key);
+    }
+
+    m_loaded.wakeAll();
+    locker.unlock();
+
+    if ( ok ) {
+        *ok = parsed;
+    }
+
+    return ret;
+}
+
+QSharedPointer<const A2LBlocks> A2LCache::includeBlocks(const QString &path) {
+
+    // reading and hashing is much cheaper than parsing
+
+    CompressedFile file(path); // the hash is taken from the decompressed content
+
+    if ( !file.open(QIODevice::ReadOnly) ) {
+        return QSharedPointer<const A2LBlocks>();
+    }
+
+    QByteArray data = file.readAll();
+    const bool read = file.isOk();
+    const qint64 bytes = file.progressSize();
+    file.close();
+
+    if ( !read ) {
+        return QSharedPointer<const A2LBlocks>();
+    }
+
+    const QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+
+    QMutexLocker locker(&m_mutex);
+
+    QSharedPointer<const A2LBlocks> blocks = m_includes.value(hash);
+
+    if ( blocks ) {
+
+        m_recentIncludes.removeOne(hash);
+        m_recentIncludes.push_back(hash);
+
+        Trace::instance().count("a2lcache.includeHits", 1);
+
+        return blocks;
+    }
+
+    locker.unlock();
+
+    Trace::instance().count("a2lcache.includeMisses", 1);
+
+    // the same content parsed twice at the same time is rare and harmless
+
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::ReadOnly | QIODevice::Text);
+
+    QSharedPointer<A2LBlocks> parsed(new A2LBlocks());
+
+    if ( !A2L::parseBlocks(&buffer, *parsed) ) {
+        return QSharedPointer<const A2LBlocks>();
+    }
+
+    parsed->bytes = bytes;
+
+    locker.relock();
+
+    m_includes.insert(hash, parsed);
+    m_recentIncludes.removeOne(hash);
+    m_recentIncludes.push_back(hash);
+
+    while ( m_recentIncludes.size() > A2LINCLUDECACHESIZE ) {
+        m_includes.remove(m_recentIncludes.takeFirst());
+    }
+
+    return parsed;
+}
+
+void A2LCache::clear() {
+
+    QMutexLocker locker(&m_mutex);
+
+    for ( QHash<QString, Entry>::iterator it = m_entries.begin(); it != m_entries.end(); ) {
+
+        if ( it.value().loading ) {
+            ++it;
+        }
+        else {
+            it = m_entries.erase(it);
+        }
+    }
+
+    m_recent.clear();
+
+    m_includes.clear();
+    m_recentIncludes.clear();
+}
+
+void A2LCache::touch(const QString &key) { // called with the mutex locked
+
+    m_recent.removeOne(key);
+    m_recent.push_back(key);
+
+    while ( m_recent.size() > A2LCACHESIZE ) {
+
+        const QString oldest = m_recent.takeFirst();
+
+        if ( !m_entries.value(oldest).loading ) {
+            m_entries.remove(oldest);
+        }
+    }
+}
+
+bool A2LCache::isCurrent(const QVector<FileStamp> &stamps) {
+
+    for ( ptrdiff_t i=0; i<stamps.size(); i++ ) {
+
+        const QFileInfo info(stamps[i].path);
+
+        if ( !info.exists() || info.lastModified() != stamps[i].modified || info.size() != stamps[i].size ) {
+            return false;
+        }
+    }
+
+    return true;
+}
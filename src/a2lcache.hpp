@@ -0,0 +1,91 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: a2lcache.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef A2LCACHE_HPP
+#define A2LCACHE_HPP
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QDateTime>
+#include <QSharedPointer>
+#include <QMutex>
+#include <QWaitCondition>
+
+#include "ecuscalar.hpp"
+#include "loadcontrol.hpp"
+#include "a2l.hpp"
+
+// Process-wide cache of parsed a2l files. Every project gets its own
+// ECUScalar objects, but they are shallow copies of the cached ones, so
+// names, descriptions and tables are shared between projects. The same
+// file is never parsed twice at the same time.
+//
+// Files pulled in by /include are cached separately, by the SHA-1 of
+// their content, so a module shared by several masters (or copied next
+// to every variant) is parsed once. A cached master is only reused while
+// none of its included files has changed either.
+//
+// The measurements of a file are kept next to its scalars, so the live
+// measurement dialog of an open project does not parse it again.
+
+class A2LCache {
+
+public:
+    static A2LCache &instance();
+    QVector< QSharedPointer<ECUScalar> > scalars(const QString &, bool *ok = 0, LoadControl *control = 0);
+    QVector< QSharedPointer<ECUScalar> > measurements(const QString &, bool *ok = 0, LoadControl *control = 0);
+    QSharedPointer<const A2LBlocks> includeBlocks(const QString &); // 0 if not readable
+    void clear();
+
+private:
+    A2LCache();
+
+    struct FileStamp {
+        QString path;
+        QDateTime modified;
+        qint64 size;
+    };
+
+    struct Entry {
+        QDateTime modified;
+        qint64 size = -1;
+        bool loading = false;
+        QSharedPointer< const QVector< QSharedPointer<ECUScalar> > > definitions;
+        QSharedPointer< const QVector< QSharedPointer<ECUScalar> > > measurements;
+        QVector<FileStamp> includes;
+    };
+
+    QMutex m_mutex;
+    QWaitCondition m_loaded;
+    QHash<QString, Entry> m_entries;
+    QStringList m_recent; // least recently used first
+
+    QHash< QByteArray, QSharedPointer<const A2LBlocks> > m_includes; // content hash -> blocks
+    QList<QByteArray> m_recentIncludes; // least recently used first
+
+    Entry load(const QString &, bool *, LoadControl *); // parsed entry, or one without definitions
+    void touch(const QString &);
+    static bool isCurrent(const QVector<FileStamp> &);
+
+};
+
+#endif // A2LCACHE_HPP
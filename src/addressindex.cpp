@@ -0,0 +1,98 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: addressindex.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "addressindex.hpp"
+#include "scalarcodec.hpp"
+#include "trace.hpp"
+
+#include <QVector>
+#include <QSharedPointer>
+
+#include <algorithm>
+
+AddressIndex::AddressIndex() {
+}
+
+void AddressIndex::build(const QVector< QSharedPointer<ECUScalar> > &scalars) {
+
+    TraceScope trace("index.address");
+
+    clear();
+
+    m_spans.resize(scalars.size());
+
+    for ( ptrdiff_t i=0; i<scalars.size(); i++ ) {
+
+        const size_t len = ScalarCodec::length(scalars[i]->numType());
+
+        m_spans[i].begin = scalars[i]->addressNum();
+        m_spans[i].end = quint64(m_spans[i].begin) + (len ? len : 1);
+        m_spans[i].index = i;
+    }
+
+    std::sort(m_spans.begin(), m_spans.end(),
+              [](const Span &s1, const Span &s2) { return s1.begin < s2.begin; });
+
+    m_maxEnd.resize(m_spans.size());
+
+    quint64 maxEnd = 0;
+
+    for ( ptrdiff_t i=0; i<m_spans.size(); i++ ) {
+        maxEnd = qMax(maxEnd, m_spans[i].end);
+        m_maxEnd[i] = maxEnd;
+    }
+}
+
+void AddressIndex::clear() {
+
+    m_spans.clear();
+    m_maxEnd.clear();
+}
+
+QVector<ptrdiff_t> AddressIndex::at(quint32 addr) const {
+    return overlapping(addr, quint64(addr) + 1);
+}
+
+QVector<ptrdiff_t> AddressIndex::overlapping(quint32 begin, quint64 end) const {
+
+    QVector<ptrdiff_t> ret;
+
+    if ( end <= begin ) {
+        return ret;
+    }
+
+    // spans starting before the end of the range; the walk back stops at
+    // the first span below which nothing reaches the start of the range
+
+    ptrdiff_t i = std::lower_bound(m_spans.constBegin(), m_spans.constEnd(), end,
+                                   [](const Span &s, quint64 addr) { return s.begin < addr; })
+            - m_spans.constBegin();
+
+    while ( --i >= 0 && m_maxEnd[i] > begin ) {
+
+        if ( m_spans[i].end > begin ) {
+            ret.push_back(m_spans[i].index);
+        }
+    }
+
+    std::reverse(ret.begin(), ret.end()); // by address
+
+    return ret;
+}
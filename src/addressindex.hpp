@@ -0,0 +1,63 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: addressindex.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ADDRESSINDEX_HPP
+#define ADDRESSINDEX_HPP
+
+#include <QVector>
+#include <QSharedPointer>
+
+#include "ecuscalar.hpp"
+
+// Reverse address lookup: which characteristics occupy a byte or overlap
+// an address range. The byte ranges are sorted by start address and carry
+// the running maximum of their ends, so a query is a binary search plus a
+// backward walk over the overlapping ranges only.
+
+class AddressIndex {
+
+public:
+    AddressIndex();
+    void build(const QVector< QSharedPointer<ECUScalar> > &);
+    void clear();
+
+    QVector<ptrdiff_t> at(quint32) const;                 // scalars containing the byte
+    QVector<ptrdiff_t> overlapping(quint32, quint64) const; // begin, end (exclusive)
+
+    bool isEmpty() const {
+        return m_spans.isEmpty();
+    }
+    ptrdiff_t size() const {
+        return m_spans.size();
+    }
+
+private:
+    struct Span {
+        quint32 begin;
+        quint64 end; // exclusive
+        ptrdiff_t index;
+    };
+
+    QVector<Span> m_spans;     // sorted by begin
+    QVector<quint64> m_maxEnd; // largest end among m_spans[0..i]
+
+};
+
+#endif // ADDRESSINDEX_HPP
@@ -0,0 +1,203 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: bufferedwriter.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "bufferedwriter.hpp"
+
+#include <cstring>
+#include <cstdio>
+#include <cmath>
+
+BufferedWriter::BufferedWriter(QIODevice *device) :
+    m_device(device) {
+}
+
+BufferedWriter::~BufferedWriter() {
+    flush();
+}
+
+void BufferedWriter::write(const char *src, size_t len) {
+
+    if ( m_used + len > EXPORTBUFFERSIZE ) {
+
+        flush();
+
+        if ( len > EXPORTBUFFERSIZE ) {
+            m_ok = m_ok && m_device->write(src, len) == qint64(len);
+            return;
+        }
+    }
+
+    memcpy(m_buffer + m_used, src, len);
+    m_used += len;
+}
+
+void BufferedWriter::write(const char *str) {
+    write(str, strlen(str));
+}
+
+void BufferedWriter::write(const QString &str) {
+
+    const QChar *chars = str.constData();
+    const ptrdiff_t len = str.size();
+
+    for ( ptrdiff_t i=0; i<len; i++ ) {
+
+        uint code = chars[i].unicode();
+
+        if ( code < 0x80 ) {
+            put(char(code));
+            continue;
+        }
+
+        if ( chars[i].isHighSurrogate() && i+1 < len && chars[i+1].isLowSurrogate() ) {
+            code = QChar::surrogateToUcs4(chars[i], chars[i+1]);
+            i++;
+        }
+
+        if ( code < 0x800 ) {
+            put(char(0xC0 | (code >> 6)));
+        }
+        else if ( code < 0x10000 ) {
+            put(char(0xE0 | (code >> 12)));
+            put(char(0x80 | ((code >> 6) & 0x3F)));
+        }
+        else {
+            put(char(0xF0 | (code >> 18)));
+            put(char(0x80 | ((code >> 12) & 0x3F)));
+            put(char(0x80 | ((code >> 6) & 0x3F)));
+        }
+
+        put(char(0x80 | (code & 0x3F)));
+    }
+}
+
+void BufferedWriter::writeInt(qint64 val) {
+
+    char digits[24];
+    ptrdiff_t pos = sizeof(digits);
+
+    quint64 abs = val < 0 ? quint64(0) - quint64(val) : quint64(val);
+
+    do {
+        digits[--pos] = char('0' + abs % 10);
+        abs /= 10;
+    } while ( abs != 0 );
+
+    if ( val < 0 ) {
+        digits[--pos] = '-';
+    }
+
+    write(digits + pos, sizeof(digits) - pos);
+}
+
+void BufferedWriter::writeDouble(double val, ptrdiff_t prec) {
+
+    static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+
+    if ( prec < 0 ) {
+        prec = 0;
+    }
+
+    const double scaled = std::fabs(val) * (prec <= 9 ? pow10[prec] : 0);
+    const double frac = scaled - std::floor(scaled);
+
+    // the common case: round the scaled value to an integer and insert the
+    // decimal point; values close to a rounding tie, where the scaling
+    // error could change the last digit, are left to printf
+
+    if ( prec <= 9 && scaled < 4503599627370496.0 && // 2^52
+         std::fabs(frac - 0.5) > scaled * 1e-15 ) {
+
+        quint64 num = quint64(scaled + 0.5);
+
+        char digits[32];
+        ptrdiff_t pos = sizeof(digits);
+
+        for ( ptrdiff_t n=0; n<prec; n++ ) {
+            digits[--pos] = char('0' + num % 10);
+            num /= 10;
+        }
+
+        if ( prec > 0 ) {
+            digits[--pos] = '.';
+        }
+
+        do {
+            digits[--pos] = char('0' + num % 10);
+            num /= 10;
+        } while ( num != 0 );
+
+        if ( val < 0 ) {
+            digits[--pos] = '-';
+        }
+
+        write(digits + pos, sizeof(digits) - pos);
+
+        return;
+    }
+
+    char buf[352]; // enough for any double in fixed notation
+
+    const int len = snprintf(buf, sizeof(buf), "%.*f", int(prec), val);
+
+    if ( len > 0 ) {
+        write(buf, size_t(len) < sizeof(buf) ? size_t(len) : sizeof(buf) - 1);
+    }
+}
+
+void BufferedWriter::writeLE32(quint32 val) {
+
+    char bytes[4];
+
+    for ( ptrdiff_t i=0; i<4; i++ ) {
+        bytes[i] = char(val >> (8 * i));
+    }
+
+    write(bytes, sizeof(bytes));
+}
+
+void BufferedWriter::writeLE64(quint64 val) {
+
+    char bytes[8];
+
+    for ( ptrdiff_t i=0; i<8; i++ ) {
+        bytes[i] = char(val >> (8 * i));
+    }
+
+    write(bytes, sizeof(bytes));
+}
+
+void BufferedWriter::writeLEDouble(double val) {
+
+    quint64 bits = 0;
+    memcpy(&bits, &val, sizeof(bits));
+
+    writeLE64(bits);
+}
+
+bool BufferedWriter::flush() {
+
+    if ( m_used > 0 ) {
+        m_ok = m_ok && m_device->write(m_buffer, m_used) == qint64(m_used);
+        m_used = 0;
+    }
+
+    return m_ok;
+}
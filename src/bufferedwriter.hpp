@@ -0,0 +1,68 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: bufferedwriter.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef BUFFEREDWRITER_HPP
+#define BUFFEREDWRITER_HPP
+
+#include <QIODevice>
+#include <QString>
+#include <QByteArray>
+
+#include "constants.hpp"
+
+// Output buffer in front of a QIODevice. Text is written as UTF-8 and
+// numbers are formatted in place, without temporary QStrings.
+
+class BufferedWriter {
+
+public:
+    explicit BufferedWriter(QIODevice *);
+    ~BufferedWriter(); // flushes
+
+    void put(char c) {
+        if ( m_used == EXPORTBUFFERSIZE ) {
+            flush();
+        }
+        m_buffer[m_used++] = c;
+    }
+
+    void write(const char *, size_t);
+    void write(const char *);
+    void write(const QString &); // UTF-8
+    void writeInt(qint64);
+    void writeDouble(double, ptrdiff_t); // fixed notation with given precision
+    void writeLE32(quint32);
+    void writeLE64(quint64);
+    void writeLEDouble(double);
+    bool flush();
+
+    bool isOk() const {
+        return m_ok;
+    }
+
+private:
+    QIODevice *m_device;
+    char m_buffer[EXPORTBUFFERSIZE];
+    size_t m_used = 0;
+    bool m_ok = true;
+
+};
+
+#endif // BUFFEREDWRITER_HPP
@@ -0,0 +1,544 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: checksum.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "checksum.hpp"
+#include "constants.hpp"
+#include "memoryimage.hpp"
+
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QMap>
+#include <QtEndian>
+
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define CHECKSUM_SSE42
+#include <nmmintrin.h>
+#elif defined(__ARM_FEATURE_CRC32)
+#define CHECKSUM_ARMCRC
+#include <arm_acle.h>
+#endif
+
+#define CRC32POLY  0xEDB88320 // reflected 0x04C11DB7
+#define CRC32CPOLY 0x82F63B78 // reflected 0x1EDC6F41
+#define CRC16POLY  0xA001     // reflected 0x8005
+#define CRC16CITTPOLY 0x1021
+
+class CRCTables {
+
+public:
+    CRCTables(quint32 poly) { // slicing-by-8 tables for a reflected polynomial
+
+        for ( quint32 i=0; i<256; i++ ) {
+
+            quint32 crc = i;
+
+            for ( ptrdiff_t j=0; j<8; j++ ) {
+                crc = (crc & 1) ? ((crc >> 1) ^ poly) : (crc >> 1);
+            }
+
+            t[0][i] = crc;
+        }
+
+        for ( quint32 i=0; i<256; i++ ) {
+            for ( ptrdiff_t k=1; k<8; k++ ) {
+                t[k][i] = (t[k-1][i] >> 8) ^ t[0][t[k-1][i] & 0xFF];
+            }
+        }
+    }
+
+    quint32 t[8][256];
+
+};
+
+static const CRCTables &crc32Tables() {
+    static const CRCTables tables(CRC32POLY);
+    return tables;
+}
+
+static const CRCTables &crc32cTables() {
+    static const CRCTables tables(CRC32CPOLY);
+    return tables;
+}
+
+static const CRCTables &crc16Tables() {
+    static const CRCTables tables(CRC16POLY);
+    return tables;
+}
+
+static const quint16 *crc16cittTable() {
+
+    static quint16 table[256];
+    static bool ready = [] {
+
+        for ( quint32 i=0; i<256; i++ ) {
+
+            quint16 crc = i << 8;
+
+            for ( ptrdiff_t j=0; j<8; j++ ) {
+                crc = (crc & 0x8000) ? ((crc << 1) ^ CRC16CITTPOLY) : (crc << 1);
+            }
+
+            table[i] = crc;
+        }
+
+        return true;
+    }();
+
+    Q_UNUSED(ready);
+
+    return table;
+}
+
+static quint32 crcSlicing8(const CRCTables &tbl, quint32 crc, const quint8 *p, size_t n) {
+
+    const quint32 (&t)[8][256] = tbl.t;
+
+    while ( n && (quintptr(p) & 7) ) {
+        crc = t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+        n--;
+    }
+
+    while ( n >= 8 ) {
+
+        quint32 lo = 0;
+        quint32 hi = 0;
+        memcpy(&lo, p, 4);
+        memcpy(&hi, p + 4, 4);
+        lo = qFromLittleEndian(lo) ^ crc;
+        hi = qFromLittleEndian(hi);
+
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^
+              t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^
+              t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+
+        p += 8;
+        n -= 8;
+    }
+
+    while ( n-- ) {
+        crc = t[0][(crc ^ *p++) & 0xFF] ^ (crc >> 8);
+    }
+
+    return crc;
+}
+
+#if defined(CHECKSUM_SSE42)
+
+static bool hasHardwareCRC32C() {
+    static const bool ret = __builtin_cpu_supports("sse4.2");
+    return ret;
+}
+
+__attribute__((target("sse4.2")))
+static quint32 crc32cHardware(quint32 crc, const quint8 *p, size_t n) {
+
+    while ( n && (quintptr(p) & 7) ) {
+        crc = _mm_crc32_u8(crc, *p++);
+        n--;
+    }
+
+#if defined(__x86_64__)
+    unsigned long long crc64 = crc;
+
+    while ( n >= 8 ) {
+
+        unsigned long long v = 0;
+        memcpy(&v, p, 8);
+        crc64 = _mm_crc32_u64(crc64, v);
+
+        p += 8;
+        n -= 8;
+    }
+
+    crc = quint32(crc64);
+#endif
+
+    while ( n-- ) {
+        crc = _mm_crc32_u8(crc, *p++);
+    }
+
+    return crc;
+}
+
+#elif defined(CHECKSUM_ARMCRC)
+
+static quint32 crc32Hardware(quint32 crc, const quint8 *p, size_t n, bool castagnoli) {
+
+    while ( n >= 8 ) {
+
+        quint64 v = 0;
+        memcpy(&v, p, 8);
+        crc = castagnoli ? __crc32cd(crc, v) : __crc32d(crc, v);
+
+        p += 8;
+        n -= 8;
+    }
+
+    while ( n-- ) {
+        crc = castagnoli ? __crc32cb(crc, *p) : __crc32b(crc, *p);
+        p++;
+    }
+
+    return crc;
+}
+
+#endif
+
+// streaming state of one checksum calculation
+
+class ChecksumAccumulator {
+
+public:
+    ChecksumAccumulator(ptrdiff_t alg, size_t wordSize) :
+        m_alg(alg),
+        m_wordSize(wordSize) {
+
+        if ( alg == CHECKSUM_CRC_32 || alg == CHECKSUM_CRC_32C ) {
+            m_state = 0xFFFFFFFF;
+        }
+        else if ( alg == CHECKSUM_CRC_16_CITT ) {
+            m_state = 0xFFFF;
+        }
+    }
+
+    void feed(const quint8 *p, size_t n) {
+
+        if ( m_alg == CHECKSUM_CRC_32 ) {
+#if defined(CHECKSUM_ARMCRC)
+            m_state = crc32Hardware(m_state, p, n, false);
+#else
+            m_state = crcSlicing8(crc32Tables(), m_state, p, n);
+#endif
+        }
+        else if ( m_alg == CHECKSUM_CRC_32C ) {
+#if defined(CHECKSUM_SSE42)
+            if ( hasHardwareCRC32C() ) {
+                m_state = crc32cHardware(m_state, p, n);
+                return;
+            }
+#elif defined(CHECKSUM_ARMCRC)
+            m_state = crc32Hardware(m_state, p, n, true);
+            return;
+#endif
+            m_state = crcSlicing8(crc32cTables(), m_state, p, n);
+        }
+        else if ( m_alg == CHECKSUM_CRC_16 ) {
+            m_state = crcSlicing8(crc16Tables(), m_state, p, n);
+        }
+        else if ( m_alg == CHECKSUM_CRC_16_CITT ) {
+
+            const quint16 *t = crc16cittTable();
+            quint16 crc = m_state;
+
+            for ( size_t i=0; i<n; i++ ) {
+                crc = (crc << 8) ^ t[((crc >> 8) ^ p[i]) & 0xFF];
+            }
+
+            m_state = crc;
+        }
+        else if ( m_wordSize == 1 ) {
+
+            while ( n > 0 ) { // 16 MB blocks keep the vectorizable 32-bit sum from overflowing
+
+                const size_t block = (n < (1u << 24)) ? n : (1u << 24);
+                quint32 sum = 0;
+
+                for ( size_t i=0; i<block; i++ ) {
+                    sum += p[i];
+                }
+
+                m_sum += sum;
+                p += block;
+                n -= block;
+            }
+        }
+        else {
+            feedWords(p, n);
+        }
+    }
+
+    quint32 result() const {
+
+        if ( m_alg == CHECKSUM_CRC_32 || m_alg == CHECKSUM_CRC_32C ) {
+            return m_state ^ 0xFFFFFFFF;
+        }
+        else if ( m_alg == CHECKSUM_CRC_16 || m_alg == CHECKSUM_CRC_16_CITT ) {
+            return m_state & 0xFFFF;
+        }
+        else if ( m_alg == CHECKSUM_ADD_11 ) {
+            return m_sum & 0xFF;
+        }
+        else if ( m_alg == CHECKSUM_ADD_12 || m_alg == CHECKSUM_ADD_22 ) {
+            return m_sum & 0xFFFF;
+        }
+
+        return quint32(m_sum);
+    }
+
+private:
+    ptrdiff_t m_alg;
+    size_t m_wordSize;
+    quint32 m_state = 0;
+    quint64 m_sum = 0;
+    quint32 m_word = 0;
+    size_t m_wordBytes = 0;
+
+    void feedWords(const quint8 *p, size_t n) {
+
+        while ( m_wordBytes && n ) {
+            addByte(*p++);
+            n--;
+        }
+
+        if ( m_wordSize == 2 ) {
+            for ( ; n >= 2; p += 2, n -= 2 ) {
+                m_sum += qFromBigEndian<quint16>(p);
+            }
+        }
+        else {
+            for ( ; n >= 4; p += 4, n -= 4 ) {
+                m_sum += qFromBigEndian<quint32>(p);
+            }
+        }
+
+        while ( n-- ) {
+            addByte(*p++);
+        }
+    }
+
+    void addByte(quint8 b) {
+
+        m_word = (m_word << 8) | b;
+
+        if ( ++m_wordBytes == m_wordSize ) {
+            m_sum += m_word;
+            m_word = 0;
+            m_wordBytes = 0;
+        }
+    }
+
+};
+
+static void feedFill(ChecksumAccumulator &acc, quint8 fill, quint64 n) {
+
+    quint8 buf[4096];
+    memset(buf, fill, sizeof(buf));
+
+    while ( n > 0 ) {
+
+        const size_t chunk = (n < sizeof(buf)) ? size_t(n) : sizeof(buf);
+        acc.feed(buf, chunk);
+        n -= chunk;
+    }
+}
+
+// indexed by the CHECKSUM_* values
+
+static const char *const algorithmNames[] = {
+    "ADD_11", "ADD_12", "ADD_14", "ADD_22", "ADD_24", "ADD_44",
+    "CRC_16", "CRC_16_CITT", "CRC_32", "CRC_32C"
+};
+
+Checksum::Checksum() {
+}
+
+void Checksum::setAlgorithm(ptrdiff_t alg) {
+    m_algorithm = alg;
+}
+
+void Checksum::setRange(quint32 begin, quint32 end) {
+    m_begin = begin;
+    m_end = end;
+}
+
+void Checksum::setTargetAddress(quint32 addr) {
+    m_target = addr;
+}
+
+void Checksum::setFillByte(quint8 fill) {
+    m_fill = fill;
+}
+
+size_t Checksum::resultSize() const {
+
+    if ( m_algorithm == CHECKSUM_ADD_11 ) {
+        return 1;
+    }
+    else if ( m_algorithm == CHECKSUM_ADD_12 ||
+              m_algorithm == CHECKSUM_ADD_22 ||
+              m_algorithm == CHECKSUM_CRC_16 ||
+              m_algorithm == CHECKSUM_CRC_16_CITT ) {
+        return 2;
+    }
+
+    return 4;
+}
+
+bool Checksum::calculate(const MemoryImage &image, quint32 &result) const {
+
+    if ( m_end <= m_begin || m_algorithm < CHECKSUM_ADD_11 || m_algorithm > CHECKSUM_CRC_32C ) {
+        return false;
+    }
+
+    if ( (m_end - m_begin) % wordSize() != 0 ) {
+        return false;
+    }
+
+    ChecksumAccumulator acc(m_algorithm, wordSize());
+    const QMap<quint32, QByteArray> &segments = image.segments();
+    QMap<quint32, QByteArray>::const_iterator it = segments.upperBound(m_begin);
+
+    if ( it != segments.constBegin() ) {
+        --it;
+    }
+
+    quint32 pos = m_begin;
+
+    for ( ; it != segments.constEnd() && it.key() < m_end; ++it ) {
+
+        const quint64 segEnd = quint64(it.key()) + it.value().size();
+
+        if ( segEnd <= pos ) {
+            continue;
+        }
+
+        if ( it.key() > pos ) {
+            feedFill(acc, m_fill, it.key() - pos);
+            pos = it.key();
+        }
+
+        const quint32 chunkEnd = (segEnd < m_end) ? quint32(segEnd) : m_end;
+
+        acc.feed(reinterpret_cast<const quint8 *>(it.value().constData()) + (pos - it.key()),
+                 chunkEnd - pos);
+        pos = chunkEnd;
+    }
+
+    if ( pos < m_end ) {
+        feedFill(acc, m_fill, m_end - pos);
+    }
+
+    result = acc.result();
+
+    return true;
+}
+
+bool Checksum::update(MemoryImage &image) const {
+
+    const quint64 targetEnd = quint64(m_target) + resultSize();
+
+    if ( m_target < m_end && targetEnd > m_begin ) { // result would change the range
+        return false;
+    }
+
+    quint32 result = 0;
+
+    if ( !calculate(image, result) ) {
+        return false;
+    }
+
+    char buf[4];
+
+    for ( size_t i=0; i<resultSize(); i++ ) {
+        buf[i] = char((result >> (8 * (resultSize() - 1 - i))) & 0xFF);
+    }
+
+    image.write(m_target, buf, resultSize());
+
+    return true;
+}
+
+ptrdiff_t Checksum::algorithmByName(const QString &name) {
+
+    QString str = name.toUpper();
+
+    if ( str.startsWith("XCP_") ) {
+        str.remove(0, 4);
+    }
+
+    for ( ptrdiff_t i=CHECKSUM_ADD_11; i<=CHECKSUM_CRC_32C; i++ ) {
+
+        if ( str == algorithmNames[i] ) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+bool Checksum::fromString(const QString &str) {
+
+    const QStringList fields = str.trimmed().split(':');
+
+    if ( fields.size() < 3 || fields.size() > 4 ) {
+        return false;
+    }
+
+    const QStringList range = fields[1].split('-');
+
+    if ( range.size() != 2 ) {
+        return false;
+    }
+
+    const ptrdiff_t alg = algorithmByName(fields[0].trimmed());
+    bool ok[5] = {true, true, true, true, true};
+
+    const quint32 begin = range[0].trimmed().toUInt(&ok[0], 16);
+    const quint32 end = range[1].trimmed().toUInt(&ok[1], 16);
+    const quint32 target = fields[2].trimmed().toUInt(&ok[2], 16);
+    const uint fill = fields.size() == 4 ? fields[3].trimmed().toUInt(&ok[3], 16) : 0xFF;
+
+    if ( alg < 0 || !ok[0] || !ok[1] || !ok[2] || !ok[3] || end <= begin || fill > 0xFF ) {
+        return false;
+    }
+
+    m_algorithm = alg;
+    m_begin = begin;
+    m_end = end;
+    m_target = target;
+    m_fill = quint8(fill);
+
+    return true;
+}
+
+QString Checksum::toString() const {
+
+    return QString(algorithmNames[m_algorithm]) + ":"
+            + QString::number(m_begin, 16).toUpper() + "-"
+            + QString::number(m_end, 16).toUpper() + ":"
+            + QString::number(m_target, 16).toUpper() + ":"
+            + QString::number(m_fill, 16).toUpper();
+}
+
+size_t Checksum::wordSize() const {
+
+    if ( m_algorithm == CHECKSUM_ADD_22 || m_algorithm == CHECKSUM_ADD_24 ) {
+        return 2;
+    }
+    else if ( m_algorithm == CHECKSUM_ADD_44 ) {
+        return 4;
+    }
+
+    return 1;
+}
@@ -0,0 +1,77 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: checksum.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef CHECKSUM_HPP
+#define CHECKSUM_HPP
+
+#include <QString>
+
+#include "constants.hpp"
+#include "memoryimage.hpp"
+
+// Checksum over the memory range [begin, end). Gaps in the image are
+// filled with the fill byte; the result is stored MSB first.
+
+class Checksum {
+
+public:
+    Checksum();
+    void setAlgorithm(ptrdiff_t);
+    void setRange(quint32, quint32);
+    void setTargetAddress(quint32);
+    void setFillByte(quint8);
+
+    ptrdiff_t algorithm() const {
+        return m_algorithm;
+    }
+    quint32 begin() const {
+        return m_begin;
+    }
+    quint32 end() const {
+        return m_end;
+    }
+    quint32 targetAddress() const {
+        return m_target;
+    }
+    quint8 fillByte() const {
+        return m_fill;
+    }
+
+    size_t resultSize() const;
+    bool calculate(const MemoryImage &, quint32 &) const;
+    bool update(MemoryImage &) const; // calculates and writes to target address
+
+    bool fromString(const QString &); // "CRC_32:begin-end:target[:fill]", hex numbers
+    QString toString() const;
+
+    static ptrdiff_t algorithmByName(const QString &); // -1 if unknown
+
+private:
+    ptrdiff_t m_algorithm = CHECKSUM_CRC_32;
+    quint32 m_begin = 0;
+    quint32 m_end = 0;
+    quint32 m_target = 0;
+    quint8 m_fill = 0xFF;
+
+    size_t wordSize() const;
+
+};
+
+#endif // CHECKSUM_HPP
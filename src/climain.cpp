@@ -0,0 +1,466 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: climain.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "constants.hpp"
+#include "a2l.hpp"
+#include "ecuscalar.hpp"
+#include "intelhex.hpp"
+#include "memoryimage.hpp"
+#include "scalarcodec.hpp"
+#include "labelindex.hpp"
+#include "limitcheck.hpp"
+#include "valueexport.hpp"
+#include "dcmimport.hpp"
+#include "imageoverlay.hpp"
+#include "trace.hpp"
+#include "checksum.hpp"
+#include "fleetcompare.hpp"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QSharedPointer>
+
+#include <cstdio>
+#include <limits>
+
+// Command-line tool: loads an a2l/hex project and exports the values of the
+// selected (or all) labels.
+
+static bool readTemplates(const QString &path, QStringList &templs) {
+
+    QFile file(path);
+
+    if ( !file.open(QIODevice::ReadOnly | QIODevice::Text) ) {
+        return false;
+    }
+
+    QTextStream in(&file);
+
+    while ( !in.atEnd() ) {
+
+        const QString line = in.readLine().trimmed();
+
+        if ( !line.isEmpty() && !line.startsWith('#') ) {
+            templs.push_back(line);
+        }
+    }
+
+    return true;
+}
+
+// Compares the hex files with the reference: the matrix goes to the output
+// file (standard output if empty), the summary to err.
+
+static int compareFleet(const QVector< QSharedPointer<ECUScalar> > &scalars, const QString &refPath,
+                        const QStringList &hexPaths, const QString &outPath, QTextStream &err) {
+
+    bool ok = false;
+    const MemoryImage reference = IntelHEX::load(refPath, &ok);
+
+    if ( !ok ) {
+        err << "Error occured during reading of " << refPath << "!\n";
+        return CLIEXIT_HEX;
+    }
+
+    FleetCompare fleet(scalars, reference);
+    fleet.run(hexPaths);
+
+    int status = CLIEXIT_OK;
+    ptrdiff_t failed = 0;
+    ptrdiff_t deviating = 0;
+
+    for ( ptrdiff_t n=0; n<fleet.entries().size(); n++ ) {
+
+        if ( !fleet.entries()[n].ok ) {
+            err << "Error occured during reading of " << fleet.entries()[n].path << "\n";
+            failed++;
+            status = CLIEXIT_HEX;
+        }
+        else if ( fleet.entries()[n].deviations > 0 ) {
+            deviating++;
+        }
+    }
+
+    err << hexPaths.size() << " hex files: " << deviating << " deviate from reference, "
+        << failed << " unreadable\n";
+
+    const QVector<ptrdiff_t> order = fleet.mostDeviating(10);
+
+    for ( ptrdiff_t i=0; i<order.size(); i++ ) {
+        err << "    " << scalars[order[i]]->name() << ": " << fleet.deviatingFiles()[order[i]] << " files\n";
+    }
+
+    //
+
+    QFile outFile;
+
+    if ( !outPath.isEmpty() ) {
+        outFile.setFileName(outPath);
+        ok = outFile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text);
+    }
+    else {
+        ok = outFile.open(stdout, QIODevice::WriteOnly | QIODevice::Text);
+    }
+
+    if ( !ok || !fleet.writeMatrix(&outFile) ) {
+        err << "Can not write " << outFile.fileName() << "!\n";
+        return CLIEXIT_OUTPUT;
+    }
+
+    return status;
+}
+
+int main(int argc, char *argv[]) {
+
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QString(PROGNAME) + "-cli");
+    QCoreApplication::setApplicationVersion(QString(PROGVER));
+
+    QTextStream err(stderr);
+
+    //
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Dumps label values of an a2l/hex project or compares hex files "
+                                     "with a reference.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("a2l", "a2l file.");
+    parser.addPositionalArgument("hex", "hex file (files to compare with --reference).", "hex [hex...]");
+
+    const QCommandLineOption labelsOption(
+                QStringList() << "l" << "labels",
+                "Comma separated label names or wild*card templates (all labels by default).",
+                "labels");
+    const QCommandLineOption labelsFileOption(
+                QStringList() << "f" << "labels-file",
+                "File with one label name or template per line.",
+                "file");
+    const QCommandLineOption outputOption(
+                QStringList() << "o" << "output",
+                "Output file (standard output by default).",
+                "file");
+    const QCommandLineOption formatOption(
+                QStringList() << "t" << "format",
+                "Output format: csv (default), jsonl, bin, dcm or cdfx.",
+                "format", "csv");
+    const QCommandLineOption limitsOption(
+                QStringList() << "c" << "check-limits",
+                "Exit with an error if a value violates its hard limits.");
+    const QCommandLineOption applyOption(
+                QStringList() << "a" << "apply",
+                "Apply the values of a DCM file before dumping.",
+                "file");
+    const QCommandLineOption writeHexOption(
+                "write-hex",
+                "Save the hex image with the applied values.",
+                "file");
+    const QCommandLineOption checksumOption(
+                "checksum",
+                "Update a checksum in the image saved with --write-hex, algorithm:begin-end:target[:fill] "
+                "in hex (may be given several times).",
+                "checksum");
+    const QCommandLineOption referenceOption(
+                "reference",
+                "Compare the hex files with this one: a csv matrix of all labels goes to the output, "
+                "a summary of the deviations to standard error.",
+                "hex");
+    const QCommandLineOption traceOption(
+                "trace",
+                "Save phase timings and counters as a Chrome trace.",
+                "file");
+
+    parser.addOption(labelsOption);
+    parser.addOption(labelsFileOption);
+    parser.addOption(outputOption);
+    parser.addOption(formatOption);
+    parser.addOption(limitsOption);
+    parser.addOption(applyOption);
+    parser.addOption(writeHexOption);
+    parser.addOption(checksumOption);
+    parser.addOption(referenceOption);
+    parser.addOption(traceOption);
+    parser.process(app);
+
+    Trace::instance().setEnabled(parser.isSet(traceOption));
+
+    const QStringList args = parser.positionalArguments();
+
+    if ( args.size() < 2 || (args.size() != 2 && !parser.isSet(referenceOption)) ) {
+        err << parser.helpText();
+        return CLIEXIT_USAGE;
+    }
+
+    const ptrdiff_t format = ValueExport::formatByName(parser.value(formatOption));
+
+    if ( format < 0 ) {
+        err << "Unknown format " << parser.value(formatOption) << "!\n";
+        return CLIEXIT_USAGE;
+    }
+
+    if ( parser.isSet(checksumOption) && !parser.isSet(writeHexOption) ) {
+        err << "--checksum needs --write-hex!\n";
+        return CLIEXIT_USAGE;
+    }
+
+    QVector<Checksum> checksums;
+    const QStringList checksumDefs = parser.values(checksumOption);
+
+    for ( ptrdiff_t i=0; i<checksumDefs.size(); i++ ) {
+
+        Checksum checksum;
+
+        if ( !checksum.fromString(checksumDefs[i]) ) {
+            err << "Wrong checksum definition " << checksumDefs[i] << "!\n";
+            return CLIEXIT_USAGE;
+        }
+
+        checksums.push_back(checksum);
+    }
+
+    QStringList templs;
+
+    if ( parser.isSet(labelsOption) ) {
+        templs = parser.value(labelsOption).split(',', SKIPEMPTYPARTS);
+    }
+
+    if ( parser.isSet(labelsFileOption) && !readTemplates(parser.value(labelsFileOption), templs) ) {
+        err << "Can not read " << parser.value(labelsFileOption) << "!\n";
+        return CLIEXIT_USAGE;
+    }
+
+    //
+
+    bool ok = false;
+    const QVector< QSharedPointer<ECUScalar> > scalars = A2L::load(args[0], &ok);
+
+    if ( !ok ) {
+        err << "Error occured during a2l file parsing!\n";
+        return CLIEXIT_A2L;
+    }
+
+    if ( parser.isSet(referenceOption) ) {
+
+        const int status = compareFleet(scalars, parser.value(referenceOption), args.mid(1),
+                                        parser.value(outputOption), err);
+
+        if ( parser.isSet(traceOption) && !Trace::instance().writeChromeTrace(parser.value(traceOption)) ) {
+            err << "Can not write " << parser.value(traceOption) << "!\n";
+            return CLIEXIT_OUTPUT;
+        }
+
+        return status;
+    }
+
+    const MemoryImage image = IntelHEX::load(args[1], &ok);
+
+    if ( !ok ) {
+        err << "Error occured during hex file reading!\n";
+        return CLIEXIT_HEX;
+    }
+
+    // values of a DCM file go on top of the hex image
+
+    int status = CLIEXIT_OK;
+    ImageOverlay overlay(image);
+
+    if ( parser.isSet(applyOption) ) {
+
+        DcmImport dcm(scalars);
+
+        if ( !dcm.read(parser.value(applyOption)) ) {
+            err << "Can not read " << parser.value(applyOption) << ": " << dcm.errorString() << "\n";
+            return CLIEXIT_DCM;
+        }
+
+        QStringList failed;
+        dcm.apply(overlay, failed);
+
+        const QStringList unknown = dcm.unknownLabels();
+
+        for ( ptrdiff_t i=0; i<unknown.size(); i++ ) {
+            err << "Unknown label " << unknown[i] << " in " << parser.value(applyOption) << "\n";
+        }
+
+        for ( ptrdiff_t i=0; i<failed.size(); i++ ) {
+            err << "Can not apply " << failed[i] << "\n";
+        }
+
+        if ( !unknown.isEmpty() || !failed.isEmpty() ) {
+            status = CLIEXIT_DCM;
+        }
+    }
+
+    // labels to dump, in the order they were asked for
+
+    QVector<ptrdiff_t> selected;
+
+    if ( templs.isEmpty() ) {
+
+        selected.resize(scalars.size());
+
+        for ( ptrdiff_t i=0; i<scalars.size(); i++ ) {
+            selected[i] = i;
+        }
+    }
+    else {
+
+        QHash<QString, ptrdiff_t> byName;
+        byName.reserve(scalars.size());
+
+        for ( ptrdiff_t i=0; i<scalars.size(); i++ ) {
+            byName.insert(scalars[i]->name(), i);
+        }
+
+        LabelIndex index;
+        QVector<bool> taken(scalars.size(), false);
+
+        for ( ptrdiff_t n=0; n<templs.size(); n++ ) {
+
+            QVector<ptrdiff_t> found;
+
+            if ( LabelIndex::queryMode(templs[n]) == SEARCH_WILDCARD ) {
+
+                if ( index.size() == 0 ) {
+                    index.build(scalars);
+                }
+
+                found = index.search(templs[n]);
+            }
+            else if ( byName.contains(templs[n]) ) {
+                found.push_back(byName.value(templs[n]));
+            }
+
+            if ( found.isEmpty() ) {
+
+                err << "Unknown label " << templs[n] << "\n";
+
+                if ( status == CLIEXIT_OK ) {
+                    status = CLIEXIT_UNKNOWNLABEL;
+                }
+            }
+
+            for ( ptrdiff_t i=0; i<found.size(); i++ ) {
+
+                if ( !taken[found[i]] ) {
+                    taken[found[i]] = true;
+                    selected.push_back(found[i]);
+                }
+            }
+        }
+    }
+
+    //
+
+    QVector<double> values(scalars.size(), std::numeric_limits<double>::quiet_NaN());
+
+    for ( ptrdiff_t n=0; n<selected.size(); n++ ) {
+
+        if ( !ScalarCodec::decode(*scalars[selected[n]], overlay, values[selected[n]]) ) {
+
+            err << "No data for " << scalars[selected[n]]->name() << "\n";
+
+            values[selected[n]] = std::numeric_limits<double>::quiet_NaN();
+
+            if ( status == CLIEXIT_OK ) {
+                status = CLIEXIT_NODATA;
+            }
+        }
+    }
+
+    //
+
+    QFile outFile;
+
+    if ( parser.isSet(outputOption) ) {
+        outFile.setFileName(parser.value(outputOption));
+        ok = outFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    }
+    else {
+        ok = outFile.open(stdout, QIODevice::WriteOnly);
+    }
+
+    ValueExport exporter(scalars);
+    exporter.setIndexes(selected);
+    exporter.setValues(values);
+    exporter.setDatasetName(QFileInfo(args[1]).completeBaseName());
+
+    if ( !ok || !exporter.write(&outFile, format) ) {
+        err << "Can not write " << outFile.fileName() << "!\n";
+        return CLIEXIT_OUTPUT;
+    }
+
+    if ( parser.isSet(writeHexOption) ) {
+
+        MemoryImage flat = overlay.flatten();
+
+        for ( ptrdiff_t i=0; i<checksums.size(); i++ ) {
+
+            if ( !checksums[i].update(flat) ) {
+                err << "Can not update checksum " << checksums[i].toString() << "!\n";
+                return CLIEXIT_OUTPUT;
+            }
+        }
+
+        if ( !IntelHEX::writeHex(parser.value(writeHexOption), flat) ) {
+            err << "Can not write " << parser.value(writeHexOption) << "!\n";
+            return CLIEXIT_OUTPUT;
+        }
+    }
+
+    //
+
+    if ( parser.isSet(limitsOption) ) {
+
+        const LimitCheck limitCheck(scalars);
+        const QVector<LimitViolation> violations = limitCheck.check(values);
+
+        for ( ptrdiff_t i=0; i<violations.size(); i++ ) {
+
+            if ( violations[i].severity != LIMIT_HARD ) {
+                continue;
+            }
+
+            err << "Hard limit violated: " << scalars[violations[i].index]->name()
+                << " = " << violations[i].value << "\n";
+
+            if ( status == CLIEXIT_OK ) {
+                status = CLIEXIT_HARDLIMIT;
+            }
+        }
+    }
+
+    //
+
+    if ( parser.isSet(traceOption) && !Trace::instance().writeChromeTrace(parser.value(traceOption)) ) {
+        err << "Can not write " << parser.value(traceOption) << "!\n";
+        return CLIEXIT_OUTPUT;
+    }
+
+    return status;
+}
@@ -0,0 +1,424 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: compressedfile.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "compressedfile.hpp"
+#include "constants.hpp"
+
+#include <QThreadPool>
+#include <QMutexLocker>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <cstring>
+
+#ifndef DIECAT_NO_COMPRESSION
+#include <zlib.h>
+#include <lzma.h>
+#endif
+
+static QThreadPool *decompressionPool() { // keeps the workers off the global pool used for parsing
+
+    static QThreadPool pool;
+    return &pool;
+}
+
+CompressedFile::CompressedFile(const QString &path) :
+    m_file(path),
+    m_abort(0),
+    m_compressedPos(0) {
+}
+
+CompressedFile::~CompressedFile() {
+
+    close();
+}
+
+bool CompressedFile::open(OpenMode mode) {
+
+    if ( (mode & WriteOnly) || !m_file.open(QIODevice::ReadOnly) ) {
+        setErrorString(m_file.errorString());
+        return false;
+    }
+
+    // magic numbers
+
+    const QByteArray head = m_file.peek(6);
+
+    if ( head.startsWith("\x1F\x8B") ) {
+        m_format = FORMAT_GZIP;
+    }
+    else if ( head == QByteArray("\xFD" "7zXZ\x00", 6) ) {
+        m_format = FORMAT_XZ;
+    }
+    else {
+        m_format = FORMAT_PLAIN;
+    }
+
+#ifdef DIECAT_NO_COMPRESSION
+    if ( m_format != FORMAT_PLAIN ) {
+        m_file.close();
+        setErrorString("Compressed files are not supported by this build");
+        return false;
+    }
+#endif
+
+    m_chunks.clear();
+    m_chunk.clear();
+    m_chunkPos = 0;
+    m_finished = false;
+    m_failed = false;
+    m_abort.storeRelease(0);
+    m_compressedPos.storeRelease(0);
+
+    if ( m_format != FORMAT_PLAIN ) {
+        m_worker = QtConcurrent::run(decompressionPool(), this, &CompressedFile::decompress);
+    }
+
+    return QIODevice::open(mode);
+}
+
+void CompressedFile::close() {
+
+    if ( !isOpen() ) {
+        return;
+    }
+
+    // stop a worker waiting for free space
+
+    m_abort.storeRelease(1);
+
+    m_mutex.lock();
+    m_consumed.wakeAll();
+    m_mutex.unlock();
+
+    m_worker.waitForFinished();
+
+    QIODevice::close();
+    m_file.close();
+
+    m_chunks.clear();
+    m_chunk.clear();
+}
+
+bool CompressedFile::isSequential() const {
+    return true;
+}
+
+bool CompressedFile::atEnd() const {
+
+    if ( !isOpen() || QIODevice::bytesAvailable() > 0 ) {
+        return !isOpen();
+    }
+
+    if ( m_format == FORMAT_PLAIN ) {
+        return m_file.atEnd();
+    }
+
+    if ( m_chunkPos < m_chunk.size() ) {
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    while ( m_chunks.isEmpty() && !m_finished ) {
+        m_produced.wait(&m_mutex);
+    }
+
+    return m_chunks.isEmpty();
+}
+
+qint64 CompressedFile::bytesAvailable() const {
+
+    if ( m_format == FORMAT_PLAIN ) {
+        return QIODevice::bytesAvailable() + m_file.bytesAvailable();
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    qint64 ret = QIODevice::bytesAvailable() + m_chunk.size() - m_chunkPos;
+
+    for ( ptrdiff_t i=0; i<m_chunks.size(); i++ ) {
+        ret += m_chunks[i].size();
+    }
+
+    return ret;
+}
+
+qint64 CompressedFile::progressPos() const {
+
+    if ( m_format == FORMAT_PLAIN ) {
+        return m_file.pos();
+    }
+
+    return m_compressedPos.loadAcquire();
+}
+
+qint64 CompressedFile::progressSize() const {
+    return m_file.size();
+}
+
+bool CompressedFile::isOk() const {
+
+    if ( m_format == FORMAT_PLAIN ) {
+        return m_file.error() == QFileDevice::NoError;
+    }
+
+    QMutexLocker locker(&m_mutex);
+
+    return !m_failed;
+}
+
+qint64 CompressedFile::readData(char *data, qint64 maxSize) {
+
+    if ( m_format == FORMAT_PLAIN ) {
+        return m_file.read(data, maxSize);
+    }
+
+    qint64 done = 0;
+
+    while ( done < maxSize ) {
+
+        if ( m_chunkPos == m_chunk.size() ) {
+
+            const bool more = done > 0 ? tryNextChunk() // give the parser what is there
+                                       : nextChunk();
+
+            if ( !more ) {
+                break;
+            }
+        }
+
+        const qint64 len = qMin(maxSize - done, qint64(m_chunk.size()) - m_chunkPos);
+        memcpy(data + done, m_chunk.constData() + m_chunkPos, len);
+
+        done += len;
+        m_chunkPos += len;
+    }
+
+    if ( done == 0 && !isOk() ) {
+        return -1;
+    }
+
+    return done;
+}
+
+qint64 CompressedFile::writeData(const char *, qint64) {
+    return -1;
+}
+
+bool CompressedFile::nextChunk() {
+
+    QMutexLocker locker(&m_mutex);
+
+    while ( m_chunks.isEmpty() && !m_finished ) {
+        m_produced.wait(&m_mutex);
+    }
+
+    if ( m_chunks.isEmpty() ) {
+        return false;
+    }
+
+    m_chunk = m_chunks.dequeue();
+    m_chunkPos = 0;
+    m_consumed.wakeAll();
+
+    return true;
+}
+
+bool CompressedFile::tryNextChunk() {
+
+    QMutexLocker locker(&m_mutex);
+
+    if ( m_chunks.isEmpty() ) {
+        return false;
+    }
+
+    m_chunk = m_chunks.dequeue();
+    m_chunkPos = 0;
+    m_consumed.wakeAll();
+
+    return true;
+}
+
+void CompressedFile::decompress() {
+
+    bool ok = false;
+
+#ifndef DIECAT_NO_COMPRESSION
+    ok = m_format == FORMAT_GZIP ? inflateGzip() : decodeXz();
+#endif
+
+    QMutexLocker locker(&m_mutex);
+
+    m_finished = true;
+    m_failed = !ok && m_abort.loadAcquire() == 0;
+    m_produced.wakeAll();
+}
+
+bool CompressedFile::pushChunk(const QByteArray &chunk) {
+
+    QMutexLocker locker(&m_mutex);
+
+    while ( m_chunks.size() >= COMPRESSEDQUEUECHUNKS && m_abort.loadAcquire() == 0 ) {
+        m_consumed.wait(&m_mutex);
+    }
+
+    if ( m_abort.loadAcquire() != 0 ) {
+        return false;
+    }
+
+    m_chunks.enqueue(chunk);
+    m_produced.wakeAll();
+
+    return true;
+}
+
+#ifndef DIECAT_NO_COMPRESSION
+
+bool CompressedFile::inflateGzip() {
+
+    z_stream zs;
+    memset(&zs, 0, sizeof(zs));
+
+    if ( inflateInit2(&zs, 15 + 32) != Z_OK ) { // gzip or zlib header
+        return false;
+    }
+
+    QByteArray in(COMPRESSEDCHUNKSIZE, '\0');
+    QByteArray out(COMPRESSEDCHUNKSIZE, '\0');
+    bool ok = true;
+    bool streamEnd = false;
+
+    while ( ok ) {
+
+        const qint64 inLen = m_file.read(in.data(), in.size());
+
+        if ( inLen < 0 ) {
+            ok = false;
+            break;
+        }
+
+        if ( inLen == 0 ) {
+            ok = streamEnd; // a truncated file is an error
+            break;
+        }
+
+        m_compressedPos.storeRelease(m_file.pos());
+
+        zs.next_in = reinterpret_cast<Bytef *>(in.data());
+        zs.avail_in = uInt(inLen);
+
+        while ( zs.avail_in > 0 ) {
+
+            zs.next_out = reinterpret_cast<Bytef *>(out.data());
+            zs.avail_out = uInt(out.size());
+
+            const int ret = inflate(&zs, Z_NO_FLUSH);
+
+            if ( ret != Z_OK && ret != Z_STREAM_END && ret != Z_BUF_ERROR ) {
+                ok = false;
+                break;
+            }
+
+            const int produced = out.size() - int(zs.avail_out);
+
+            if ( produced > 0 && !pushChunk(out.left(produced)) ) {
+                ok = false;
+                break;
+            }
+
+            streamEnd = ret == Z_STREAM_END;
+
+            if ( streamEnd && inflateReset(&zs) != Z_OK ) { // concatenated members
+                ok = false;
+                break;
+            }
+
+            if ( ret == Z_BUF_ERROR && produced == 0 ) {
+                break; // needs more input
+            }
+        }
+    }
+
+    inflateEnd(&zs);
+
+    return ok;
+}
+
+bool CompressedFile::decodeXz() {
+
+    lzma_stream ls = LZMA_STREAM_INIT;
+
+    if ( lzma_stream_decoder(&ls, UINT64_MAX, LZMA_CONCATENATED) != LZMA_OK ) {
+        return false;
+    }
+
+    QByteArray in(COMPRESSEDCHUNKSIZE, '\0');
+    QByteArray out(COMPRESSEDCHUNKSIZE, '\0');
+    lzma_action action = LZMA_RUN;
+    bool ok = true;
+
+    forever {
+
+        if ( ls.avail_in == 0 && action == LZMA_RUN ) {
+
+            const qint64 inLen = m_file.read(in.data(), in.size());
+
+            if ( inLen < 0 ) {
+                ok = false;
+                break;
+            }
+
+            if ( inLen == 0 ) {
+                action = LZMA_FINISH;
+            }
+
+            m_compressedPos.storeRelease(m_file.pos());
+
+            ls.next_in = reinterpret_cast<const uint8_t *>(in.constData());
+            ls.avail_in = size_t(inLen);
+        }
+
+        ls.next_out = reinterpret_cast<uint8_t *>(out.data());
+        ls.avail_out = size_t(out.size());
+
+        const lzma_ret ret = lzma_code(&ls, action);
+        const int produced = out.size() - int(ls.avail_out);
+
+        if ( produced > 0 && !pushChunk(out.left(produced)) ) {
+            ok = false;
+            break;
+        }
+
+        if ( ret == LZMA_STREAM_END ) {
+            break;
+        }
+
+        if ( ret != LZMA_OK ) {
+            ok = false;
+            break;
+        }
+    }
+
+    lzma_end(&ls);
+
+    return ok;
+}
+
+#endif
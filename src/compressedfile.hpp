@@ -0,0 +1,99 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: compressedfile.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef COMPRESSEDFILE_HPP
+#define COMPRESSEDFILE_HPP
+
+#include <QIODevice>
+#include <QFile>
+#include <QString>
+#include <QByteArray>
+#include <QQueue>
+#include <QMutex>
+#include <QWaitCondition>
+#include <QFuture>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+
+// Read-only file that is plain, gzip or xz compressed; the format is taken
+// from the first bytes, not from the name. Compressed files are inflated
+// on a worker thread chunk by chunk while the reader parses the previous
+// chunks, so reading and parsing overlap. At most COMPRESSEDQUEUECHUNKS
+// chunks wait for the reader, memory does not grow with the file.
+//
+// The device is sequential: use progressPos()/progressSize() (bytes of
+// the file on disk) instead of pos()/size().
+
+class CompressedFile : public QIODevice {
+
+    Q_OBJECT
+
+public:
+    explicit CompressedFile(const QString &);
+    ~CompressedFile();
+    bool open(OpenMode);
+    void close();
+    bool isSequential() const;
+    bool atEnd() const;
+    qint64 bytesAvailable() const;
+
+    qint64 progressPos() const;
+    qint64 progressSize() const;
+
+    bool isCompressed() const {
+        return m_format != FORMAT_PLAIN;
+    }
+    bool isOk() const; // no read or decompression error so far
+
+protected:
+    qint64 readData(char *, qint64);
+    qint64 writeData(const char *, qint64);
+
+private:
+    enum { FORMAT_PLAIN, FORMAT_GZIP, FORMAT_XZ };
+
+    QFile m_file;
+    int m_format = FORMAT_PLAIN;
+
+    // filled by the worker, drained by the reader
+
+    mutable QMutex m_mutex;
+    mutable QWaitCondition m_produced;
+    QWaitCondition m_consumed;
+    QQueue<QByteArray> m_chunks;
+    bool m_finished = false;
+    bool m_failed = false;
+    QAtomicInt m_abort;
+    QAtomicInteger<qint64> m_compressedPos;
+    QFuture<void> m_worker;
+
+    QByteArray m_chunk; // being read
+    qint64 m_chunkPos = 0;
+
+    void decompress();
+    bool inflateGzip();
+    bool decodeXz();
+    bool pushChunk(const QByteArray &); // false if aborted
+    bool nextChunk();                   // waits; false at the end
+    bool tryNextChunk();                // does not wait; false if none is queued
+
+};
+
+#endif // COMPRESSEDFILE_HPP
@@ -21,17 +21,166 @@
 #ifndef CONSTANTS_HPP
 #define CONSTANTS_HPP
 
+#include <QtGlobal>
+
 #define PROGNAME "diecat"
 #define PROGVER  "0.3.3"
 
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0) // QString::SkipEmptyParts is deprecated
+#define SKIPEMPTYPARTS Qt::SkipEmptyParts
+#else
+#define SKIPEMPTYPARTS QString::SkipEmptyParts
+#endif
+
 #define A2LCHARBLOCKMINSIZE 9
 #define A2LCOMPUMETHODSIZE 6
 #define A2LCOEFFNUM 6
 #define A2LCOMPUVTABMINSIZE 4
+#define A2LMEASUREMENTMINSIZE 8
+
+#define HEXMAXRECORDSIZE 260 // count, address, type, 255 data bytes, checksum
+#define HEXWRITERECORDLEN 32
+
+#define DIFFBLOCKSIZE 64
+
+#define OVERLAYPAGESIZE 4096 // bytes, power of two
+#define DEFAULTVARIANT "Working copy"
+
+#define LOGMAXVIOLATIONS 100
+
+#define A2LCACHESIZE 8 // parsed a2l files kept for reuse
+#define A2LINCLUDECACHESIZE 64 // parsed /include files kept for reuse, by content
+#define A2LMAXINCLUDEDEPTH 16
+
+#define RELOADDELAY 500 // ms without file changes before a watched file is reloaded
+
+#define LOADCHECKINTERVAL 4096 // lines/objects between progress updates
+
+#define COMPRESSEDCHUNKSIZE 262144 // bytes decompressed at once
+#define COMPRESSEDQUEUECHUNKS 8    // decompressed chunks waiting for the parser
+
+#define EXPORTBUFFERSIZE 65536
+
+#define TRACEMAXEVENTS 100000 // later events are dropped, the statistics are kept
+
+#define QUERYMAXFRAME 16777216 // bytes, larger requests close the connection
+
+#define XCPDEFAULTPORT 5555
+#define XCPTIMEOUT 1000      // ms to wait for a command response
+#define XCPMAXDTO 1400       // bytes, a DTO fits into one UDP datagram
+
+#define LIVERINGSIZE 4096        // samples per signal between acquisition and GUI, power of 2
+#define LIVERECENTSAMPLES 8192   // newest samples per signal kept as they are
+#define LIVEHISTORYBUCKETS 2048  // min/max buckets per signal for the whole recording
+#define LIVEPLOTREFRESH 40       // ms
+
+#define FUZZYMINSIMILARITY 0.5 // share of query trigrams a fuzzy match must contain
 
 enum {
     VARTYPE_SCALAR_NUM,
     VARTYPE_SCALAR_VTAB
 };
 
+enum {
+    LIMIT_OK,
+    LIMIT_SOFT,
+    LIMIT_HARD
+};
+
+enum {
+    SEARCH_SUBSTRING,
+    SEARCH_WILDCARD,
+    SEARCH_FUZZY,
+    SEARCH_ADDRESS
+};
+
+enum { // XCP checksum types
+    CHECKSUM_ADD_11,
+    CHECKSUM_ADD_12,
+    CHECKSUM_ADD_14,
+    CHECKSUM_ADD_22,
+    CHECKSUM_ADD_24,
+    CHECKSUM_ADD_44,
+    CHECKSUM_CRC_16,
+    CHECKSUM_CRC_16_CITT,
+    CHECKSUM_CRC_32,
+    CHECKSUM_CRC_32C
+};
+
+enum {
+    EXPORT_CSV,
+    EXPORT_JSONL,
+    EXPORT_BINARY,
+    EXPORT_DCM,
+    EXPORT_CDFX
+};
+
+enum { // diecat-cli exit codes
+    CLIEXIT_OK,
+    CLIEXIT_USAGE,
+    CLIEXIT_A2L,
+    CLIEXIT_HEX,
+    CLIEXIT_OUTPUT,
+    CLIEXIT_UNKNOWNLABEL,
+    CLIEXIT_NODATA,
+    CLIEXIT_HARDLIMIT,
+    CLIEXIT_DCM
+};
+
+enum { // query daemon requests
+    QUERY_OPEN = 1,
+    QUERY_CLOSE,
+    QUERY_LOOKUP,
+    QUERY_READ,
+    QUERY_DIFF,
+    QUERY_RELOAD,
+    QUERY_ADDRESS
+};
+
+enum { // query daemon reply status
+    QUERYSTATUS_OK,
+    QUERYSTATUS_BADREQUEST,
+    QUERYSTATUS_UNKNOWNPROJECT,
+    QUERYSTATUS_A2L,
+    QUERYSTATUS_HEX,
+    QUERYSTATUS_DUPLICATE
+};
+
+enum { // status of a single value in a QUERY_READ reply
+    QUERYVALUE_OK,
+    QUERYVALUE_NODATA,
+    QUERYVALUE_BADINDEX
+};
+
+enum { // XCP commands
+    XCP_CONNECT = 0xFF,
+    XCP_DISCONNECT = 0xFE,
+    XCP_GET_STATUS = 0xFD,
+    XCP_SET_DAQ_PTR = 0xE2,
+    XCP_WRITE_DAQ = 0xE1,
+    XCP_SET_DAQ_LIST_MODE = 0xE0,
+    XCP_START_STOP_DAQ_LIST = 0xDE,
+    XCP_START_STOP_SYNCH = 0xDD,
+    XCP_FREE_DAQ = 0xD6,
+    XCP_ALLOC_DAQ = 0xD5,
+    XCP_ALLOC_ODT = 0xD4,
+    XCP_ALLOC_ODT_ENTRY = 0xD3
+};
+
+enum { // XCP packet identifiers of the slave, DTOs use 0x00 - 0xFB
+    XCP_PID_RES = 0xFF,
+    XCP_PID_ERR = 0xFE,
+    XCP_PID_EV = 0xFD,
+    XCP_PID_SERV = 0xFC
+};
+
+enum { // XCP error codes
+    XCP_ERR_CMD_UNKNOWN = 0x20,
+    XCP_ERR_CMD_SYNTAX = 0x21,
+    XCP_ERR_OUT_OF_RANGE = 0x22,
+    XCP_ERR_SEQUENCE = 0x29,
+    XCP_ERR_DAQ_CONFIG = 0x2A,
+    XCP_ERR_MEMORY_OVERFLOW = 0x30
+};
+
 #endif // CONSTANTS_HPP
@@ -0,0 +1,79 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: daemonmain.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "constants.hpp"
+#include "queryserver.hpp"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QTextStream>
+#include <QDateTime>
+#include <QString>
+#include <QStringList>
+
+#include <cstdio>
+
+// Query daemon: keeps projects loaded and answers label lookups, value
+// reads and hex comparisons over a local socket (see queryserver.hpp).
+
+int main(int argc, char *argv[]) {
+
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QString(PROGNAME) + "d");
+    QCoreApplication::setApplicationVersion(QString(PROGVER));
+
+    QTextStream err(stderr);
+
+    //
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Answers a2l/hex queries over a local socket.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    const QCommandLineOption socketOption(
+                QStringList() << "s" << "socket",
+                "Socket name or path (" + QString(PROGNAME) + " by default).",
+                "name", QString(PROGNAME));
+
+    parser.addOption(socketOption);
+    parser.process(app);
+
+    //
+
+    QueryServer server;
+
+    QObject::connect(&server, &QueryServer::message, [&err](const QString &msg) {
+        err << QDateTime::currentDateTime().toString("[yyyy-MM-dd_hh-mm-ss]") + " " + msg << "\n";
+        err.flush();
+    });
+
+    if ( !server.listen(parser.value(socketOption)) ) {
+        err << "Can not listen on " << parser.value(socketOption) << ": " << server.errorString() << "\n";
+        return 1;
+    }
+
+    err << QDateTime::currentDateTime().toString("[yyyy-MM-dd_hh-mm-ss]") + " Listening on "
+        << parser.value(socketOption) << "\n";
+    err.flush();
+
+    return app.exec();
+}
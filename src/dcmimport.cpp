@@ -0,0 +1,205 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: dcmimport.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "dcmimport.hpp"
+#include "scalarcodec.hpp"
+#include "constants.hpp"
+#include "trace.hpp"
+
+#include <QFile>
+#include <QByteArray>
+
+static QByteArray firstToken(const QByteArray &line, QByteArray &rest) {
+
+    const int end = line.indexOf(' ');
+
+    if ( end < 0 ) {
+        rest.clear();
+        return line;
+    }
+
+    rest = line.mid(end + 1).trimmed();
+
+    return line.left(end);
+}
+
+static QString unquote(const QByteArray &str) {
+
+    const int begin = str.indexOf('"');
+    const int end = str.lastIndexOf('"');
+
+    if ( begin < 0 || end <= begin ) {
+        return QString::fromUtf8(str);
+    }
+
+    return QString::fromUtf8(str.constData() + begin + 1, end - begin - 1);
+}
+
+DcmImport::DcmImport(const QVector< QSharedPointer<ECUScalar> > &scalars) :
+    m_scalars(scalars) {
+
+    m_byName.reserve(scalars.size());
+
+    for ( ptrdiff_t i=0; i<scalars.size(); i++ ) {
+        m_byName.insert(scalars[i]->name(), i);
+    }
+}
+
+bool DcmImport::read(const QString &path) {
+
+    QFile file(path);
+
+    if ( !file.open(QIODevice::ReadOnly) ) {
+        m_error = file.errorString();
+        return false;
+    }
+
+    return read(&file);
+}
+
+bool DcmImport::read(QIODevice *device) {
+
+    TraceScope trace("dcm.read");
+
+    m_values.clear();
+    m_unknown.clear();
+    m_skipped.clear();
+    m_error.clear();
+
+    // block state: no block, a FESTWERT or some other block until END
+
+    enum { OUTSIDE, FESTWERT, OTHER } state = OUTSIDE;
+
+    QString name;
+    ptrdiff_t index = -1;
+    bool hasValue = false;
+    double value = 0;
+
+    QByteArray rest;
+    qint64 lines = 0;
+
+    while ( !device->atEnd() ) {
+
+        const QByteArray line = device->readLine().simplified();
+        lines++;
+
+        if ( line.isEmpty() || line[0] == '*' || line[0] == '!' || line[0] == '.' ) { // comments
+            continue;
+        }
+
+        const QByteArray keyword = firstToken(line, rest);
+
+        if ( state == OUTSIDE ) {
+
+            if ( keyword == "KONSERVIERUNG_FORMAT" ) {
+                continue;
+            }
+
+            name = QString::fromUtf8(firstToken(rest, rest));
+
+            if ( keyword == "FESTWERT" ) {
+
+                index = m_byName.value(name, -1);
+                hasValue = false;
+                state = FESTWERT;
+
+                if ( index < 0 ) {
+                    m_unknown.push_back(name);
+                }
+            }
+            else {
+
+                if ( !name.isEmpty() && keyword != "FUNKTIONEN" && keyword != "VARIANTENKODIERUNG" ) {
+                    m_skipped.push_back(name);
+                }
+
+                state = OTHER;
+            }
+
+            continue;
+        }
+
+        if ( keyword == "END" ) {
+
+            if ( state == FESTWERT && index >= 0 ) {
+
+                if ( hasValue ) {
+
+                    DcmValue val;
+                    val.index = index;
+                    val.value = value;
+
+                    m_values.push_back(val);
+                }
+                else {
+                    m_skipped.push_back(name);
+                }
+            }
+
+            state = OUTSIDE;
+            continue;
+        }
+
+        if ( state != FESTWERT || index < 0 ) {
+            continue;
+        }
+
+        if ( keyword == "WERT" ) {
+            value = firstToken(rest, rest).toDouble(&hasValue);
+        }
+        else if ( keyword == "TEXT" ) {
+            value = m_scalars[index]->vTable().indexOf(unquote(rest));
+            hasValue = value >= 0;
+        }
+    }
+
+    if ( state != OUTSIDE ) {
+        m_error = "Unexpected end of file, block " + name + " has no END";
+        return false;
+    }
+
+    Trace::instance().count("dcm.lines", lines);
+    Trace::instance().count("dcm.values", m_values.size());
+
+    return true;
+}
+
+ptrdiff_t DcmImport::apply(ImageOverlay &overlay, QStringList &failed) const {
+
+    ptrdiff_t written = 0;
+    char data[sizeof(quint64)];
+
+    for ( ptrdiff_t n=0; n<m_values.size(); n++ ) {
+
+        const ECUScalar &scal = *m_scalars[m_values[n].index];
+
+        if ( scal.isReadOnly()
+             || !ScalarCodec::encode(scal, m_values[n].value, data)
+             || !overlay.write(scal.addressNum(), data, ScalarCodec::length(scal.numType())) ) {
+
+            failed.push_back(scal.name());
+            continue;
+        }
+
+        written++;
+    }
+
+    return written;
+}
@@ -0,0 +1,75 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: dcmimport.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DCMIMPORT_HPP
+#define DCMIMPORT_HPP
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QSharedPointer>
+#include <QIODevice>
+
+#include "ecuscalar.hpp"
+#include "imageoverlay.hpp"
+
+struct DcmValue {
+    ptrdiff_t index; // scalar
+    double value;
+};
+
+// Reads the FESTWERT blocks of a DCM file in one pass and matches them
+// to the scalars by name. Other block types (curves, maps, value blocks)
+// have no scalar to go to and are skipped.
+
+class DcmImport {
+
+public:
+    explicit DcmImport(const QVector< QSharedPointer<ECUScalar> > &);
+    bool read(const QString &);
+    bool read(QIODevice *);
+    ptrdiff_t apply(ImageOverlay &, QStringList &) const; // written values; failed labels
+
+    const QVector<DcmValue> &values() const {
+        return m_values;
+    }
+    QStringList unknownLabels() const { // not in the a2l
+        return m_unknown;
+    }
+    QStringList skippedLabels() const { // unsupported blocks or values
+        return m_skipped;
+    }
+    QString errorString() const {
+        return m_error;
+    }
+
+private:
+    QVector< QSharedPointer<ECUScalar> > m_scalars;
+    QHash<QString, ptrdiff_t> m_byName;
+
+    QVector<DcmValue> m_values;
+    QStringList m_unknown;
+    QStringList m_skipped;
+    QString m_error;
+
+};
+
+#endif // DCMIMPORT_HPP
@@ -0,0 +1,79 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: diecat.h
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef DIECAT_H
+#define DIECAT_H
+
+// C interface of libdiecat. A project is an a2l file with an optional hex
+// file; labels are addressed by their index (0 .. diecat_count()-1).
+// Strings returned by the library are UTF-8 and stay valid until the
+// project is closed or its hex file is reloaded.
+
+#if defined(DIECAT_STATIC)
+#  define DIECAT_API
+#elif defined(_WIN32)
+#  if defined(DIECAT_LIBRARY)
+#    define DIECAT_API __declspec(dllexport)
+#  else
+#    define DIECAT_API __declspec(dllimport)
+#  endif
+#else
+#  define DIECAT_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum {
+    DIECAT_OK = 0,
+    DIECAT_ERR_ARGUMENT,
+    DIECAT_ERR_A2L,
+    DIECAT_ERR_HEX,
+    DIECAT_ERR_NODATA
+};
+
+typedef struct diecat_project diecat_project;
+
+DIECAT_API const char *diecat_version(void);
+
+// hex may be 0; error (may be 0) receives one of the codes above
+DIECAT_API diecat_project *diecat_open(const char *a2l, const char *hex, int *error);
+DIECAT_API void diecat_close(diecat_project *project);
+DIECAT_API int diecat_load_hex(diecat_project *project, const char *hex);
+
+DIECAT_API long diecat_count(const diecat_project *project);
+DIECAT_API long diecat_find(const diecat_project *project, const char *name); // -1 if unknown
+
+DIECAT_API const char *diecat_name(diecat_project *project, long index);
+DIECAT_API const char *diecat_description(diecat_project *project, long index);
+DIECAT_API const char *diecat_unit(diecat_project *project, long index);
+DIECAT_API unsigned long diecat_address(const diecat_project *project, long index);
+DIECAT_API int diecat_is_vtab(const diecat_project *project, long index);
+
+DIECAT_API int diecat_value(const diecat_project *project, long index, double *value);
+DIECAT_API const char *diecat_text(diecat_project *project, long index); // 0 without data
+DIECAT_API int diecat_hard_limits(const diecat_project *project, long index, double *min, double *max);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DIECAT_H
@@ -0,0 +1,261 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: diecatapi.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "diecat.h"
+#include "constants.hpp"
+#include "a2lcache.hpp"
+#include "intelhex.hpp"
+#include "memoryimage.hpp"
+#include "scalarcodec.hpp"
+#include "ecuscalar.hpp"
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QByteArray>
+#include <QSharedPointer>
+
+#include <cmath>
+#include <limits>
+
+struct diecat_project {
+    QVector< QSharedPointer<ECUScalar> > scalars;
+    QHash<QString, ptrdiff_t> indexOf;
+    QVector<double> values;      // NaN if there is no data
+    QVector<QByteArray> names;   // UTF-8 strings are filled on demand
+    QVector<QByteArray> descrs;
+    QVector<QByteArray> units;
+    QVector<QByteArray> texts;
+};
+
+static bool validIndex(const diecat_project *project, long index) {
+    return project && index >= 0 && index < project->scalars.size();
+}
+
+static const char *cachedString(QVector<QByteArray> &cache, long index, const QString &str) {
+
+    if ( cache[index].isNull() ) {
+        cache[index] = str.toUtf8();
+    }
+
+    return cache[index].constData();
+}
+
+//
+
+const char *diecat_version(void) {
+    return PROGVER;
+}
+
+diecat_project *diecat_open(const char *a2l, const char *hex, int *error) {
+
+    if ( error ) {
+        *error = DIECAT_OK;
+    }
+
+    if ( !a2l ) {
+
+        if ( error ) {
+            *error = DIECAT_ERR_ARGUMENT;
+        }
+
+        return 0;
+    }
+
+    bool ok = false;
+    const QVector< QSharedPointer<ECUScalar> > scalars = A2LCache::instance().scalars(QString::fromUtf8(a2l), &ok);
+
+    if ( !ok ) {
+
+        if ( error ) {
+            *error = DIECAT_ERR_A2L;
+        }
+
+        return 0;
+    }
+
+    diecat_project *project = new diecat_project;
+    project->scalars = scalars;
+    project->indexOf.reserve(scalars.size());
+    project->values.fill(std::numeric_limits<double>::quiet_NaN(), scalars.size());
+    project->names.resize(scalars.size());
+    project->descrs.resize(scalars.size());
+    project->units.resize(scalars.size());
+    project->texts.resize(scalars.size());
+
+    for ( ptrdiff_t i=0; i<scalars.size(); i++ ) {
+        project->indexOf.insert(scalars[i]->name(), i);
+    }
+
+    if ( hex ) {
+
+        const int status = diecat_load_hex(project, hex);
+
+        if ( status != DIECAT_OK ) {
+
+            delete project;
+
+            if ( error ) {
+                *error = status;
+            }
+
+            return 0;
+        }
+    }
+
+    return project;
+}
+
+void diecat_close(diecat_project *project) {
+    delete project;
+}
+
+int diecat_load_hex(diecat_project *project, const char *hex) {
+
+    if ( !project || !hex ) {
+        return DIECAT_ERR_ARGUMENT;
+    }
+
+    bool ok = false;
+    const MemoryImage image = IntelHEX::load(QString::fromUtf8(hex), &ok);
+
+    if ( !ok ) {
+        return DIECAT_ERR_HEX;
+    }
+
+    // labels without data in the image are not an error here,
+    // diecat_value() reports them
+
+    project->texts = QVector<QByteArray>(project->scalars.size());
+
+    for ( ptrdiff_t i=0; i<project->scalars.size(); i++ ) {
+
+        if ( !ScalarCodec::decode(*project->scalars[i], image, project->values[i]) ) {
+            project->values[i] = std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+
+    return DIECAT_OK;
+}
+
+long diecat_count(const diecat_project *project) {
+    return project ? long(project->scalars.size()) : 0;
+}
+
+long diecat_find(const diecat_project *project, const char *name) {
+
+    if ( !project || !name ) {
+        return -1;
+    }
+
+    return long(project->indexOf.value(QString::fromUtf8(name), -1));
+}
+
+const char *diecat_name(diecat_project *project, long index) {
+
+    if ( !validIndex(project, index) ) {
+        return 0;
+    }
+
+    return cachedString(project->names, index, project->scalars[index]->name());
+}
+
+const char *diecat_description(diecat_project *project, long index) {
+
+    if ( !validIndex(project, index) ) {
+        return 0;
+    }
+
+    return cachedString(project->descrs, index, project->scalars[index]->shortDescription());
+}
+
+const char *diecat_unit(diecat_project *project, long index) {
+
+    if ( !validIndex(project, index) ) {
+        return 0;
+    }
+
+    return cachedString(project->units, index, project->scalars[index]->dimension());
+}
+
+unsigned long diecat_address(const diecat_project *project, long index) {
+
+    if ( !validIndex(project, index) ) {
+        return 0;
+    }
+
+    return project->scalars[index]->addressNum();
+}
+
+int diecat_is_vtab(const diecat_project *project, long index) {
+
+    if ( !validIndex(project, index) ) {
+        return 0;
+    }
+
+    return project->scalars[index]->type() == VARTYPE_SCALAR_VTAB;
+}
+
+int diecat_value(const diecat_project *project, long index, double *value) {
+
+    if ( !validIndex(project, index) || !value ) {
+        return DIECAT_ERR_ARGUMENT;
+    }
+
+    if ( std::isnan(project->values[index]) ) {
+        return DIECAT_ERR_NODATA;
+    }
+
+    *value = project->values[index];
+
+    return DIECAT_OK;
+}
+
+const char *diecat_text(diecat_project *project, long index) {
+
+    if ( !validIndex(project, index) ) {
+        return 0;
+    }
+
+    const double val = project->values[index];
+
+    if ( std::isnan(val) ) {
+        return 0;
+    }
+
+    return cachedString(project->texts, index, ScalarCodec::toDisplayString(*project->scalars[index], val));
+}
+
+int diecat_hard_limits(const diecat_project *project, long index, double *min, double *max) {
+
+    if ( !validIndex(project, index) ) {
+        return DIECAT_ERR_ARGUMENT;
+    }
+
+    if ( min ) {
+        *min = project->scalars[index]->minValueHard();
+    }
+
+    if ( max ) {
+        *max = project->scalars[index]->maxValueHard();
+    }
+
+    return DIECAT_OK;
+}
@@ -37,6 +37,7 @@ void ECUScalar::setType(ptrdiff_t type) {
 
 void ECUScalar::setAddress(const QString &addr) {
     m_addr = addr;
+    m_addrNum = addr.toUInt(0, 16);
 }
 
 void ECUScalar::setNumType(const QString &numtype) {
@@ -83,6 +84,10 @@ void ECUScalar::setValue(QString val) {
     m_val = val;
 }
 
+void ECUScalar::setPhysValue(double val) {
+    m_physVal = val;
+}
+
 void ECUScalar::setVTable(const QStringList &vtab) {
     m_vtab = vtab;
 }
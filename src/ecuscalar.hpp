@@ -25,6 +25,8 @@
 #include <QVector>
 #include <QStringList>
 
+#include <limits>
+
 #include "constants.hpp"
 
 class ECUScalar {
@@ -46,6 +48,7 @@ public:
     void setReadOnly(bool);
     void setDimension(const QString &);
     void setValue(QString);
+    void setPhysValue(double);
     void setVTable(const QStringList &);
 
     QString name() const {
@@ -60,6 +63,9 @@ public:
     QString address() const {
         return m_addr;
     }
+    quint32 addressNum() const {
+        return m_addrNum;
+    }
     QString numType() const {
         return m_numType;
     }
@@ -93,6 +99,9 @@ public:
     QString value() const {
         return m_val;
     }
+    double physValue() const { // NaN if not read from hex
+        return m_physVal;
+    }
     QStringList vTable() const {
         return m_vtab;
     }
@@ -102,6 +111,7 @@ private:
     QString m_shortDescr;
     ptrdiff_t m_type = VARTYPE_SCALAR_NUM;
     QString m_addr;
+    quint32 m_addrNum = 0;
     QString m_numType;
     double m_rangeSoft = 0;
     QVector<double> m_coeff;
@@ -113,6 +123,7 @@ private:
     bool m_readOnly = false;
     QString m_dim;
     QString m_val;
+    double m_physVal = std::numeric_limits<double>::quiet_NaN();
     QStringList m_vtab;
 
 };
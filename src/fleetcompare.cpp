@@ -0,0 +1,226 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: fleetcompare.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "fleetcompare.hpp"
+#include "intelhex.hpp"
+#include "scalarcodec.hpp"
+#include "trace.hpp"
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QSharedPointer>
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QIODevice>
+#include <QAtomicInteger>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <algorithm>
+
+static void decodeAll(const QVector< QSharedPointer<ECUScalar> > &scalars, const MemoryImage &image,
+                      QVector<double> &values, QVector<bool> &valid) {
+
+    values.resize(scalars.size());
+    valid.resize(scalars.size());
+
+    for ( ptrdiff_t i=0; i<scalars.size(); i++ ) {
+
+        values[i] = 0;
+        valid[i] = ScalarCodec::decode(*scalars[i], image, values[i]);
+    }
+}
+
+static bool sameValue(bool valid1, double val1, bool valid2, double val2) {
+
+    if ( valid1 != valid2 ) {
+        return false;
+    }
+
+    return !valid1 || val1 == val2 || (val1 != val1 && val2 != val2); // NaN == NaN here
+}
+
+class FleetDecoder {
+
+public:
+    FleetDecoder(const QVector< QSharedPointer<ECUScalar> > &scalars, LoadControl *control,
+                 QAtomicInteger<qint64> *bytesDone, QAtomicInteger<qint64> *filesDone, qint64 bytesTotal) :
+        m_scalars(scalars),
+        m_control(control),
+        m_bytesDone(bytesDone),
+        m_filesDone(filesDone),
+        m_bytesTotal(bytesTotal) {
+    }
+
+    void operator()(FleetEntry &entry) const {
+
+        if ( m_control && m_control->isCanceled() ) {
+            return;
+        }
+
+        const qint64 size = QFileInfo(entry.path).size();
+        IntelHEX ihex(entry.path);
+
+        if ( ihex.readHex() ) {
+            decodeAll(m_scalars, ihex.image(), entry.values, entry.valid);
+            entry.ok = true;
+        }
+
+        if ( m_control ) {
+            m_control->setProgress(m_bytesDone->fetchAndAddRelaxed(size) + size, m_bytesTotal);
+            m_control->setObjects(m_filesDone->fetchAndAddRelaxed(1) + 1);
+        }
+    }
+
+private:
+    const QVector< QSharedPointer<ECUScalar> > &m_scalars;
+    LoadControl *m_control;
+    QAtomicInteger<qint64> *m_bytesDone;
+    QAtomicInteger<qint64> *m_filesDone;
+    qint64 m_bytesTotal;
+
+};
+
+FleetCompare::FleetCompare(const QVector< QSharedPointer<ECUScalar> > &scalars,
+                           const MemoryImage &reference) :
+    m_scalars(scalars) {
+
+    decodeAll(m_scalars, reference, m_refValues, m_refValid);
+}
+
+void FleetCompare::setLoadControl(LoadControl *control) {
+    m_control = control;
+}
+
+bool FleetCompare::run(const QStringList &hexPaths) {
+
+    TraceScope trace("fleet");
+
+    m_entries = QVector<FleetEntry>(hexPaths.size());
+    qint64 bytesTotal = 0;
+
+    for ( ptrdiff_t i=0; i<hexPaths.size(); i++ ) {
+        m_entries[i].path = hexPaths[i];
+        bytesTotal += QFileInfo(hexPaths[i]).size();
+    }
+
+    QAtomicInteger<qint64> bytesDone(0);
+    QAtomicInteger<qint64> filesDone(0);
+
+    if ( m_control ) {
+        m_control->setProgress(0, bytesTotal);
+        m_control->setObjects(0);
+    }
+
+    QtConcurrent::blockingMap(m_entries, FleetDecoder(m_scalars, m_control, &bytesDone, &filesDone, bytesTotal));
+
+    //
+
+    m_deviatingFiles = QVector<ptrdiff_t>(m_scalars.size(), 0);
+
+    for ( ptrdiff_t n=0; n<m_entries.size(); n++ ) {
+
+        FleetEntry &entry = m_entries[n];
+
+        if ( !entry.ok ) {
+            continue;
+        }
+
+        for ( ptrdiff_t i=0; i<m_scalars.size(); i++ ) {
+
+            if ( !sameValue(m_refValid[i], m_refValues[i], entry.valid[i], entry.values[i]) ) {
+                entry.deviations++;
+                m_deviatingFiles[i]++;
+            }
+        }
+    }
+
+    return !m_control || !m_control->isCanceled();
+}
+
+bool FleetCompare::writeMatrix(const QString &path) const {
+
+    QFile file(path);
+
+    if ( !file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text) ) {
+        return false;
+    }
+
+    return writeMatrix(&file);
+}
+
+bool FleetCompare::writeMatrix(QIODevice *device) const {
+
+    QTextStream out(device);
+
+    out << "Label;Reference;Deviating files";
+
+    for ( ptrdiff_t n=0; n<m_entries.size(); n++ ) {
+        out << ";" << QFileInfo(m_entries[n].path).fileName();
+    }
+
+    out << "\n";
+
+    for ( ptrdiff_t i=0; i<m_scalars.size(); i++ ) {
+
+        out << m_scalars[i]->name() << ";"
+            << (m_refValid[i] ? ScalarCodec::toString(*m_scalars[i], m_refValues[i]) : QString()) << ";"
+            << m_deviatingFiles.value(i);
+
+        for ( ptrdiff_t n=0; n<m_entries.size(); n++ ) {
+
+            out << ";";
+
+            if ( m_entries[n].ok && m_entries[n].valid[i] ) {
+                out << ScalarCodec::toString(*m_scalars[i], m_entries[n].values[i]);
+            }
+        }
+
+        out << "\n";
+    }
+
+    out.flush();
+
+    return out.status() == QTextStream::Ok;
+}
+
+QVector<ptrdiff_t> FleetCompare::mostDeviating(ptrdiff_t count) const {
+
+    QVector<ptrdiff_t> order;
+
+    for ( ptrdiff_t i=0; i<m_deviatingFiles.size(); i++ ) {
+
+        if ( m_deviatingFiles[i] > 0 ) {
+            order.push_back(i);
+        }
+    }
+
+    const QVector<ptrdiff_t> &deviatingFiles = m_deviatingFiles;
+
+    std::stable_sort(order.begin(), order.end(),
+                     [&deviatingFiles](ptrdiff_t a, ptrdiff_t b) { return deviatingFiles[a] > deviatingFiles[b]; });
+
+    if ( order.size() > count ) {
+        order.resize(count);
+    }
+
+    return order;
+}
@@ -0,0 +1,82 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: fleetcompare.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef FLEETCOMPARE_HPP
+#define FLEETCOMPARE_HPP
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QSharedPointer>
+
+#include "ecuscalar.hpp"
+#include "memoryimage.hpp"
+#include "loadcontrol.hpp"
+
+class QIODevice;
+
+struct FleetEntry {
+    QString path;
+    bool ok = false;           // false if the hex file could not be read
+    QVector<double> values;
+    QVector<bool> valid;       // false if the image does not contain the scalar
+    ptrdiff_t deviations = 0;  // number of values that differ from the reference
+};
+
+// Decodes many hex files against one parsed A2L on the global thread pool.
+// The scalars are shared read-only between the workers. With a load
+// control, the progress is the size of the files read so far and the
+// objects are the files done; a canceled run skips the remaining files.
+
+class FleetCompare {
+
+public:
+    FleetCompare(const QVector< QSharedPointer<ECUScalar> > &, const MemoryImage &);
+    void setLoadControl(LoadControl *);
+    bool run(const QStringList &); // false if canceled
+    bool writeMatrix(const QString &) const;
+    bool writeMatrix(QIODevice *) const;
+    QVector<ptrdiff_t> mostDeviating(ptrdiff_t) const; // scalars deviating in most files, at most n
+
+    const QVector< QSharedPointer<ECUScalar> > &scalars() const {
+        return m_scalars;
+    }
+
+    const QVector<FleetEntry> &entries() const {
+        return m_entries;
+    }
+    const QVector<double> &referenceValues() const {
+        return m_refValues;
+    }
+    const QVector<ptrdiff_t> &deviatingFiles() const { // per scalar
+        return m_deviatingFiles;
+    }
+
+private:
+    QVector< QSharedPointer<ECUScalar> > m_scalars;
+    QVector<double> m_refValues;
+    QVector<bool> m_refValid;
+    QVector<FleetEntry> m_entries;
+    QVector<ptrdiff_t> m_deviatingFiles;
+    LoadControl *m_control = 0;
+
+};
+
+#endif // FLEETCOMPARE_HPP
@@ -0,0 +1,225 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: imagediff.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "imagediff.hpp"
+#include "scalarcodec.hpp"
+#include "constants.hpp"
+#include "trace.hpp"
+
+#include <QVector>
+#include <QMap>
+#include <QByteArray>
+#include <QSharedPointer>
+
+#include <algorithm>
+#include <cstring>
+
+static void addRange(QVector<AddressRange> &ranges, quint64 begin, quint64 end) {
+
+    if ( begin >= end ) {
+        return;
+    }
+
+    if ( !ranges.isEmpty() && ranges.last().end == begin ) {
+        ranges.last().end = quint32(end);
+        return;
+    }
+
+    AddressRange r;
+    r.begin = quint32(begin);
+    r.end = quint32(end);
+    ranges.push_back(r);
+}
+
+static void compareBytes(const char *a, const char *b, size_t n, quint32 base,
+                         QVector<AddressRange> &ranges) {
+
+    size_t i = 0;
+
+    while ( i < n ) {
+
+        while ( i + DIFFBLOCKSIZE <= n && memcmp(a + i, b + i, DIFFBLOCKSIZE) == 0 ) {
+            i += DIFFBLOCKSIZE;
+        }
+
+        const size_t lim = (i + DIFFBLOCKSIZE < n) ? (i + DIFFBLOCKSIZE) : n;
+
+        while ( i < lim && a[i] == b[i] ) {
+            i++;
+        }
+
+        if ( i == lim ) {
+            continue;
+        }
+
+        const size_t start = i;
+
+        while ( i < n && a[i] != b[i] ) {
+            i++;
+        }
+
+        addRange(ranges, quint64(base) + start, quint64(base) + i);
+    }
+}
+
+// Compares every segment of the first image with the second one. Bytes
+// missing in the second image count as changed. With onlyMissing set the
+// overlapping parts are skipped (used for the reverse pass).
+
+static void compareSegments(const MemoryImage &first, const MemoryImage &second,
+                            bool onlyMissing, QVector<AddressRange> &ranges) {
+
+    const QMap<quint32, QByteArray> &segs = second.segments();
+
+    for ( QMap<quint32, QByteArray>::const_iterator it = first.segments().constBegin();
+          it != first.segments().constEnd(); ++it ) {
+
+        const quint64 segBegin = it.key();
+        const quint64 segEnd = segBegin + it.value().size();
+        quint64 cursor = segBegin;
+
+        QMap<quint32, QByteArray>::const_iterator jt = segs.upperBound(it.key());
+
+        if ( jt != segs.constBegin() ) {
+            --jt;
+        }
+
+        for ( ; jt != segs.constEnd() && jt.key() < segEnd; ++jt ) {
+
+            const quint64 otherBegin = jt.key();
+            const quint64 otherEnd = otherBegin + jt.value().size();
+
+            if ( otherEnd <= cursor ) {
+                continue;
+            }
+
+            if ( otherBegin > cursor ) {
+                addRange(ranges, cursor, otherBegin);
+                cursor = otherBegin;
+            }
+
+            const quint64 overlapEnd = (otherEnd < segEnd) ? otherEnd : segEnd;
+
+            if ( !onlyMissing ) {
+                compareBytes(it.value().constData() + (cursor - segBegin),
+                             jt.value().constData() + (cursor - otherBegin),
+                             overlapEnd - cursor, quint32(cursor), ranges);
+            }
+
+            cursor = overlapEnd;
+        }
+
+        addRange(ranges, cursor, segEnd);
+    }
+}
+
+static bool rangeLessThan(const AddressRange &r1, const AddressRange &r2) {
+    return r1.begin < r2.begin;
+}
+
+QVector<AddressRange> ImageDiff::compare(const MemoryImage &oldImage, const MemoryImage &newImage) {
+
+    QVector<AddressRange> ranges;
+
+    compareSegments(oldImage, newImage, false, ranges);
+    compareSegments(newImage, oldImage, true, ranges);
+
+    std::sort(ranges.begin(), ranges.end(), rangeLessThan);
+
+    QVector<AddressRange> merged;
+
+    for ( ptrdiff_t i=0; i<ranges.size(); i++ ) {
+
+        if ( !merged.isEmpty() && merged.last().end >= ranges[i].begin ) {
+
+            if ( ranges[i].end > merged.last().end ) {
+                merged.last().end = ranges[i].end;
+            }
+
+            continue;
+        }
+
+        merged.push_back(ranges[i]);
+    }
+
+    return merged;
+}
+
+QVector<ptrdiff_t> ImageDiff::affectedScalars(const QVector<AddressRange> &ranges,
+                                              const QVector< QSharedPointer<ECUScalar> > &scalars) {
+
+    if ( ranges.isEmpty() ) {
+        return QVector<ptrdiff_t>();
+    }
+
+    AddressIndex index;
+    index.build(scalars);
+
+    return affectedScalars(ranges, index);
+}
+
+QVector<ptrdiff_t> ImageDiff::affectedScalars(const QVector<AddressRange> &ranges, const AddressIndex &index) {
+
+    QVector<ptrdiff_t> ret;
+
+    for ( ptrdiff_t n=0; n<ranges.size(); n++ ) {
+        ret += index.overlapping(ranges[n].begin, ranges[n].end);
+    }
+
+    std::sort(ret.begin(), ret.end());
+    ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+
+    return ret;
+}
+
+QVector<ScalarChange> ImageDiff::changedScalars(const MemoryImage &oldImage, const MemoryImage &newImage,
+                                                const QVector< QSharedPointer<ECUScalar> > &scalars) {
+
+    AddressIndex index;
+    index.build(scalars);
+
+    return changedScalars(oldImage, newImage, scalars, index);
+}
+
+QVector<ScalarChange> ImageDiff::changedScalars(const MemoryImage &oldImage, const MemoryImage &newImage,
+                                                const QVector< QSharedPointer<ECUScalar> > &scalars,
+                                                const AddressIndex &index) {
+
+    TraceScope trace("diff");
+
+    const QVector<ptrdiff_t> affected = affectedScalars(compare(oldImage, newImage), index);
+    QVector<ScalarChange> ret;
+
+    ret.reserve(affected.size());
+
+    for ( ptrdiff_t i=0; i<affected.size(); i++ ) {
+
+        ScalarChange change;
+        change.index = affected[i];
+        change.oldValue = 0;
+        change.newValue = 0;
+        change.oldValid = ScalarCodec::decode(*scalars[change.index], oldImage, change.oldValue);
+        change.newValid = ScalarCodec::decode(*scalars[change.index], newImage, change.newValue);
+
+        ret.push_back(change);
+    }
+
+    return ret;
+}
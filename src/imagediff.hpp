@@ -0,0 +1,62 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: imagediff.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef IMAGEDIFF_HPP
+#define IMAGEDIFF_HPP
+
+#include <QVector>
+#include <QSharedPointer>
+
+#include "ecuscalar.hpp"
+#include "memoryimage.hpp"
+#include "addressindex.hpp"
+
+struct AddressRange {
+    quint32 begin;
+    quint32 end; // exclusive
+};
+
+struct ScalarChange {
+    ptrdiff_t index;    // index in the scalars vector
+    bool oldValid;      // false if the old image does not contain the scalar
+    bool newValid;
+    double oldValue;
+    double newValue;
+};
+
+// Finds changed byte ranges between two images and maps them to
+// characteristics, so only the affected scalars have to be decoded.
+
+class ImageDiff {
+
+public:
+    static QVector<AddressRange> compare(const MemoryImage &, const MemoryImage &);
+    static QVector<ptrdiff_t> affectedScalars(const QVector<AddressRange> &,
+                                              const QVector< QSharedPointer<ECUScalar> > &);
+    static QVector<ptrdiff_t> affectedScalars(const QVector<AddressRange> &, const AddressIndex &);
+    static QVector<ScalarChange> changedScalars(const MemoryImage &, const MemoryImage &,
+                                                const QVector< QSharedPointer<ECUScalar> > &);
+    static QVector<ScalarChange> changedScalars(const MemoryImage &, const MemoryImage &,
+                                                const QVector< QSharedPointer<ECUScalar> > &,
+                                                const AddressIndex &); // index built for the scalars
+
+};
+
+#endif // IMAGEDIFF_HPP
@@ -0,0 +1,223 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: imageoverlay.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "imageoverlay.hpp"
+#include "constants.hpp"
+
+#include <QByteArray>
+#include <QMap>
+#include <QVector>
+
+#include <cstring>
+
+static const quint32 pageMask = ~quint32(OVERLAYPAGESIZE - 1);
+
+ImageOverlay::ImageOverlay() {
+}
+
+ImageOverlay::ImageOverlay(const MemoryImage &base) :
+    m_base(base) {
+}
+
+void ImageOverlay::setBase(const MemoryImage &base) {
+
+    m_base = base;
+    m_pages.clear();
+}
+
+void ImageOverlay::rebase(const MemoryImage &base) {
+
+    // a byte is changed if it differs from the old base; those bytes are
+    // copied over the new base, the rest of the page follows the new base
+
+    QMap<quint32, QByteArray>::iterator it = m_pages.begin();
+
+    while ( it != m_pages.end() ) {
+
+        const QByteArray oldPage = basePage(m_base, it.key());
+        QByteArray newPage = basePage(base, it.key());
+        const char *page = it.value().constData();
+        bool changed = false;
+
+        for ( ptrdiff_t i=0; i<OVERLAYPAGESIZE; i++ ) {
+
+            if ( page[i] != oldPage[i] ) {
+                newPage[i] = page[i];
+                changed = true;
+            }
+        }
+
+        if ( changed ) {
+            it.value() = newPage;
+            ++it;
+        }
+        else {
+            it = m_pages.erase(it);
+        }
+    }
+
+    m_base = base;
+}
+
+bool ImageOverlay::write(quint32 addr, const char *src, size_t len) {
+
+    if ( !m_base.contains(addr, len) ) {
+        return false;
+    }
+
+    quint64 pos = addr;
+    const quint64 end = pos + len;
+
+    while ( pos < end ) {
+
+        const quint32 pageAddr = quint32(pos) & pageMask;
+        const size_t offset = quint32(pos) - pageAddr;
+        const size_t n = qMin(quint64(OVERLAYPAGESIZE - offset), end - pos);
+
+        QMap<quint32, QByteArray>::iterator it = m_pages.find(pageAddr);
+
+        if ( it == m_pages.end() ) {
+            it = m_pages.insert(pageAddr, basePage(m_base, pageAddr));
+        }
+
+        memcpy(it.value().data() + offset, src, n);
+
+        src += n;
+        pos += n;
+    }
+
+    return true;
+}
+
+bool ImageOverlay::read(quint32 addr, size_t len, char *dst) const {
+
+    if ( !m_base.contains(addr, len) ) {
+        return false;
+    }
+
+    quint64 pos = addr;
+    const quint64 end = pos + len;
+
+    while ( pos < end ) {
+
+        const quint32 pageAddr = quint32(pos) & pageMask;
+        const size_t offset = quint32(pos) - pageAddr;
+        const size_t n = qMin(quint64(OVERLAYPAGESIZE - offset), end - pos);
+
+        QMap<quint32, QByteArray>::const_iterator it = m_pages.constFind(pageAddr);
+
+        if ( it != m_pages.constEnd() ) {
+            memcpy(dst, it.value().constData() + offset, n);
+        }
+        else {
+            memcpy(dst, m_base.constData(quint32(pos), n), n);
+        }
+
+        dst += n;
+        pos += n;
+    }
+
+    return true;
+}
+
+bool ImageOverlay::contains(quint32 addr, size_t len) const {
+    return m_base.contains(addr, len);
+}
+
+void ImageOverlay::revert() {
+    m_pages.clear();
+}
+
+QVector<AddressRange> ImageOverlay::changes() const {
+
+    QVector<AddressRange> ret;
+
+    for ( QMap<quint32, QByteArray>::const_iterator it = m_pages.constBegin(); it != m_pages.constEnd(); ++it ) {
+
+        const QByteArray base = basePage(m_base, it.key());
+        const char *page = it.value().constData();
+
+        for ( ptrdiff_t i=0; i<OVERLAYPAGESIZE; i++ ) {
+
+            if ( page[i] == base[i] ) {
+                continue;
+            }
+
+            const quint32 addr = it.key() + quint32(i);
+
+            if ( !ret.isEmpty() && ret.last().end == addr ) {
+                ret.last().end++;
+            }
+            else {
+                AddressRange range;
+                range.begin = addr;
+                range.end = addr + 1;
+                ret.push_back(range);
+            }
+        }
+    }
+
+    return ret;
+}
+
+MemoryImage ImageOverlay::flatten() const {
+
+    // only the segments with changes are copied
+
+    MemoryImage ret = m_base;
+    const QVector<AddressRange> ranges = changes();
+
+    for ( ptrdiff_t i=0; i<ranges.size(); i++ ) {
+
+        QByteArray bytes(int(ranges[i].end - ranges[i].begin), '\0');
+        read(ranges[i].begin, bytes.size(), bytes.data());
+
+        ret.write(ranges[i].begin, bytes.constData(), bytes.size());
+    }
+
+    return ret;
+}
+
+QByteArray ImageOverlay::basePage(const MemoryImage &image, quint32 pageAddr) const {
+
+    QByteArray page(OVERLAYPAGESIZE, char(0xFF));
+
+    const QMap<quint32, QByteArray> &segments = image.segments();
+    const quint64 pageEnd = quint64(pageAddr) + OVERLAYPAGESIZE;
+
+    QMap<quint32, QByteArray>::const_iterator it = segments.upperBound(pageAddr);
+
+    if ( it != segments.constBegin() ) {
+        --it;
+    }
+
+    for ( ; it != segments.constEnd() && it.key() < pageEnd; ++it ) {
+
+        const quint64 segEnd = quint64(it.key()) + it.value().size();
+        const quint64 from = qMax(quint64(it.key()), quint64(pageAddr));
+        const quint64 to = qMin(segEnd, pageEnd);
+
+        if ( from < to ) {
+            memcpy(page.data() + (from - pageAddr), it.value().constData() + (from - it.key()), to - from);
+        }
+    }
+
+    return page;
+}
@@ -0,0 +1,69 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: imageoverlay.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef IMAGEOVERLAY_HPP
+#define IMAGEOVERLAY_HPP
+
+#include <QByteArray>
+#include <QMap>
+#include <QVector>
+
+#include "memoryimage.hpp"
+#include "imagediff.hpp"
+
+// Copy-on-write layer over a read-only memory image. Only the pages that
+// were written are stored (OVERLAYPAGESIZE bytes each), the base image is
+// shared, so many variants of one image cost little memory. Writes are
+// only accepted for bytes the base image contains.
+
+class ImageOverlay {
+
+public:
+    ImageOverlay();
+    explicit ImageOverlay(const MemoryImage &);
+    void setBase(const MemoryImage &); // drops the changes
+    void rebase(const MemoryImage &);  // keeps the changed bytes on top of a new base
+    bool write(quint32, const char *, size_t);
+    bool read(quint32, size_t, char *) const;
+    bool contains(quint32, size_t) const;
+    void revert();
+
+    QVector<AddressRange> changes() const; // bytes that differ from the base
+    MemoryImage flatten() const;           // base with the changes applied
+
+    const MemoryImage &base() const {
+        return m_base;
+    }
+    bool isModified() const {
+        return !m_pages.isEmpty();
+    }
+    ptrdiff_t pageCount() const {
+        return m_pages.size();
+    }
+
+private:
+    MemoryImage m_base;
+    QMap<quint32, QByteArray> m_pages; // page address -> page bytes
+
+    QByteArray basePage(const MemoryImage &, quint32) const; // fill byte where the image has no data
+
+};
+
+#endif // IMAGEOVERLAY_HPP
@@ -20,298 +20,271 @@
 
 #include "intelhex.hpp"
 #include "ecuscalar.hpp"
+#include "memoryimage.hpp"
+#include "scalarcodec.hpp"
+#include "constants.hpp"
+#include "trace.hpp"
+#include "compressedfile.hpp"
 
 #include <QString>
 #include <QVector>
-#include <QStringList>
 #include <QSharedPointer>
+#include <QByteArray>
+#include <QMap>
 #include <QIODevice>
 #include <QFile>
-#include <QRegExp>
 
-#include <cstdio>
-#include <limits>
+#include <cstring>
 
-IntelHEX::IntelHEX(const QString &path) {
-    m_hexpath = path;
-}
-
-bool IntelHEX::readValues(QVector<QSharedPointer<ECUScalar> > &scalars) {
+static int hexDigit(char c) {
 
-    if ( !readHex() ) {
-        return false;
+    if ( c >= '0' && c <= '9' ) {
+        return c - '0';
     }
-
-    if ( !readScalars(scalars) ) {
-        return false;
+    else if ( c >= 'A' && c <= 'F' ) {
+        return c - 'A' + 10;
     }
-
-    return true;
-}
-
-bool IntelHEX::readHex() {
-
-    QFile hexfile(m_hexpath);
-
-    if ( !hexfile.open(QIODevice::ReadOnly | QIODevice::Text) ) {
-        return false;
+    else if ( c >= 'a' && c <= 'f' ) {
+        return c - 'a' + 10;
     }
 
-    m_hexData.clear();
-    ptrdiff_t n = 0;
-
-    while ( !hexfile.atEnd() ) {
-
-        QString s(hexfile.readLine().simplified());
-
-        if ( s.isEmpty() ) {
-            continue;
-        }
+    return -1;
+}
 
-        s = s.right(s.size()-1);
+static void appendRecord(QByteArray &out, const quint8 *rec, size_t n) {
 
-        m_hexData.push_back(s);
+    static const char digits[] = "0123456789ABCDEF";
+    quint8 cs = 0;
 
-        if ( s.contains("0200000400") && (s.size() == 14) ) {
-            m_hexIndex.insert(s, n);
-        }
+    out.append(':');
 
-        n++;
+    for ( size_t i=0; i<n; i++ ) {
+        out.append(digits[rec[i] >> 4]);
+        out.append(digits[rec[i] & 0x0F]);
+        cs += rec[i];
     }
 
-    hexfile.close();
+    cs = ~cs + 1;
 
-    return true;
+    out.append(digits[cs >> 4]);
+    out.append(digits[cs & 0x0F]);
+    out.append('\n');
 }
 
-void IntelHEX::clear() {
+IntelHEX::IntelHEX(const QString &path) {
+    m_hexpath = path;
+}
 
-    m_hexpath.clear();
-    m_hexData.clear();
-    m_hexIndex.clear();
+void IntelHEX::setLoadControl(LoadControl *control) {
+    m_control = control;
 }
 
-QString IntelHEX::checksum(const QString &str) const {
+bool IntelHEX::readValues(QVector<QSharedPointer<ECUScalar> > &scalars) {
 
-    if ( str.size() < 2 ) {
-        return "";
+    if ( m_image.isEmpty() && !readHex() ) {
+        return false;
     }
 
-    QVector<quint8> v;
-
-    for ( ptrdiff_t i=1; i<str.size(); i+=2 ) {
-        v.push_back(str.mid(i-1, 2).toUInt(0, 16));
+    if ( !readScalars(scalars) ) {
+        return false;
     }
 
-    quint8 cs = 0;
+    return true;
+}
 
-    for ( ptrdiff_t i=0; i<v.size(); i++ ) {
-        cs += v[i];
-    }
+bool IntelHEX::readHex() {
 
-    cs = ~cs + 1;
+    TraceScope trace("hex.read");
 
-    QString ret = QString::number(cs, 16);
+    CompressedFile hexfile(m_hexpath); // plain, gzip or xz
 
-    if ( ret.size() < 2 ) {
-        ret = "0" + ret;
-    }
-    else if ( ret.size() > 2 ) {
-        return "";
+    if ( !hexfile.open(QIODevice::ReadOnly | QIODevice::Text) ) {
+        return false;
     }
 
-    return ret.toUpper();
-}
+    m_image.clear();
 
-bool IntelHEX::readScalars(QVector<QSharedPointer<ECUScalar> > &scalars) const {
+    quint8 rec[HEXMAXRECORDSIZE];
+    quint32 base = 0;
+    ptrdiff_t n = 0;
+    ptrdiff_t records = 0;
 
-    for ( ptrdiff_t n=0; n<scalars.size(); n++ ) {
+    while ( !hexfile.atEnd() ) {
 
-        const QString address = scalars[n]->address();
-        const QString partAddrExt = "0200000400" + address.left(2);
-        const QString addrExt = partAddrExt + checksum(partAddrExt);
-        ptrdiff_t searchInd = 0;
+        if ( m_control && (++n % LOADCHECKINTERVAL) == 0 ) {
 
-        if ( m_hexIndex.contains(addrExt) ) {
-            searchInd = m_hexIndex[addrExt];
-        }
-        else {
-            return false;
-        }
+            m_control->setProgress(hexfile.progressPos(), hexfile.progressSize());
 
-        //
+            if ( m_control->isCanceled() ) {
+                return false;
+            }
+        }
 
-        QVector<quint8> v;
-        const QString nextStr = m_hexData[searchInd+1];
+        const QByteArray line = hexfile.readLine().trimmed();
 
-        for ( ptrdiff_t i=1; i<nextStr.size(); i+=2 ) {
-            v.push_back(nextStr.mid(i-1, 2).toUInt(0, 16));
+        if ( line.isEmpty() ) {
+            continue;
         }
 
-        if ( v.isEmpty() ) {
+        const ptrdiff_t recSize = (line.size() - 1) / 2;
+
+        if ( line[0] != ':' || (line.size() - 1) % 2 != 0 ||
+             recSize < 5 || recSize > HEXMAXRECORDSIZE ) {
             return false;
         }
 
-        const ptrdiff_t hexDataLength = v[0];
+        quint8 cs = 0;
 
-        //
+        for ( ptrdiff_t i=0; i<recSize; i++ ) {
 
-        const quint16 strtAddr(address.toUInt(0, 16) & (0xFFFF - hexDataLength + 1));
-        QString hexStrtAddr = QString::number(strtAddr, 16).toUpper();
+            const int hi = hexDigit(line[1 + 2*i]);
+            const int lo = hexDigit(line[2 + 2*i]);
 
-        ptrdiff_t addsymbnum = 4 - hexStrtAddr.size();
-        if ( hexStrtAddr.size() < 4 ) {
-            for ( ptrdiff_t i=0; i<addsymbnum; i++ ) {
-                hexStrtAddr.insert(0, "0");
+            if ( hi < 0 || lo < 0 ) {
+                return false;
             }
-        }
 
-        const QRegExp regexpStrtAddr(R"(^)" + QString::number(hexDataLength, 16).toUpper() + hexStrtAddr + R"(00.*)");
-        ptrdiff_t beginStrNum = 0;
-
-        for ( ptrdiff_t i=searchInd+1; i<m_hexData.size(); i++ ) {
+            rec[i] = quint8((hi << 4) | lo);
+            cs += rec[i];
+        }
 
-            if ( regexpStrtAddr.exactMatch(m_hexData[i]) ) {
-                beginStrNum = i;
-                break;
-            }
+        if ( cs != 0 || rec[0] + 5 != recSize ) {
+            return false;
         }
 
-        //
+        records++;
 
-        const ptrdiff_t correctStrDataSize = 8 + hexDataLength * 2 + 2;
+        const quint32 offset = (rec[1] << 8) | rec[2];
+        const quint8 type = rec[3];
 
-        if ( m_hexData[beginStrNum].size() != correctStrDataSize ) {
-            return false;
+        if ( type == 0x00 ) { // data
+            m_image.write(base + offset, reinterpret_cast<const char *>(rec + 4), rec[0]);
+        }
+        else if ( type == 0x01 ) { // end of file
+            break;
         }
+        else if ( type == 0x02 && rec[0] == 2 ) { // extended segment address
+            base = quint32((rec[4] << 8) | rec[5]) << 4;
+        }
+        else if ( type == 0x04 && rec[0] == 2 ) { // extended linear address
+            base = quint32((rec[4] << 8) | rec[5]) << 16;
+        }
+    }
 
-        //
+    if ( !hexfile.isOk() ) {
+        return false;
+    }
 
-        const ptrdiff_t firstByteInd = 8 + address.right(1).toUInt(0, 16) * 2;
+    Trace::instance().count("hex.bytes", hexfile.progressSize());
+    Trace::instance().count("hex.records", records);
 
-        //
+    hexfile.close();
 
-        QString tmpStr;
-        const ptrdiff_t maxSize = getLength(scalars[n]->numType()) * 2;
+    return true;
+}
 
-        for ( ptrdiff_t j=firstByteInd; j<(m_hexData[beginStrNum].size()-2); j++ ) {
+void IntelHEX::clear() {
 
-            tmpStr.push_back(m_hexData.at(beginStrNum).at(j));
+    m_hexpath.clear();
+    m_image.clear();
+}
 
-            if ( tmpStr.size() == maxSize ) {
-                writeScalarValue(tmpStr, scalars[n]);
-                break;
-            }
-        }
+MemoryImage IntelHEX::load(const QString &path, bool *ok, LoadControl *control) {
 
-        if ( tmpStr.size() == maxSize ) {
-            continue;
-        }
+    IntelHEX ihex(path);
+    ihex.setLoadControl(control);
 
-        for ( ptrdiff_t i=(beginStrNum+1); i<m_hexData.size(); i++ ) {
+    const bool read = ihex.readHex();
 
-            if ( m_hexData[i].size() != correctStrDataSize ) {
-                continue;
-            }
+    if ( ok ) {
+        *ok = read;
+    }
 
-            for ( ptrdiff_t j=8; j<(correctStrDataSize-2); j++ ) {
+    return read ? ihex.image() : MemoryImage();
+}
 
-                tmpStr.push_back(m_hexData.at(i).at(j));
+bool IntelHEX::writeHex(const QString &path, const MemoryImage &image) {
 
-                if ( tmpStr.size() == maxSize ) {
-                    writeScalarValue(tmpStr, scalars[n]);
-                    break;
-                }
-            }
+    QFile hexfile(path);
 
-            if ( tmpStr.size() == maxSize ) {
-                break;
-            }
-        }
+    if ( !hexfile.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text) ) {
+        return false;
     }
 
-    return true;
-}
-
-void IntelHEX::writeScalarValue(QString &str, QSharedPointer<ECUScalar> &scalar) const {
+    QByteArray out;
+    out.reserve(image.size() * 2 + (image.size() / HEXWRITERECORDLEN + 1) * 16);
 
-    if ( scalar->type() == VARTYPE_SCALAR_NUM ) {
+    quint8 rec[HEXMAXRECORDSIZE];
+    qint64 upper = -1;
 
-        QString numtype = scalar->numType();
-        size_t rawVal = str.toULongLong(0, 16);
-        double preVal = 0;
-        double val = 0;
+    for ( QMap<quint32, QByteArray>::const_iterator it = image.segments().constBegin();
+          it != image.segments().constEnd(); ++it ) {
 
-        if ( numtype == "Ws8" ) {
+        const QByteArray &data = it.value();
+        ptrdiff_t pos = 0;
 
-            ptrdiff_t i = 0;
+        while ( pos < data.size() ) {
 
-            if ( rawVal > CHAR_MAX ) {
-                i = rawVal - UCHAR_MAX - 1;
-            }
-            else {
-                i = rawVal;
-            }
+            const quint32 addr = it.key() + pos;
 
-            preVal = static_cast<double>(i);
-        }
-        else if ( numtype == "Ws16" ) {
+            if ( qint64(addr >> 16) != upper ) {
 
-            ptrdiff_t i = 0;
+                upper = addr >> 16;
 
-            if ( rawVal > SHRT_MAX ) {
-                i = rawVal - USHRT_MAX - 1;
-            }
-            else {
-                i = rawVal;
+                const quint8 ext[] = { 2, 0, 0, 4, quint8(upper >> 8), quint8(upper & 0xFF) };
+                appendRecord(out, ext, sizeof(ext));
             }
 
-            preVal = static_cast<double>(i);
-        }
-        else if ( numtype == "Ws32" ) {
-
-            ptrdiff_t i = 0;
+            ptrdiff_t len = data.size() - pos;
 
-            if ( rawVal > INT_MAX ) {
-                i = rawVal - UINT_MAX - 1;
+            if ( len > HEXWRITERECORDLEN ) {
+                len = HEXWRITERECORDLEN;
             }
-            else {
-                i = rawVal;
+
+            if ( len > 0x10000 - (addr & 0xFFFF) ) { // records must not cross 64K pages
+                len = 0x10000 - (addr & 0xFFFF);
             }
 
-            preVal = static_cast<double>(i);
-        }
-        else if ( numtype == "Wr32" ) {
+            rec[0] = quint8(len);
+            rec[1] = quint8((addr >> 8) & 0xFF);
+            rec[2] = quint8(addr & 0xFF);
+            rec[3] = 0;
+            memcpy(rec + 4, data.constData() + pos, len);
+            appendRecord(out, rec, len + 4);
 
-            float f = 0;
-            sscanf(str.toLatin1().data(), "%x", (int*)&f);
-            preVal = static_cast<double>(f);
-        }
-        else {
-            preVal = static_cast<double>(rawVal);
+            pos += len;
         }
+    }
 
-        const QVector<double> coeff = scalar->coefficients();
-        val = (coeff[5] * preVal - coeff[2]) / (coeff[1] - coeff[4] * preVal);
+    const quint8 eof[] = { 0, 0, 0, 1 };
+    appendRecord(out, eof, sizeof(eof));
 
-        scalar->setValue(QString::number(val, 'f', scalar->precision()));
-    }
-    else if ( scalar->type() == VARTYPE_SCALAR_VTAB ) {
-        scalar->setValue(QString::number(str.toUInt(0, 16)));
-    }
-    else {
-        return;
+    if ( hexfile.write(out) != out.size() ) {
+        return false;
     }
+
+    hexfile.close();
+
+    return true;
 }
 
-size_t IntelHEX::getLength(const QString &type) const {
+bool IntelHEX::readScalars(QVector<QSharedPointer<ECUScalar> > &scalars) const {
 
-    if ( type.size() == 3 ) {
-        return type.right(1).toUInt() / 8;
-    }
-    else if ( type.size() == 4 ) {
-        return type.right(2).toUInt() / 8;
+    TraceScope trace("hex.decode");
+
+    double val = 0;
+
+    for ( ptrdiff_t n=0; n<scalars.size(); n++ ) {
+
+        if ( !ScalarCodec::decode(*scalars[n], m_image, val) ) {
+            return false;
+        }
+
+        scalars[n]->setValue(ScalarCodec::toString(*scalars[n], val));
+        scalars[n]->setPhysValue(val);
     }
 
-    return 0;
+    Trace::instance().count("hex.decoded", scalars.size());
+
+    return true;
 }
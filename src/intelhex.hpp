@@ -24,28 +24,36 @@
 #include <QString>
 #include <QVector>
 #include <QSharedPointer>
-#include <QStringList>
-#include <QHash>
 
 #include "ecuscalar.hpp"
+#include "memoryimage.hpp"
+#include "loadcontrol.hpp"
 
 class IntelHEX {
 
 public:
     IntelHEX(const QString &);
+    void setLoadControl(LoadControl *);
+    bool readHex();
     bool readValues(QVector< QSharedPointer<ECUScalar> > &);
     void clear();
 
+    QString path() const {
+        return m_hexpath;
+    }
+    const MemoryImage &image() const {
+        return m_image;
+    }
+
+    static MemoryImage load(const QString &, bool *ok = 0, LoadControl *control = 0);
+    static bool writeHex(const QString &, const MemoryImage &);
+
 private:
     QString m_hexpath;
-    QStringList m_hexData;
-    QHash<QString, ptrdiff_t> m_hexIndex; // address extension -> m_hexData index
+    MemoryImage m_image;
+    LoadControl *m_control = 0;
 
-    bool readHex();
-    QString checksum(const QString &) const;
     bool readScalars(QVector< QSharedPointer<ECUScalar> > &) const;
-    void writeScalarValue(QString &, QSharedPointer<ECUScalar> &) const;
-    size_t getLength(const QString &) const;
 
 };
 
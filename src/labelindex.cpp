@@ -0,0 +1,356 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: labelindex.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "labelindex.hpp"
+#include "constants.hpp"
+#include "trace.hpp"
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QRegExp>
+#include <QSharedPointer>
+
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+typedef QHash< quint64, QVector<quint32> > TrigramHash;
+
+static quint64 trigramKey(const QChar *p) {
+    return (quint64(p[0].unicode()) << 32) | (quint64(p[1].unicode()) << 16) | quint64(p[2].unicode());
+}
+
+static void addTrigrams(TrigramHash &hash, const QString &str, quint32 ind) {
+
+    const QString padded = " " + str + " ";
+
+    for ( ptrdiff_t i=0; i+3<=padded.size(); i++ ) {
+
+        QVector<quint32> &postings = hash[trigramKey(padded.constData() + i)];
+
+        if ( postings.isEmpty() || postings.last() != ind ) {
+            postings.push_back(ind);
+        }
+    }
+}
+
+static QVector<quint64> queryTrigrams(const QString &str) {
+
+    QVector<quint64> ret;
+
+    for ( ptrdiff_t i=0; i+3<=str.size(); i++ ) {
+        ret.push_back(trigramKey(str.constData() + i));
+    }
+
+    std::sort(ret.begin(), ret.end());
+    ret.erase(std::unique(ret.begin(), ret.end()), ret.end());
+
+    return ret;
+}
+
+static bool postingsShorter(const QVector<quint32> *p1, const QVector<quint32> *p2) {
+    return p1->size() < p2->size();
+}
+
+// Indexes containing all trigrams, rarest posting list first.
+
+static QVector<quint32> intersectPostings(const TrigramHash &hash, const QVector<quint64> &grams) {
+
+    QVector<const QVector<quint32> *> lists;
+
+    for ( ptrdiff_t i=0; i<grams.size(); i++ ) {
+
+        TrigramHash::const_iterator it = hash.constFind(grams[i]);
+
+        if ( it == hash.constEnd() ) {
+            return QVector<quint32>();
+        }
+
+        lists.push_back(&it.value());
+    }
+
+    if ( lists.isEmpty() ) {
+        return QVector<quint32>();
+    }
+
+    std::sort(lists.begin(), lists.end(), postingsShorter);
+
+    QVector<quint32> ret = *lists[0];
+    QVector<quint32> tmp;
+
+    for ( ptrdiff_t i=1; i<lists.size() && !ret.isEmpty(); i++ ) {
+
+        tmp.clear();
+        std::set_intersection(ret.constBegin(), ret.constEnd(),
+                              lists[i]->constBegin(), lists[i]->constEnd(),
+                              std::back_inserter(tmp));
+        ret.swap(tmp);
+    }
+
+    return ret;
+}
+
+LabelIndex::LabelIndex() {
+}
+
+void LabelIndex::build(const QVector< QSharedPointer<ECUScalar> > &scalars) {
+
+    TraceScope trace("index.build");
+
+    clear();
+
+    m_names.resize(scalars.size());
+    m_descrs.resize(scalars.size());
+    m_sorted.resize(scalars.size());
+
+    for ( ptrdiff_t i=0; i<scalars.size(); i++ ) {
+
+        m_names[i] = scalars[i]->name().toLower();
+        m_descrs[i] = scalars[i]->shortDescription().toLower();
+        m_sorted[i] = i;
+
+        addTrigrams(m_nameTrigrams, m_names[i], i);
+        addTrigrams(m_descrTrigrams, m_descrs[i], i);
+    }
+
+    const QVector<QString> &names = m_names;
+
+    std::sort(m_sorted.begin(), m_sorted.end(),
+              [&names](ptrdiff_t a, ptrdiff_t b) { return names[a] < names[b]; });
+}
+
+void LabelIndex::clear() {
+
+    m_names.clear();
+    m_descrs.clear();
+    m_sorted.clear();
+    m_nameTrigrams.clear();
+    m_descrTrigrams.clear();
+    m_lastQuery.clear();
+    m_lastResult.clear();
+}
+
+QVector<ptrdiff_t> LabelIndex::search(const QString &templ) {
+
+    const QString query = templ.toLower();
+    const ptrdiff_t mode = queryMode(query);
+
+    if ( mode != SEARCH_SUBSTRING ) {
+
+        m_lastQuery.clear();
+        m_lastResult.clear();
+
+        if ( mode == SEARCH_WILDCARD ) {
+            return searchWildcard(query);
+        }
+        else if ( mode == SEARCH_ADDRESS ) {
+            return QVector<ptrdiff_t>();
+        }
+
+        return searchFuzzy(query.mid(1));
+    }
+
+    QVector<ptrdiff_t> ret;
+
+    if ( query.isEmpty() ) {
+
+        ret.resize(m_names.size());
+
+        for ( ptrdiff_t i=0; i<ret.size(); i++ ) {
+            ret[i] = i;
+        }
+    }
+    else if ( !m_lastQuery.isEmpty() && query.contains(m_lastQuery) ) { // user keeps typing
+
+        for ( ptrdiff_t i=0; i<m_lastResult.size(); i++ ) {
+
+            if ( matchesSubstring(m_lastResult[i], query) ) {
+                ret.push_back(m_lastResult[i]);
+            }
+        }
+    }
+    else {
+        ret = searchSubstring(query);
+    }
+
+    m_lastQuery = query;
+    m_lastResult = ret;
+
+    return ret;
+}
+
+ptrdiff_t LabelIndex::firstPrefixMatch(const QString &templ) const {
+
+    const QString prefix = templ.toLower();
+
+    if ( prefix.isEmpty() || queryMode(prefix) != SEARCH_SUBSTRING ) {
+        return -1;
+    }
+
+    const QVector<QString> &names = m_names;
+
+    QVector<ptrdiff_t>::const_iterator it =
+            std::lower_bound(m_sorted.constBegin(), m_sorted.constEnd(), prefix,
+                             [&names](ptrdiff_t a, const QString &str) { return names[a] < str; });
+
+    if ( it == m_sorted.constEnd() || !m_names[*it].startsWith(prefix) ) {
+        return -1;
+    }
+
+    return *it;
+}
+
+ptrdiff_t LabelIndex::queryMode(const QString &templ) {
+
+    if ( templ.startsWith('~') ) {
+        return SEARCH_FUZZY;
+    }
+    else if ( QRegExp("0x[0-9a-f]{1,8}", Qt::CaseInsensitive).exactMatch(templ) ) {
+        return SEARCH_ADDRESS;
+    }
+    else if ( templ.contains('*') || templ.contains('?') ) {
+        return SEARCH_WILDCARD;
+    }
+
+    return SEARCH_SUBSTRING;
+}
+
+QVector<ptrdiff_t> LabelIndex::searchSubstring(const QString &query) const {
+
+    QVector<ptrdiff_t> ret;
+
+    if ( query.size() < 3 ) { // too short for trigrams
+
+        for ( ptrdiff_t i=0; i<m_names.size(); i++ ) {
+
+            if ( matchesSubstring(i, query) ) {
+                ret.push_back(i);
+            }
+        }
+
+        return ret;
+    }
+
+    const QVector<quint64> grams = queryTrigrams(query);
+    const QVector<quint32> nameCand = intersectPostings(m_nameTrigrams, grams);
+    const QVector<quint32> descrCand = intersectPostings(m_descrTrigrams, grams);
+
+    QVector<quint32> cand;
+    std::set_union(nameCand.constBegin(), nameCand.constEnd(),
+                   descrCand.constBegin(), descrCand.constEnd(),
+                   std::back_inserter(cand));
+
+    for ( ptrdiff_t i=0; i<cand.size(); i++ ) {
+
+        if ( matchesSubstring(cand[i], query) ) {
+            ret.push_back(cand[i]);
+        }
+    }
+
+    return ret;
+}
+
+QVector<ptrdiff_t> LabelIndex::searchWildcard(const QString &templ) const {
+
+    QRegExp regexp(templ + "*", Qt::CaseSensitive, QRegExp::Wildcard); // anchored at the name start
+    QVector<ptrdiff_t> ret;
+
+    // literal fragments narrow the candidates
+
+    const QStringList fragments = templ.split(QRegExp("[*?]"), SKIPEMPTYPARTS);
+    QVector<quint64> grams;
+
+    for ( ptrdiff_t i=0; i<fragments.size(); i++ ) {
+        grams += queryTrigrams(fragments[i]);
+    }
+
+    if ( grams.isEmpty() ) {
+
+        for ( ptrdiff_t i=0; i<m_names.size(); i++ ) {
+
+            if ( regexp.exactMatch(m_names[i]) ) {
+                ret.push_back(i);
+            }
+        }
+
+        return ret;
+    }
+
+    std::sort(grams.begin(), grams.end());
+    grams.erase(std::unique(grams.begin(), grams.end()), grams.end());
+
+    const QVector<quint32> cand = intersectPostings(m_nameTrigrams, grams);
+
+    for ( ptrdiff_t i=0; i<cand.size(); i++ ) {
+
+        if ( regexp.exactMatch(m_names[cand[i]]) ) {
+            ret.push_back(cand[i]);
+        }
+    }
+
+    return ret;
+}
+
+QVector<ptrdiff_t> LabelIndex::searchFuzzy(const QString &query) const {
+
+    QVector<ptrdiff_t> ret;
+
+    if ( query.isEmpty() ) {
+        return ret;
+    }
+
+    const QVector<quint64> grams = queryTrigrams(" " + query + " ");
+    QVector<ptrdiff_t> scores(m_names.size(), 0);
+
+    for ( ptrdiff_t i=0; i<grams.size(); i++ ) {
+
+        TrigramHash::const_iterator it = m_nameTrigrams.constFind(grams[i]);
+
+        if ( it == m_nameTrigrams.constEnd() ) {
+            continue;
+        }
+
+        const QVector<quint32> &postings = it.value();
+
+        for ( ptrdiff_t j=0; j<postings.size(); j++ ) {
+            scores[postings[j]]++;
+        }
+    }
+
+    const ptrdiff_t threshold = ptrdiff_t(std::ceil(FUZZYMINSIMILARITY * grams.size()));
+
+    for ( ptrdiff_t i=0; i<scores.size(); i++ ) {
+
+        if ( scores[i] >= threshold ) {
+            ret.push_back(i);
+        }
+    }
+
+    std::stable_sort(ret.begin(), ret.end(),
+                     [&scores](ptrdiff_t a, ptrdiff_t b) { return scores[a] > scores[b]; });
+
+    return ret;
+}
+
+bool LabelIndex::matchesSubstring(ptrdiff_t ind, const QString &query) const {
+    return m_names[ind].contains(query) || m_descrs[ind].contains(query);
+}
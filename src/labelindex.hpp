@@ -0,0 +1,71 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: labelindex.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LABELINDEX_HPP
+#define LABELINDEX_HPP
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QSharedPointer>
+
+#include "ecuscalar.hpp"
+
+// Search index over label names and descriptions: sorted names for prefix
+// lookups and trigram posting lists for substring, wildcard and fuzzy queries.
+//
+// Query syntax: "text" - substring of name or description,
+// "te*t?" - wildcard on name, "~text" - fuzzy match on name,
+// "0x1f2c" - address, answered by AddressIndex instead.
+
+class LabelIndex {
+
+public:
+    LabelIndex();
+    void build(const QVector< QSharedPointer<ECUScalar> > &);
+    void clear();
+
+    QVector<ptrdiff_t> search(const QString &);     // matching scalar indexes
+    ptrdiff_t firstPrefixMatch(const QString &) const; // -1 if nothing found
+
+    static ptrdiff_t queryMode(const QString &);
+
+    ptrdiff_t size() const {
+        return m_names.size();
+    }
+
+private:
+    QVector<QString> m_names;  // lower case
+    QVector<QString> m_descrs; // lower case
+    QVector<ptrdiff_t> m_sorted; // indexes sorted by name
+    QHash< quint64, QVector<quint32> > m_nameTrigrams;
+    QHash< quint64, QVector<quint32> > m_descrTrigrams;
+
+    QString m_lastQuery; // incremental narrowing of substring queries
+    QVector<ptrdiff_t> m_lastResult;
+
+    QVector<ptrdiff_t> searchSubstring(const QString &) const;
+    QVector<ptrdiff_t> searchWildcard(const QString &) const;
+    QVector<ptrdiff_t> searchFuzzy(const QString &) const;
+    bool matchesSubstring(ptrdiff_t, const QString &) const;
+
+};
+
+#endif // LABELINDEX_HPP
@@ -0,0 +1,70 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: labelsfiltermodel.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "labelsfiltermodel.hpp"
+
+LabelsFilterModel::LabelsFilterModel(QObject *parent) :
+    QSortFilterProxyModel(parent) {
+
+    setDynamicSortFilter(false);
+}
+
+void LabelsFilterModel::setMatches(const QVector<ptrdiff_t> &matches, bool ranked) {
+
+    m_rank = QVector<ptrdiff_t>(sourceModel()->rowCount(), -1);
+
+    for ( ptrdiff_t i=0; i<matches.size(); i++ ) {
+        m_rank[matches[i]] = i;
+    }
+
+    m_filtered = true;
+    invalidateFilter();
+
+    sort(ranked ? 0 : -1);
+}
+
+void LabelsFilterModel::clearMatches() {
+
+    m_rank.clear();
+    m_filtered = false;
+    invalidateFilter();
+
+    sort(-1);
+}
+
+bool LabelsFilterModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const {
+
+    Q_UNUSED(sourceParent);
+
+    if ( !m_filtered ) {
+        return true;
+    }
+
+    return sourceRow < m_rank.size() && m_rank[sourceRow] >= 0;
+}
+
+bool LabelsFilterModel::lessThan(const QModelIndex &left, const QModelIndex &right) const {
+
+    if ( !m_filtered ) {
+        return left.row() < right.row();
+    }
+
+    return m_rank[left.row()] < m_rank[right.row()];
+}
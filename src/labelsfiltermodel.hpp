@@ -0,0 +1,49 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: labelsfiltermodel.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LABELSFILTERMODEL_HPP
+#define LABELSFILTERMODEL_HPP
+
+#include <QSortFilterProxyModel>
+#include <QVector>
+
+// Shows only the labels found by LabelIndex, in source order or ranked
+// by the order of the search result.
+
+class LabelsFilterModel : public QSortFilterProxyModel {
+
+    Q_OBJECT
+
+public:
+    explicit LabelsFilterModel(QObject *parent = 0);
+    void setMatches(const QVector<ptrdiff_t> &, bool);
+    void clearMatches();
+
+protected:
+    bool filterAcceptsRow(int, const QModelIndex &) const;
+    bool lessThan(const QModelIndex &, const QModelIndex &) const;
+
+private:
+    QVector<ptrdiff_t> m_rank; // source row -> position in result, -1 if filtered out
+    bool m_filtered = false;
+
+};
+
+#endif // LABELSFILTERMODEL_HPP
@@ -0,0 +1,111 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: labelsmodel.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "labelsmodel.hpp"
+
+#include <QColor>
+
+LabelsModel::LabelsModel(QObject *parent) :
+    QAbstractTableModel(parent) {
+}
+
+void LabelsModel::setScalars(const QVector< QSharedPointer<ECUScalar> > &scalars) {
+
+    beginResetModel();
+    m_scalars = scalars;
+    m_inTable = QVector<bool>(scalars.size(), false);
+    endResetModel();
+}
+
+void LabelsModel::clear() {
+
+    beginResetModel();
+    m_scalars.clear();
+    m_inTable.clear();
+    endResetModel();
+}
+
+void LabelsModel::setInTable(ptrdiff_t ind, bool inTable) {
+
+    if ( m_inTable[ind] == inTable ) {
+        return;
+    }
+
+    m_inTable[ind] = inTable;
+
+    const QModelIndex changed = index(ind, 0);
+    emit dataChanged(changed, changed);
+}
+
+void LabelsModel::setInTable(const QVector<ptrdiff_t> &inds, bool inTable) {
+
+    ptrdiff_t first = m_inTable.size();
+    ptrdiff_t last = -1;
+
+    for ( ptrdiff_t n=0; n<inds.size(); n++ ) {
+
+        if ( m_inTable[inds[n]] != inTable ) {
+            m_inTable[inds[n]] = inTable;
+            first = qMin(first, inds[n]);
+            last = qMax(last, inds[n]);
+        }
+    }
+
+    if ( last >= 0 ) {
+        emit dataChanged(index(first, 0), index(last, 0));
+    }
+}
+
+int LabelsModel::rowCount(const QModelIndex &parent) const {
+
+    if ( parent.isValid() ) {
+        return 0;
+    }
+
+    return m_scalars.size();
+}
+
+int LabelsModel::columnCount(const QModelIndex &parent) const {
+
+    if ( parent.isValid() ) {
+        return 0;
+    }
+
+    return 1;
+}
+
+QVariant LabelsModel::data(const QModelIndex &index, int role) const {
+
+    if ( !index.isValid() || index.row() >= m_scalars.size() ) {
+        return QVariant();
+    }
+
+    if ( role == Qt::DisplayRole ) {
+        return m_scalars[index.row()]->name();
+    }
+    else if ( role == Qt::ToolTipRole ) {
+        return m_scalars[index.row()]->shortDescription();
+    }
+    else if ( role == Qt::ForegroundRole && m_inTable[index.row()] ) {
+        return QColor(Qt::red);
+    }
+
+    return QVariant();
+}
@@ -0,0 +1,56 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: labelsmodel.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LABELSMODEL_HPP
+#define LABELSMODEL_HPP
+
+#include <QAbstractTableModel>
+#include <QVector>
+#include <QSharedPointer>
+#include <QVariant>
+
+#include "ecuscalar.hpp"
+
+class LabelsModel : public QAbstractTableModel {
+
+    Q_OBJECT
+
+public:
+    explicit LabelsModel(QObject *parent = 0);
+    void setScalars(const QVector< QSharedPointer<ECUScalar> > &);
+    void clear();
+    void setInTable(ptrdiff_t, bool);
+    void setInTable(const QVector<ptrdiff_t> &, bool);
+
+    bool isInTable(ptrdiff_t ind) const {
+        return m_inTable[ind];
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &, int role = Qt::DisplayRole) const;
+
+private:
+    QVector< QSharedPointer<ECUScalar> > m_scalars;
+    QVector<bool> m_inTable; // label is shown in the values table
+
+};
+
+#endif // LABELSMODEL_HPP
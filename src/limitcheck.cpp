@@ -0,0 +1,175 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: limitcheck.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "limitcheck.hpp"
+#include "constants.hpp"
+#include "trace.hpp"
+
+#include <QString>
+#include <QVector>
+#include <QSharedPointer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static bool violationLessThan(const LimitViolation &v1, const LimitViolation &v2) {
+
+    if ( v1.severity != v2.severity ) {
+        return v1.severity > v2.severity;
+    }
+
+    return v1.excess > v2.excess;
+}
+
+LimitCheck::LimitCheck(const QVector< QSharedPointer<ECUScalar> > &scalars) :
+    m_scalars(scalars),
+    m_minSoft(scalars.size()),
+    m_maxSoft(scalars.size()),
+    m_minHard(scalars.size()),
+    m_maxHard(scalars.size()) {
+
+    const double inf = std::numeric_limits<double>::infinity();
+
+    for ( ptrdiff_t i=0; i<scalars.size(); i++ ) {
+
+        if ( scalars[i]->type() != VARTYPE_SCALAR_NUM ) { // vtab limits are raw indexes
+            m_minSoft[i] = m_minHard[i] = -inf;
+            m_maxSoft[i] = m_maxHard[i] = inf;
+            continue;
+        }
+
+        m_minSoft[i] = scalars[i]->minValueSoft();
+        m_maxSoft[i] = scalars[i]->maxValueSoft();
+        m_minHard[i] = scalars[i]->minValueHard();
+        m_maxHard[i] = scalars[i]->maxValueHard();
+
+        if ( m_minHard[i] == 0 && m_maxHard[i] == 0 ) { // no EXTENDED_LIMITS
+            m_minHard[i] = -inf;
+            m_maxHard[i] = inf;
+        }
+    }
+}
+
+QVector<LimitViolation> LimitCheck::check(const QVector<double> &values) const {
+
+    TraceScope trace("limits");
+
+    const ptrdiff_t n = (values.size() < m_minSoft.size()) ? values.size() : m_minSoft.size();
+    QVector<quint8> flags(n);
+
+    const double *v = values.constData();
+    const double *minSoft = m_minSoft.constData();
+    const double *maxSoft = m_maxSoft.constData();
+    const double *minHard = m_minHard.constData();
+    const double *maxHard = m_maxHard.constData();
+    quint8 *f = flags.data();
+
+    // NaN (value not read) compares false and never violates
+
+    for ( ptrdiff_t i=0; i<n; i++ ) {
+        f[i] = quint8((v[i] < minSoft[i]) | (v[i] > maxSoft[i])) |
+               quint8(((v[i] < minHard[i]) | (v[i] > maxHard[i])) << 1);
+    }
+
+    //
+
+    QVector<LimitViolation> ret;
+
+    for ( ptrdiff_t i=0; i<n; i++ ) {
+
+        if ( f[i] == 0 ) {
+            continue;
+        }
+
+        const bool hard = f[i] & 2;
+        const double lo = hard ? minHard[i] : minSoft[i];
+        const double hi = hard ? maxHard[i] : maxSoft[i];
+        const double range = (std::isfinite(hi - lo) && hi > lo) ? (hi - lo) : 1.0;
+
+        LimitViolation viol;
+        viol.index = i;
+        viol.severity = hard ? LIMIT_HARD : LIMIT_SOFT;
+        viol.value = v[i];
+        viol.excess = ((v[i] < lo) ? (lo - v[i]) : (v[i] - hi)) / range;
+
+        ret.push_back(viol);
+    }
+
+    std::sort(ret.begin(), ret.end(), violationLessThan);
+
+    return ret;
+}
+
+QVector<LimitViolation> LimitCheck::check() const {
+
+    QVector<double> values(m_scalars.size());
+
+    for ( ptrdiff_t i=0; i<m_scalars.size(); i++ ) {
+        values[i] = m_scalars[i]->physValue();
+    }
+
+    return check(values);
+}
+
+bool LimitCheck::writeReport(const QString &path, const QVector<LimitViolation> &violations) const {
+
+    QFile file(path);
+
+    if ( !file.open(QIODevice::WriteOnly | QIODevice::Truncate) ) {
+        return false;
+    }
+
+    QJsonArray arr;
+    ptrdiff_t hardNum = 0;
+
+    for ( ptrdiff_t i=0; i<violations.size(); i++ ) {
+
+        const QSharedPointer<ECUScalar> &scal = m_scalars[violations[i].index];
+        const bool hard = violations[i].severity == LIMIT_HARD;
+
+        QJsonObject obj;
+        obj.insert("name", scal->name());
+        obj.insert("severity", hard ? QString("hard") : QString("soft"));
+        obj.insert("value", violations[i].value);
+        obj.insert("min", hard ? scal->minValueHard() : scal->minValueSoft());
+        obj.insert("max", hard ? scal->maxValueHard() : scal->maxValueSoft());
+        obj.insert("dimension", scal->dimension());
+        arr.append(obj);
+
+        if ( hard ) {
+            hardNum++;
+        }
+    }
+
+    QJsonObject root;
+    root.insert("checked", m_scalars.size());
+    root.insert("hard", double(hardNum));
+    root.insert("soft", double(violations.size() - hardNum));
+    root.insert("violations", arr);
+
+    const QByteArray json = QJsonDocument(root).toJson();
+
+    return file.write(json) == json.size();
+}
@@ -0,0 +1,57 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: limitcheck.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LIMITCHECK_HPP
+#define LIMITCHECK_HPP
+
+#include <QString>
+#include <QVector>
+#include <QSharedPointer>
+
+#include "ecuscalar.hpp"
+
+struct LimitViolation {
+    ptrdiff_t index;    // index in the scalars vector
+    ptrdiff_t severity; // LIMIT_SOFT or LIMIT_HARD
+    double value;
+    double excess;      // distance beyond the limit relative to the allowed range
+};
+
+// Checks physical values against soft and hard limits. The limits are
+// copied once into flat arrays so the check itself is a branch-free loop.
+
+class LimitCheck {
+
+public:
+    LimitCheck(const QVector< QSharedPointer<ECUScalar> > &);
+    QVector<LimitViolation> check(const QVector<double> &) const;
+    QVector<LimitViolation> check() const; // uses physValue() of the scalars
+    bool writeReport(const QString &, const QVector<LimitViolation> &) const;
+
+private:
+    QVector< QSharedPointer<ECUScalar> > m_scalars;
+    QVector<double> m_minSoft;
+    QVector<double> m_maxSoft;
+    QVector<double> m_minHard;
+    QVector<double> m_maxHard;
+
+};
+
+#endif // LIMITCHECK_HPP
@@ -0,0 +1,122 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: liveacquisition.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "liveacquisition.hpp"
+#include "xcpclient.hpp"
+#include "constants.hpp"
+
+#include <QElapsedTimer>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <cmath>
+
+LiveAcquisition::LiveAcquisition(QObject *parent) :
+    QObject(parent),
+    m_stop(0),
+    m_cycles(0) {
+
+    m_pool.setMaxThreadCount(1);
+
+    connect(&m_watcher, SIGNAL(finished()), this, SIGNAL(finished()));
+}
+
+LiveAcquisition::~LiveAcquisition() {
+
+    stop();
+    m_watcher.waitForFinished();
+}
+
+bool LiveAcquisition::start(const QString &host, quint16 port,
+                            const QVector< QSharedPointer<ECUScalar> > &sigs,
+                            quint16 event, quint8 prescaler) {
+
+    if ( isRunning() ) {
+        return false;
+    }
+
+    m_host = host;
+    m_port = port;
+    m_signals = sigs;
+    m_event = event;
+    m_prescaler = prescaler;
+    m_error.clear();
+
+    m_rings.clear();
+
+    for ( ptrdiff_t i=0; i<sigs.size(); i++ ) {
+        m_rings.push_back(QSharedPointer<SampleRing>(new SampleRing(LIVERINGSIZE)));
+    }
+
+    m_stop.storeRelease(0);
+    m_cycles.storeRelease(0);
+
+    m_watcher.setFuture(QtConcurrent::run(&m_pool, this, &LiveAcquisition::acquire));
+
+    return true;
+}
+
+void LiveAcquisition::stop() {
+    m_stop.storeRelease(1);
+}
+
+bool LiveAcquisition::acquire() {
+
+    XcpClient client;
+
+    if ( !client.connectToSlave(m_host, m_port)
+         || !client.configureDaq(m_signals, m_event, m_prescaler)
+         || !client.startDaq() ) {
+
+        m_error = client.errorString();
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<double> values;
+    bool ok = true;
+
+    while ( m_stop.loadAcquire() == 0 ) {
+
+        if ( !client.readCycle(values, XCPTIMEOUT) ) {
+            m_error = client.errorString();
+            ok = false;
+            break;
+        }
+
+        Sample sample;
+        sample.time = timer.elapsed();
+
+        for ( ptrdiff_t i=0; i<values.size(); i++ ) {
+
+            if ( !std::isnan(values[i]) ) {
+                sample.value = values[i];
+                m_rings[i]->push(sample); // a full ring drops, it never blocks
+            }
+        }
+
+        m_cycles.fetchAndAddRelease(1);
+    }
+
+    client.disconnectFromSlave();
+
+    return ok;
+}
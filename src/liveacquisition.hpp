@@ -0,0 +1,88 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: liveacquisition.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LIVEACQUISITION_HPP
+#define LIVEACQUISITION_HPP
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QSharedPointer>
+#include <QFutureWatcher>
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <QAtomicInteger>
+
+#include "ecuscalar.hpp"
+#include "samplering.hpp"
+
+// Runs an XcpClient on its own thread and hands the values over to the
+// GUI thread through one SampleRing per signal. The GUI drains the rings
+// on a timer; the acquisition never waits for it.
+
+class LiveAcquisition : public QObject {
+
+    Q_OBJECT
+
+public:
+    explicit LiveAcquisition(QObject *parent = 0);
+    ~LiveAcquisition();
+    bool start(const QString &, quint16, const QVector< QSharedPointer<ECUScalar> > &,
+               quint16, quint8); // host, port, signals, event channel, prescaler
+
+    bool isRunning() const {
+        return m_watcher.isRunning();
+    }
+    const QVector< QSharedPointer<SampleRing> > &rings() const {
+        return m_rings;
+    }
+    qint64 cycles() const {
+        return m_cycles.loadAcquire();
+    }
+    QString errorString() const { // valid after finished()
+        return m_error;
+    }
+
+public slots:
+    void stop();
+
+signals:
+    void finished();
+
+private:
+    QString m_host;
+    quint16 m_port = 0;
+    QVector< QSharedPointer<ECUScalar> > m_signals;
+    quint16 m_event = 0;
+    quint8 m_prescaler = 1;
+
+    QVector< QSharedPointer<SampleRing> > m_rings;
+    QAtomicInt m_stop;
+    QAtomicInteger<qint64> m_cycles;
+    QString m_error;
+
+    QThreadPool m_pool; // keeps the long running loop off the global pool
+    QFutureWatcher<bool> m_watcher;
+
+    bool acquire();
+
+};
+
+#endif // LIVEACQUISITION_HPP
@@ -0,0 +1,257 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: livemeasurementdialog.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "livemeasurementdialog.hpp"
+#include "ui_livemeasurementdialog.h"
+#include "a2lcache.hpp"
+#include "constants.hpp"
+
+#include <QListWidgetItem>
+#include <QMessageBox>
+#include <QStringList>
+#include <QtConcurrent/QtConcurrentRun>
+
+LiveMeasurementDialog::LiveMeasurementDialog(QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::LiveMeasurementDialog) {
+
+    ui->setupUi(this);
+
+    ui->spinBox_Port->setValue(XCPDEFAULTPORT);
+    ui->widget_Plot->setWindow(ui->spinBox_Window->value() * 1000);
+
+    m_drained.reserve(LIVERINGSIZE);
+    m_refreshTimer.setInterval(LIVEPLOTREFRESH);
+
+    connect(&m_refreshTimer, SIGNAL(timeout()), this, SLOT(drainRings()));
+    connect(&m_acquisition, SIGNAL(finished()), this, SLOT(acquisitionFinished()));
+    connect(&m_loadWatcher, SIGNAL(finished()), this, SLOT(measurementsLoaded()));
+}
+
+LiveMeasurementDialog::~LiveMeasurementDialog() {
+
+    m_loadControl.cancel();
+    m_loadWatcher.waitForFinished();
+
+    delete ui;
+}
+
+bool LiveMeasurementDialog::setA2L(const QString &path) {
+
+    if ( isRunning() ) {
+        return false;
+    }
+
+    m_requestedPath = path;
+
+    if ( m_loadWatcher.isRunning() ) { // measurementsLoaded() picks up the request
+        return true;
+    }
+
+    if ( path != m_a2lPath ) {
+        startLoading();
+    }
+
+    return true;
+}
+
+void LiveMeasurementDialog::hideEvent(QHideEvent *event) {
+
+    m_acquisition.stop();
+
+    QDialog::hideEvent(event);
+}
+
+void LiveMeasurementDialog::on_pushButton_Start_clicked() {
+
+    QVector<ptrdiff_t> recorded;
+    QVector< QSharedPointer<ECUScalar> > sigs;
+    QStringList names;
+
+    for ( ptrdiff_t i=0; i<ui->listWidget_Signals->count(); i++ ) {
+
+        if ( ui->listWidget_Signals->item(i)->checkState() == Qt::Checked ) {
+            recorded.push_back(i);
+            sigs.push_back(m_measurements[i]);
+            names.push_back(m_measurements[i]->name() + " " + m_measurements[i]->dimension());
+        }
+    }
+
+    if ( recorded.isEmpty() ) {
+        QMessageBox::warning(this, QString(PROGNAME) + ": warning", "Check the measurements to record!");
+        return;
+    }
+
+    // the histories have a fixed size, recording for hours does not grow them
+
+    m_recorded = recorded;
+    m_histories = QVector<SignalHistory>(recorded.size());
+    ui->widget_Plot->setHistories(&m_histories, names);
+
+    if ( !m_acquisition.start(ui->lineEdit_Host->text(), quint16(ui->spinBox_Port->value()), sigs,
+                              quint16(ui->spinBox_Event->value()), quint8(ui->spinBox_Prescaler->value())) ) {
+        return;
+    }
+
+    m_clock.start();
+    m_refreshTimer.start();
+
+    ui->pushButton_Start->setEnabled(false);
+    ui->pushButton_Stop->setEnabled(true);
+    ui->lineEdit_Host->setEnabled(false);
+    ui->spinBox_Port->setEnabled(false);
+    ui->spinBox_Event->setEnabled(false);
+    ui->spinBox_Prescaler->setEnabled(false);
+
+    on_listWidget_Signals_itemSelectionChanged();
+    updateStatus();
+}
+
+void LiveMeasurementDialog::on_pushButton_Stop_clicked() {
+
+    m_acquisition.stop();
+}
+
+void LiveMeasurementDialog::on_listWidget_Signals_itemSelectionChanged() {
+
+    QVector<ptrdiff_t> shown;
+
+    for ( ptrdiff_t n=0; n<m_recorded.size(); n++ ) {
+
+        if ( ui->listWidget_Signals->item(m_recorded[n])->isSelected() ) {
+            shown.push_back(n);
+        }
+    }
+
+    ui->widget_Plot->setShown(shown);
+}
+
+void LiveMeasurementDialog::on_spinBox_Window_valueChanged(int val) {
+
+    ui->widget_Plot->setWindow(qint64(val) * 1000);
+}
+
+void LiveMeasurementDialog::drainRings() {
+
+    const QVector< QSharedPointer<SampleRing> > &rings = m_acquisition.rings();
+
+    for ( ptrdiff_t n=0; n<rings.size() && n<m_histories.size(); n++ ) {
+
+        m_drained.clear();
+        rings[n]->pop(m_drained);
+
+        for ( ptrdiff_t i=0; i<m_drained.size(); i++ ) {
+            m_histories[n].append(m_drained[i]);
+        }
+    }
+
+    ui->widget_Plot->setNow(m_clock.elapsed());
+    updateStatus();
+}
+
+void LiveMeasurementDialog::acquisitionFinished() {
+
+    m_refreshTimer.stop();
+    drainRings();
+
+    ui->pushButton_Start->setEnabled(true);
+    ui->pushButton_Stop->setEnabled(false);
+    ui->lineEdit_Host->setEnabled(true);
+    ui->spinBox_Port->setEnabled(true);
+    ui->spinBox_Event->setEnabled(true);
+    ui->spinBox_Prescaler->setEnabled(true);
+
+    if ( !m_acquisition.errorString().isEmpty() ) {
+        ui->label_Status->setText(ui->label_Status->text() + "; " + m_acquisition.errorString());
+    }
+}
+
+void LiveMeasurementDialog::updateStatus() {
+
+    qint64 dropped = 0;
+
+    for ( ptrdiff_t n=0; n<m_acquisition.rings().size(); n++ ) {
+        dropped += m_acquisition.rings()[n]->dropped();
+    }
+
+    ui->label_Status->setText(QString::number(m_recorded.size()) + " signals, "
+                              + QString::number(m_acquisition.cycles()) + " cycles, "
+                              + QString::number(dropped) + " samples dropped");
+}
+
+void LiveMeasurementDialog::startLoading() {
+
+    m_loadingPath = m_requestedPath;
+
+    m_a2lPath.clear();
+    m_measurements.clear();
+    m_recorded.clear();
+    m_histories.clear();
+    ui->widget_Plot->setHistories(0, QStringList());
+    ui->listWidget_Signals->clear();
+
+    ui->pushButton_Start->setEnabled(false);
+    ui->label_Status->setText("Loading measurements...");
+
+    m_loadControl.reset();
+    m_loadWatcher.setFuture(QtConcurrent::run(this, &LiveMeasurementDialog::loadMeasurements));
+}
+
+bool LiveMeasurementDialog::loadMeasurements() {
+
+    bool ok = false;
+    m_loadedMeasurements = A2LCache::instance().measurements(m_loadingPath, &ok, &m_loadControl);
+
+    return ok;
+}
+
+void LiveMeasurementDialog::measurementsLoaded() {
+
+    if ( m_requestedPath != m_loadingPath ) { // another project asked meanwhile
+        startLoading();
+        return;
+    }
+
+    if ( !m_loadWatcher.result() ) {
+
+        ui->label_Status->setText("Can not read measurements from " + m_loadingPath);
+
+        QMessageBox::critical(this, QString(PROGNAME) + ": error",
+                              "Can not read measurements from " + m_loadingPath + "!");
+        return;
+    }
+
+    m_a2lPath = m_loadingPath;
+    m_measurements = m_loadedMeasurements;
+    m_loadedMeasurements.clear();
+
+    for ( ptrdiff_t i=0; i<m_measurements.size(); i++ ) {
+
+        QListWidgetItem *item = new QListWidgetItem(m_measurements[i]->name());
+        item->setFlags(item->flags() | Qt::ItemIsUserCheckable);
+        item->setCheckState(Qt::Unchecked);
+        item->setToolTip(m_measurements[i]->shortDescription());
+
+        ui->listWidget_Signals->addItem(item);
+    }
+
+    ui->pushButton_Start->setEnabled(true);
+    ui->label_Status->setText(QString::number(m_measurements.size()) + " measurements");
+}
@@ -0,0 +1,95 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: livemeasurementdialog.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LIVEMEASUREMENTDIALOG_HPP
+#define LIVEMEASUREMENTDIALOG_HPP
+
+#include <QDialog>
+#include <QString>
+#include <QVector>
+#include <QSharedPointer>
+#include <QTimer>
+#include <QElapsedTimer>
+#include <QFutureWatcher>
+
+#include "ecuscalar.hpp"
+#include "samplering.hpp"
+#include "signalhistory.hpp"
+#include "liveacquisition.hpp"
+#include "loadcontrol.hpp"
+
+namespace Ui {
+class LiveMeasurementDialog;
+}
+
+// Records the checked a2l measurements over XCP and plots the selected
+// ones while the values arrive. The measurements are taken from A2LCache
+// on the thread pool; for an open project that is a cache hit.
+
+class LiveMeasurementDialog : public QDialog {
+
+    Q_OBJECT
+
+public:
+    explicit LiveMeasurementDialog(QWidget *parent = 0);
+    ~LiveMeasurementDialog();
+    bool setA2L(const QString &); // starts loading the measurements; false while recording
+
+    bool isRunning() const {
+        return m_acquisition.isRunning();
+    }
+
+protected:
+    void hideEvent(QHideEvent *);
+
+private slots:
+    void on_pushButton_Start_clicked();
+    void on_pushButton_Stop_clicked();
+    void on_listWidget_Signals_itemSelectionChanged();
+    void on_spinBox_Window_valueChanged(int);
+    void drainRings();
+    void acquisitionFinished();
+    void measurementsLoaded();
+
+private:
+    Ui::LiveMeasurementDialog *ui;
+
+    QString m_a2lPath;
+    QString m_requestedPath;
+    QString m_loadingPath;
+    QVector< QSharedPointer<ECUScalar> > m_loadedMeasurements;
+    QFutureWatcher<bool> m_loadWatcher;
+    LoadControl m_loadControl;
+    QVector< QSharedPointer<ECUScalar> > m_measurements;
+    QVector<ptrdiff_t> m_recorded; // measurement indexes
+    QVector<SignalHistory> m_histories; // one per recorded measurement
+    QVector<Sample> m_drained;
+
+    LiveAcquisition m_acquisition;
+    QTimer m_refreshTimer;
+    QElapsedTimer m_clock;
+
+    void updateStatus();
+    void startLoading();
+    bool loadMeasurements(); // runs on the thread pool
+
+};
+
+#endif // LIVEMEASUREMENTDIALOG_HPP
@@ -0,0 +1,217 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: liveplotwidget.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "liveplotwidget.hpp"
+
+#include <QPainter>
+#include <QPaintEvent>
+#include <QColor>
+#include <QFontMetrics>
+
+#include <cmath>
+#include <limits>
+
+static const QColor seriesColors[] = {
+    QColor(31, 119, 180),
+    QColor(214, 39, 40),
+    QColor(44, 160, 44),
+    QColor(255, 127, 14),
+    QColor(148, 103, 189),
+    QColor(140, 86, 75),
+    QColor(227, 119, 194),
+    QColor(23, 190, 207)
+};
+
+LivePlotWidget::LivePlotWidget(QWidget *parent) :
+    QWidget(parent) {
+
+    setMinimumSize(200, 150);
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+void LivePlotWidget::setHistories(const QVector<SignalHistory> *histories, const QStringList &names) {
+
+    m_histories = histories;
+    m_names = names;
+    m_shown.clear();
+    update();
+}
+
+void LivePlotWidget::setShown(const QVector<ptrdiff_t> &shown) {
+
+    m_shown = shown;
+    update();
+}
+
+void LivePlotWidget::setWindow(qint64 window) {
+
+    m_window = window;
+    update();
+}
+
+void LivePlotWidget::setNow(qint64 now) {
+
+    m_now = now;
+    update();
+}
+
+void LivePlotWidget::paintEvent(QPaintEvent *) {
+
+    QPainter painter(this);
+    painter.fillRect(rect(), Qt::white);
+
+    const QFontMetrics fm(font());
+    const QRect plot = rect().adjusted(fm.width("-0.000e+00") + 8, fm.height() + 4, -8, -fm.height() - 8);
+
+    painter.setPen(Qt::gray);
+    painter.drawRect(plot);
+
+    if ( !m_histories || m_shown.isEmpty() || plot.width() <= 1 || plot.height() <= 1 ) {
+        return;
+    }
+
+    // time range
+
+    const qint64 end = m_now + 1;
+    qint64 begin = end - m_window;
+
+    if ( m_window <= 0 ) {
+
+        begin = end - 1;
+
+        for ( ptrdiff_t n=0; n<m_shown.size(); n++ ) {
+
+            const SignalHistory &history = m_histories->at(m_shown[n]);
+
+            if ( !history.isEmpty() && history.firstTime() < begin ) {
+                begin = history.firstTime();
+            }
+        }
+    }
+
+    // one min/max pair per column and signal
+
+    const ptrdiff_t columns = plot.width();
+
+    QVector< QVector<double> > mins(m_shown.size());
+    QVector< QVector<double> > maxs(m_shown.size());
+
+    double low = std::numeric_limits<double>::max();
+    double high = -std::numeric_limits<double>::max();
+
+    for ( ptrdiff_t n=0; n<m_shown.size(); n++ ) {
+
+        m_histories->at(m_shown[n]).decimate(begin, end, columns, mins[n], maxs[n]);
+
+        for ( ptrdiff_t c=0; c<columns; c++ ) {
+
+            if ( mins[n][c] < low ) {
+                low = mins[n][c];
+            }
+            if ( maxs[n][c] > high ) {
+                high = maxs[n][c];
+            }
+        }
+    }
+
+    if ( low > high ) { // nothing to draw yet
+        return;
+    }
+
+    if ( high - low < std::abs(high) * 1e-9 + 1e-12 ) {
+        low -= 1;
+        high += 1;
+    }
+
+    const double pad = (high - low) * 0.05;
+    low -= pad;
+    high += pad;
+
+    //
+
+    painter.setPen(Qt::darkGray);
+    painter.drawText(QRect(0, plot.top() - fm.height() / 2, plot.left() - 4, fm.height()),
+                     Qt::AlignRight | Qt::AlignVCenter, QString::number(high, 'g', 5));
+    painter.drawText(QRect(0, plot.bottom() - fm.height() / 2, plot.left() - 4, fm.height()),
+                     Qt::AlignRight | Qt::AlignVCenter, QString::number(low, 'g', 5));
+    painter.drawText(QRect(plot.left(), plot.bottom() + 4, plot.width(), fm.height()),
+                     Qt::AlignLeft, QString::number(begin / 1000.0, 'f', 1) + " s");
+    painter.drawText(QRect(plot.left(), plot.bottom() + 4, plot.width(), fm.height()),
+                     Qt::AlignRight, QString::number(end / 1000.0, 'f', 1) + " s");
+
+    const double yScale = plot.height() / (high - low);
+    const ptrdiff_t colorsNum = sizeof(seriesColors) / sizeof(seriesColors[0]);
+
+    painter.setClipRect(plot.adjusted(1, 1, 0, 0));
+
+    for ( ptrdiff_t n=0; n<m_shown.size(); n++ ) {
+
+        painter.setPen(seriesColors[n % colorsNum]);
+
+        double prevMin = std::numeric_limits<double>::quiet_NaN();
+        double prevMax = prevMin;
+
+        for ( ptrdiff_t c=0; c<columns; c++ ) {
+
+            double lo = mins[n][c];
+            double hi = maxs[n][c];
+
+            if ( std::isnan(lo) ) {
+                continue;
+            }
+
+            // touch the previous column so the trace stays connected
+
+            if ( !std::isnan(prevMin) ) {
+
+                if ( prevMax < lo ) {
+                    lo = prevMax;
+                }
+                if ( prevMin > hi ) {
+                    hi = prevMin;
+                }
+            }
+
+            const int x = plot.left() + int(c);
+            painter.drawLine(x, plot.bottom() - int((lo - low) * yScale),
+                             x, plot.bottom() - int((hi - low) * yScale));
+
+            prevMin = mins[n][c];
+            prevMax = maxs[n][c];
+        }
+    }
+
+    painter.setClipping(false);
+
+    // legend
+
+    int x = plot.left();
+
+    for ( ptrdiff_t n=0; n<m_shown.size(); n++ ) {
+
+        const SignalHistory &history = m_histories->at(m_shown[n]);
+        const QString text = m_names.value(m_shown[n]) + " = " + QString::number(history.lastValue(), 'g', 6);
+
+        painter.setPen(seriesColors[n % colorsNum]);
+        painter.drawText(x, fm.ascent() + 2, text);
+
+        x += fm.width(text) + 16;
+    }
+}
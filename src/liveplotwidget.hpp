@@ -0,0 +1,57 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: liveplotwidget.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LIVEPLOTWIDGET_HPP
+#define LIVEPLOTWIDGET_HPP
+
+#include <QWidget>
+#include <QVector>
+#include <QStringList>
+
+#include "signalhistory.hpp"
+
+// Plot of live signals. Every pixel column is drawn as the min/max of the
+// samples it covers, so the cost depends on the width, not on how much
+// has been recorded.
+
+class LivePlotWidget : public QWidget {
+
+    Q_OBJECT
+
+public:
+    explicit LivePlotWidget(QWidget *parent = 0);
+    void setHistories(const QVector<SignalHistory> *, const QStringList &); // histories, names
+    void setShown(const QVector<ptrdiff_t> &);
+    void setWindow(qint64); // ms, 0 for the whole recording
+    void setNow(qint64);    // ms, right edge of the plot
+
+protected:
+    void paintEvent(QPaintEvent *);
+
+private:
+    const QVector<SignalHistory> *m_histories = 0;
+    QStringList m_names;
+    QVector<ptrdiff_t> m_shown;
+    qint64 m_window = 0;
+    qint64 m_now = 0;
+
+};
+
+#endif // LIVEPLOTWIDGET_HPP
@@ -0,0 +1,50 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: loadcontrol.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "loadcontrol.hpp"
+
+LoadControl::LoadControl() :
+    m_canceled(0),
+    m_bytesDone(0),
+    m_bytesTotal(0),
+    m_objects(0) {
+}
+
+void LoadControl::reset() {
+
+    m_canceled.store(0);
+    m_bytesDone.store(0);
+    m_bytesTotal.store(0);
+    m_objects.store(0);
+}
+
+void LoadControl::cancel() {
+    m_canceled.store(1);
+}
+
+void LoadControl::setProgress(qint64 done, qint64 total) {
+
+    m_bytesDone.store(done);
+    m_bytesTotal.store(total);
+}
+
+void LoadControl::setObjects(qint64 objects) {
+    m_objects.store(objects);
+}
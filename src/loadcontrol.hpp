@@ -0,0 +1,60 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: loadcontrol.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef LOADCONTROL_HPP
+#define LOADCONTROL_HPP
+
+#include <QAtomicInt>
+#include <QAtomicInteger>
+
+// Shared between a loading thread and the GUI: the loader publishes its
+// progress, the GUI polls it and may request cancellation.
+
+class LoadControl {
+
+public:
+    LoadControl();
+    void reset();
+    void cancel();
+    void setProgress(qint64, qint64); // bytes done, bytes total
+    void setObjects(qint64);
+
+    bool isCanceled() const {
+        return m_canceled.load() != 0;
+    }
+    qint64 bytesDone() const {
+        return m_bytesDone.load();
+    }
+    qint64 bytesTotal() const {
+        return m_bytesTotal.load();
+    }
+    qint64 objects() const {
+        return m_objects.load();
+    }
+
+private:
+    QAtomicInt m_canceled;
+    QAtomicInteger<qint64> m_bytesDone;
+    QAtomicInteger<qint64> m_bytesTotal;
+    QAtomicInteger<qint64> m_objects;
+
+};
+
+#endif // LOADCONTROL_HPP
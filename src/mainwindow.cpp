@@ -21,62 +21,74 @@
 #include "mainwindow.hpp"
 #include "ui_mainwindow.h"
 #include "constants.hpp"
-#include "a2l.hpp"
 #include "ecuscalar.hpp"
 #include "intelhex.hpp"
+#include "imagediff.hpp"
+#include "fleetcompare.hpp"
+#include "limitcheck.hpp"
+#include "valueexport.hpp"
+#include "dcmimport.hpp"
+#include "projectwidget.hpp"
 #include "labelinfodialog.hpp"
+#include "checksum.hpp"
 
 #include <QMessageBox>
+#include <QInputDialog>
+#include <QLineEdit>
 #include <QFileDialog>
 #include <QFileInfo>
 #include <QString>
 #include <QVector>
+#include <QVariantMap>
 #include <QSharedPointer>
-#include <QColor>
-#include <QComboBox>
-#include <QItemDelegate>
 #include <QTableWidget>
-#include <QTableWidgetSelectionRange>
 #include <QTime>
 #include <QDateTime>
-#include <QThread>
 #include <QtConcurrent/QtConcurrentRun>
 
-A2L *globA2L = 0;
-IntelHEX *globIHEX = 0;
-QVector< QSharedPointer<ECUScalar> > *globScalars = 0;
+// "CRC_32:begin-end:target[:fill]" lines; the first bad line goes to bad
 
-void parseA2L() {
+static bool parseChecksums(const QStringList &lines, QVector<Checksum> &checksums, QString &bad) {
 
-    if ( !globA2L->readFile() ) {
-        QMessageBox::critical(0, QString(PROGNAME) + ": error", "Error occured during a2l file parsing!");
-        globA2L->clear();
-        return;
-    }
+    checksums.clear();
 
-    globA2L->fillScalarsInfo(*globScalars);
-    globA2L->clear();
-}
+    for ( ptrdiff_t i=0; i<lines.size(); i++ ) {
 
-void readHEX() {
+        Checksum checksum;
 
-    if ( !globIHEX->readValues(*globScalars) ) {
-        QMessageBox::critical(0, QString(PROGNAME) + ": error", "Error occured during hex file reading!");
+        if ( !checksum.fromString(lines[i]) ) {
+            bad = lines[i];
+            return false;
+        }
+
+        checksums.push_back(checksum);
     }
 
-    globIHEX->clear();
+    return true;
 }
 
 MainWindow::MainWindow(QWidget *parent) :
     QMainWindow(parent),
     ui(new Ui::MainWindow),
     m_labelInfoDialog(new LabelInfoDialog(this)),
+    m_traceDialog(new TraceDialog(this)),
+    m_liveDialog(new LiveMeasurementDialog(this)),
     m_progSettings("pa23software", PROGNAME) {
 
     ui->setupUi(this);
 
     //
 
+    connect(ui->tabWidget_Projects, SIGNAL(tabCloseRequested(int)), this, SLOT(closeProject(int)));
+    connect(ui->tabWidget_Projects, SIGNAL(currentChanged(int)), this, SLOT(updateProjectState()));
+    connect(&m_compareWatcher, SIGNAL(finished()), this, SLOT(compareHexFinished()));
+    connect(&m_fleetWatcher, SIGNAL(finished()), this, SLOT(fleetCompareFinished()));
+    connect(&m_fleetProgressTimer, SIGNAL(timeout()), this, SLOT(fleetCompareProgress()));
+
+    m_fleetProgressTimer.setInterval(100);
+
+    //
+
     QCoreApplication::setApplicationName(QString(PROGNAME));
     QCoreApplication::setApplicationVersion(QString(PROGVER));
 
@@ -85,14 +97,15 @@ MainWindow::MainWindow(QWidget *parent) :
     //
 
     readProgramSettings();
-
-    //
-
-    connect(ui->lineEdit_QuickSearch, SIGNAL(textChanged(QString)), this, SLOT(searchTemplChanged(QString)));
+    updateProjectState();
 }
 
 MainWindow::~MainWindow() {
 
+    m_compareWatcher.waitForFinished();
+    m_fleetControl.cancel();
+    m_fleetWatcher.waitForFinished();
+
     writeProgramSettings();
 
     delete ui;
@@ -105,7 +118,7 @@ void MainWindow::on_action_OpenProject_triggered() {
                     this,
                     tr("Open a2l file..."),
                     m_lastA2LPath,
-                    QString::fromLatin1("a2l files (*.a2l);;All files (*)"),
+                    QString::fromLatin1("a2l files (*.a2l *.a2l.gz *.a2l.xz);;All files (*)"),
                     0, 0)
                 );
 
@@ -121,7 +134,7 @@ void MainWindow::on_action_OpenProject_triggered() {
                     this,
                     tr("Open hex file..."),
                     m_lastHEXPath,
-                    QString::fromLatin1("hex files (*.hex);;All files (*)"),
+                    QString::fromLatin1("hex files (*.hex *.hex.gz *.hex.xz);;All files (*)"),
                     0, 0)
                 );
 
@@ -134,141 +147,579 @@ void MainWindow::on_action_OpenProject_triggered() {
 
     //
 
-    ui->lineEdit_QuickSearch->clear();
-    ui->tableWidget_Labels->setRowCount(0);
-    ui->tableWidget_Scalars->setRowCount(0);
-    m_scalars.clear();
-    ui->groupBox_Labels->setTitle("Labels");
+    openProject(a2lFileName, hexFileName);
+}
+
+void MainWindow::on_action_OpenA2L_triggered() {
+
+    const QString a2lFileName(
+                QFileDialog::getOpenFileName(
+                    this,
+                    tr("Open a2l file..."),
+                    m_lastA2LPath,
+                    QString::fromLatin1("a2l files (*.a2l *.a2l.gz *.a2l.xz);;All files (*)"),
+                    0, 0)
+                );
+
+    if ( a2lFileName.isEmpty() ) {
+        return;
+    }
+
+    const QFileInfo a2lFileInfo(a2lFileName);
+    m_lastA2LPath = a2lFileInfo.absolutePath();
+
+    //
+
+    openProject(a2lFileName, QString());
+}
+
+void MainWindow::on_action_CloseProject_triggered() {
+    closeProject(ui->tabWidget_Projects->currentIndex());
+}
+
+void MainWindow::on_action_CompareHex_triggered() {
+
+    ProjectWidget *project = currentProject();
+
+    if ( !project || project->image().isEmpty() ) {
+        QMessageBox::information(this, QString(PROGNAME), "Open a project with a hex file first.");
+        return;
+    }
+
+    const QString hexFileName(
+                QFileDialog::getOpenFileName(
+                    this,
+                    tr("Open hex file to compare..."),
+                    m_lastHEXPath,
+                    QString::fromLatin1("hex files (*.hex *.hex.gz *.hex.xz);;All files (*)"),
+                    0, 0)
+                );
+
+    if ( hexFileName.isEmpty() ) {
+        return;
+    }
+
+    const QFileInfo hexFileInfo(hexFileName);
+    m_lastHEXPath = hexFileInfo.absolutePath();
+
+    //
 
     blockGUI();
-    QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+    ui->statusBar->showMessage("Reading " + hexFileName + ". Please wait...");
+
+    m_compareTimer.start();
+    m_compareProject = project;
+    m_compareHex = QSharedPointer<IntelHEX>(new IntelHEX(hexFileName));
+    m_compareWatcher.setFuture(QtConcurrent::run(m_compareHex.data(), &IntelHEX::readHex));
+}
+
+void MainWindow::compareHexFinished() {
+
+    ProjectWidget *project = m_compareProject;
+    const QString hexFileName = m_compareHex->path();
+
+    if ( !m_compareWatcher.result() ) {
+        QMessageBox::critical(this, QString(PROGNAME) + ": error", "Error occured during hex file reading!");
+    }
+    else if ( project ) {
+
+        const QVector<ScalarChange> changes =
+                ImageDiff::changedScalars(project->variantImage(), m_compareHex->image(), project->scalars(),
+                                          project->addressIndex());
+        project->showDifferences(changes);
+
+        ui->plainTextEdit_log->appendPlainText(
+                    QDateTime::currentDateTime().toString("[yyyy-MM-dd_hh-mm-ss]")
+                    + " Comparing " + project->currentVariant() + " with " + hexFileName + ": "
+                    + QString::number(changes.size()) + " labels changed, "
+                    + QString::number(m_compareTimer.elapsed()) + " ms"
+                    );
+    }
+
+    m_compareHex.clear();
+    m_compareProject = 0;
 
     //
 
-    QTime timer;
+    ui->statusBar->clearMessage();
+    unblockGUI();
+}
 
-    timer.start();
-    readA2LInfo(a2lFileName);
-    ui->plainTextEdit_log->appendPlainText(
-                QDateTime::currentDateTime().toString("[yyyy-MM-dd_hh-mm-ss]")
-                + " Parsing " + a2lFileName + ": "
-                + QString::number(timer.elapsed()) + " ms"
+void MainWindow::on_action_CompareFleet_triggered() {
+
+    ProjectWidget *project = currentProject();
+
+    if ( !project || project->image().isEmpty() ) {
+        QMessageBox::information(this, QString(PROGNAME), "Open a project with a reference hex file first.");
+        return;
+    }
+
+    const QStringList hexFileNames(
+                QFileDialog::getOpenFileNames(
+                    this,
+                    tr("Open hex files to compare..."),
+                    m_lastHEXPath,
+                    QString::fromLatin1("hex files (*.hex *.hex.gz *.hex.xz);;All files (*)"),
+                    0, 0)
                 );
 
-    timer.restart();
-    readHEXData(hexFileName);
-    ui->plainTextEdit_log->appendPlainText(
-                QDateTime::currentDateTime().toString("[yyyy-MM-dd_hh-mm-ss]")
-                + " Reading " + hexFileName + ": "
-                + QString::number(timer.elapsed()) + " ms"
+    if ( hexFileNames.isEmpty() ) {
+        return;
+    }
+
+    const QFileInfo hexFileInfo(hexFileNames.first());
+    m_lastHEXPath = hexFileInfo.absolutePath();
+
+    const QString csvFileName(
+                QFileDialog::getSaveFileName(
+                    this,
+                    tr("Save comparison matrix..."),
+                    m_lastHEXPath + "/fleet.csv",
+                    QString::fromLatin1("csv files (*.csv);;All files (*)"),
+                    0, 0)
                 );
 
-    timer.restart();
-    showLabels();
+    if ( csvFileName.isEmpty() ) {
+        return;
+    }
+
+    //
+
+    blockGUI();
+    ui->statusBar->showMessage("Comparing hex files. It may take a long time. Please wait...");
+
+    m_fleetTimer.start();
+    m_fleetCsvPath = csvFileName;
+    m_fleet = QSharedPointer<FleetCompare>(new FleetCompare(project->scalars(), project->image()));
+    m_fleet->setLoadControl(&m_fleetControl);
+    m_fleetControl.reset();
+
+    m_fleetProgress = new QProgressDialog("Comparing " + QString::number(hexFileNames.size()) + " hex files...",
+                                          "Cancel", 0, 100, this);
+    m_fleetProgress->setWindowTitle(QString(PROGNAME));
+    m_fleetProgress->setWindowModality(Qt::WindowModal);
+    m_fleetProgress->setMinimumDuration(500);
+    m_fleetProgress->setAutoClose(false);
+    m_fleetProgress->setAutoReset(false);
+    m_fleetProgress->setValue(0);
+
+    connect(m_fleetProgress, SIGNAL(canceled()), this, SLOT(fleetCompareProgress()));
+
+    m_fleetWatcher.setFuture(QtConcurrent::run(m_fleet.data(), &FleetCompare::run, hexFileNames));
+    m_fleetProgressTimer.start();
+}
+
+void MainWindow::fleetCompareProgress() {
+
+    if ( !m_fleetProgress ) {
+        return;
+    }
+
+    if ( m_fleetProgress->wasCanceled() ) {
+        m_fleetControl.cancel();
+        m_fleetProgress->setLabelText("Canceling...");
+        return;
+    }
+
+    const qint64 total = m_fleetControl.bytesTotal();
+
+    if ( total > 0 ) {
+        m_fleetProgress->setValue(int(100 * m_fleetControl.bytesDone() / total));
+    }
+
+    ui->statusBar->showMessage("Comparing hex files: " + QString::number(m_fleetControl.objects()) + " done");
+}
+
+void MainWindow::fleetCompareFinished() {
+
+    m_fleetProgressTimer.stop();
+    m_fleetProgress->deleteLater();
+    m_fleetProgress = 0;
+
+    const QSharedPointer<FleetCompare> fleet = m_fleet;
+    m_fleet.clear();
+
+    if ( !m_fleetWatcher.result() ) {
+
+        ui->plainTextEdit_log->appendPlainText(
+                    QDateTime::currentDateTime().toString("[yyyy-MM-dd_hh-mm-ss]")
+                    + " Comparing hex files canceled"
+                    );
+
+        ui->statusBar->clearMessage();
+        unblockGUI();
+
+        return;
+    }
+
+    ptrdiff_t failed = 0;
+    ptrdiff_t deviating = 0;
+
+    for ( ptrdiff_t n=0; n<fleet->entries().size(); n++ ) {
+
+        if ( !fleet->entries()[n].ok ) {
+            ui->plainTextEdit_log->appendPlainText("    Error occured during reading of " + fleet->entries()[n].path);
+            failed++;
+        }
+        else if ( fleet->entries()[n].deviations > 0 ) {
+            deviating++;
+        }
+    }
+
     ui->plainTextEdit_log->appendPlainText(
                 QDateTime::currentDateTime().toString("[yyyy-MM-dd_hh-mm-ss]")
-                + " Displaying labels: "
-                + QString::number(timer.elapsed()) + " ms"
+                + " Comparing " + QString::number(fleet->entries().size()) + " hex files: "
+                + QString::number(deviating) + " deviate from reference, "
+                + QString::number(failed) + " unreadable, "
+                + QString::number(m_fleetTimer.elapsed()) + " ms"
                 );
 
-    ui->groupBox_Labels->setTitle("Labels (" + QString::number(m_scalars.size()) + ")");
+    // most frequently deviating labels
+
+    const QVector<ptrdiff_t> order = fleet->mostDeviating(10);
+
+    for ( ptrdiff_t i=0; i<order.size(); i++ ) {
+        ui->plainTextEdit_log->appendPlainText(
+                    "    " + fleet->scalars()[order[i]]->name() + ": "
+                    + QString::number(fleet->deviatingFiles()[order[i]]) + " files"
+                    );
+    }
+
+    if ( !fleet->writeMatrix(m_fleetCsvPath) ) {
+        QMessageBox::critical(this, QString(PROGNAME) + ": error", "Can not write " + m_fleetCsvPath + "!");
+    }
+
+    //
 
+    ui->statusBar->clearMessage();
     unblockGUI();
 }
 
-void MainWindow::on_action_OpenA2L_triggered() {
+void MainWindow::on_action_SaveLimitReport_triggered() {
 
-    const QString a2lFileName(
-                QFileDialog::getOpenFileName(
+    ProjectWidget *project = currentProject();
+
+    if ( !project || project->image().isEmpty() ) {
+        QMessageBox::information(this, QString(PROGNAME), "Open a project with a hex file first.");
+        return;
+    }
+
+    const QString reportFileName(
+                QFileDialog::getSaveFileName(
                     this,
-                    tr("Open a2l file..."),
-                    m_lastA2LPath,
-                    QString::fromLatin1("a2l files (*.a2l);;All files (*)"),
+                    tr("Save limits report..."),
+                    m_lastHEXPath + "/limits.json",
+                    QString::fromLatin1("json files (*.json);;All files (*)"),
                     0, 0)
                 );
 
-    if ( a2lFileName.isEmpty() ) {
+    if ( reportFileName.isEmpty() ) {
         return;
     }
 
-    const QFileInfo a2lFileInfo(a2lFileName);
-    m_lastA2LPath = a2lFileInfo.absolutePath();
+    const LimitCheck limitCheck(project->scalars());
 
-    //
+    if ( !limitCheck.writeReport(reportFileName, project->violations()) ) {
+        QMessageBox::critical(this, QString(PROGNAME) + ": error", "Can not write " + reportFileName + "!");
+    }
+}
 
-    ui->lineEdit_QuickSearch->clear();
-    ui->tableWidget_Labels->setRowCount(0);
-    ui->tableWidget_Scalars->setRowCount(0);
-    m_scalars.clear();
-    ui->groupBox_Labels->setTitle("Labels");
+void MainWindow::on_action_ExportValues_triggered() {
 
-    blockGUI();
-    QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+    ProjectWidget *project = currentProject();
+
+    if ( !project || project->image().isEmpty() ) {
+        QMessageBox::information(this, QString(PROGNAME), "Open a project with a hex file first.");
+        return;
+    }
+
+    QString filter;
+
+    const QString exportFileName(
+                QFileDialog::getSaveFileName(
+                    this,
+                    tr("Export values..."),
+                    m_lastHEXPath + "/" + QFileInfo(project->hexPath()).completeBaseName() + ".csv",
+                    QString::fromLatin1("csv files (*.csv);;json lines files (*.jsonl);;binary files (*.dcv);;dcm files (*.dcm);;cdfx files (*.cdfx)"),
+                    &filter, 0)
+                );
+
+    if ( exportFileName.isEmpty() ) {
+        return;
+    }
+
+    ptrdiff_t format = ValueExport::formatByName(QFileInfo(exportFileName).suffix());
+
+    if ( format < 0 ) {
+        format = filter.startsWith("json") ? EXPORT_JSONL :
+                 filter.startsWith("binary") ? EXPORT_BINARY :
+                 filter.startsWith("dcm") ? EXPORT_DCM :
+                 filter.startsWith("cdfx") ? EXPORT_CDFX : EXPORT_CSV;
+    }
 
     //
 
     QTime timer;
-
     timer.start();
-    readA2LInfo(a2lFileName);
+
+    ValueExport exporter(project->scalars());
+    exporter.setDatasetName(QFileInfo(project->hexPath()).completeBaseName());
+
+    if ( !exporter.write(exportFileName, format) ) {
+        QMessageBox::critical(this, QString(PROGNAME) + ": error", "Can not write " + exportFileName + "!");
+        return;
+    }
+
     ui->plainTextEdit_log->appendPlainText(
                 QDateTime::currentDateTime().toString("[yyyy-MM-dd_hh-mm-ss]")
-                + " Parsing " + a2lFileName + ": "
+                + " Exporting " + QString::number(project->scalars().size()) + " values to "
+                + exportFileName + ": "
                 + QString::number(timer.elapsed()) + " ms"
                 );
+}
+
+void MainWindow::on_action_ImportDCM_triggered() {
+
+    ProjectWidget *project = currentProject();
+
+    if ( !project || project->variants().isEmpty() ) {
+        QMessageBox::information(this, QString(PROGNAME), "Open a project with a hex file first.");
+        return;
+    }
+
+    const QString dcmFileName(
+                QFileDialog::getOpenFileName(
+                    this,
+                    tr("Import dcm file..."),
+                    m_lastHEXPath,
+                    QString::fromLatin1("dcm files (*.dcm);;All files (*)"),
+                    0, 0)
+                );
+
+    if ( dcmFileName.isEmpty() ) {
+        return;
+    }
+
+    QTime timer;
+    timer.start();
+
+    DcmImport dcm(project->scalars());
+
+    if ( !dcm.read(dcmFileName) ) {
+        QMessageBox::critical(this, QString(PROGNAME) + ": error",
+                              "Can not read " + dcmFileName + ": " + dcm.errorString());
+        return;
+    }
+
+    QStringList failed;
+    const ptrdiff_t written = project->applyDcm(dcm, failed);
 
-    timer.restart();
-    showLabels();
     ui->plainTextEdit_log->appendPlainText(
                 QDateTime::currentDateTime().toString("[yyyy-MM-dd_hh-mm-ss]")
-                + " Displaying labels: "
+                + " Importing " + dcmFileName + " into " + project->currentVariant() + ": "
+                + QString::number(written) + " values applied, "
                 + QString::number(timer.elapsed()) + " ms"
                 );
 
-    ui->groupBox_Labels->setTitle("Labels (" + QString::number(m_scalars.size()) + ")");
+    if ( !dcm.unknownLabels().isEmpty() ) {
+        ui->plainTextEdit_log->appendPlainText(
+                    "Unknown labels: " + dcm.unknownLabels().join(", "));
+    }
 
-    unblockGUI();
+    if ( !dcm.skippedLabels().isEmpty() ) {
+        ui->plainTextEdit_log->appendPlainText(
+                    "Skipped (not a single value): " + dcm.skippedLabels().join(", "));
+    }
+
+    if ( !failed.isEmpty() ) {
+        ui->plainTextEdit_log->appendPlainText(
+                    "Not applied (read-only or no data in the image): " + failed.join(", "));
+    }
 }
 
-void MainWindow::on_action_SearchLine_triggered() {
+void MainWindow::on_action_NewVariant_triggered() {
+
+    ProjectWidget *project = currentProject();
 
-    ui->lineEdit_QuickSearch->setFocus();
-    ui->lineEdit_QuickSearch->selectAll();
+    if ( !project || project->variants().isEmpty() ) {
+        return;
+    }
+
+    bool ok = false;
+
+    const QString name =
+            QInputDialog::getText(
+                this,
+                QString(PROGNAME),
+                "Name of the new variant (a copy of " + project->currentVariant() + "):",
+                QLineEdit::Normal,
+                project->currentVariant() + " 2",
+                &ok).trimmed();
+
+    if ( !ok || name.isEmpty() ) {
+        return;
+    }
+
+    if ( project->variants().contains(name) ) {
+        QMessageBox::information(this, QString(PROGNAME), "Variant " + name + " already exists.");
+        return;
+    }
+
+    project->addVariant(name);
 }
 
-void MainWindow::on_action_Select_triggered() {
+void MainWindow::on_action_RemoveVariant_triggered() {
+
+    ProjectWidget *project = currentProject();
+
+    if ( !project ) {
+        return;
+    }
+
+    if ( project->isModified() &&
+         QMessageBox::question(this, QString(PROGNAME),
+                               "Discard the changes of " + project->currentVariant() + "?",
+                               QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes ) {
+        return;
+    }
+
+    project->removeVariant();
+}
+
+void MainWindow::on_action_SaveChangesInHex_triggered() {
+
+    ProjectWidget *project = currentProject();
+
+    if ( !project || !project->isModified() ) {
+        return;
+    }
+
+    const QString hexFileName(
+                QFileDialog::getSaveFileName(
+                    this,
+                    tr("Save changes in hex..."),
+                    m_lastHEXPath + "/" + QFileInfo(project->hexPath()).completeBaseName() + "_"
+                    + QString(project->currentVariant()).replace(' ', '_') + ".hex",
+                    QString::fromLatin1("hex files (*.hex);;All files (*)"),
+                    0, 0)
+                );
+
+    if ( hexFileName.isEmpty() ) {
+        return;
+    }
 
     QTime timer;
     timer.start();
 
-    ui->statusBar->showMessage("Displaying values. Please wait...");
-    QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+    if ( !project->saveVariant(hexFileName) ) {
+        QMessageBox::critical(this, QString(PROGNAME) + ": error", "Can not write " + hexFileName + "!");
+        return;
+    }
 
-    //
+    ui->plainTextEdit_log->appendPlainText(
+                QDateTime::currentDateTime().toString("[yyyy-MM-dd_hh-mm-ss]")
+                + " Saving " + project->currentVariant() + " to " + hexFileName + ": "
+                + QString::number(timer.elapsed()) + " ms"
+                );
+}
 
-    QTableWidgetSelectionRange selectedRange;
+void MainWindow::on_action_Checksums_triggered() {
 
-    for ( ptrdiff_t n=0; n<ui->tableWidget_Labels->selectedRanges().size(); n++ ) {
+    ProjectWidget *project = currentProject();
 
-        selectedRange = ui->tableWidget_Labels->selectedRanges()[n];
+    if ( !project ) {
+        return;
+    }
 
-        for ( ptrdiff_t i=0; i<selectedRange.rowCount(); i++ ) {
+    QStringList lines;
 
-            ui->tableWidget_Labels->
-                    item(selectedRange.topRow()+i, selectedRange.leftColumn())->
-                    setTextColor(QColor(Qt::red));
-            addParameterToTable(selectedRange.topRow()+i);
+    for ( ptrdiff_t i=0; i<project->checksums().size(); i++ ) {
+        lines.push_back(project->checksums()[i].toString());
+    }
+
+    bool ok = false;
+
+    const QString text =
+            QInputDialog::getMultiLineText(
+                this,
+                QString(PROGNAME),
+                "Checksums updated on saving, one per line\n"
+                "(algorithm:begin-end:target[:fill], hex numbers, e.g. CRC_32:80000-8FFFC:8FFFC):",
+                lines.join('\n'),
+                &ok);
+
+    if ( !ok ) {
+        return;
+    }
+
+    lines.clear();
+
+    const QStringList rows = text.split('\n');
+
+    for ( ptrdiff_t i=0; i<rows.size(); i++ ) {
+
+        if ( !rows[i].trimmed().isEmpty() ) {
+            lines.push_back(rows[i].trimmed());
         }
     }
 
-    ptrdiff_t ind = ui->tableWidget_Labels->currentRow();
+    QVector<Checksum> checksums;
+    QString bad;
 
-    if ( ind != (ui->tableWidget_Labels->rowCount()-1) ) {
-        ui->tableWidget_Labels->setCurrentCell(ind+1, 0);
+    if ( !parseChecksums(lines, checksums, bad) ) {
+        QMessageBox::critical(this, QString(PROGNAME) + ": error", "Wrong checksum definition " + bad + "!");
+        return;
     }
 
-    ui->tableWidget_Scalars->resizeRowsToContents();
-    ui->tableWidget_Scalars->resizeColumnsToContents();
+    project->setChecksums(checksums);
+
+    if ( lines.isEmpty() ) {
+        m_checksums.remove(project->a2lPath());
+    }
+    else {
+        m_checksums.insert(project->a2lPath(), lines);
+    }
+}
+
+void MainWindow::on_action_LiveMeasurement_triggered() {
+
+    ProjectWidget *project = currentProject();
+
+    if ( !project ) {
+        return;
+    }
+
+    m_liveDialog->setA2L(project->a2lPath()); // ignored while recording
+    m_liveDialog->show();
+    m_liveDialog->raise();
+}
+
+void MainWindow::on_action_SearchLine_triggered() {
+
+    ProjectWidget *project = currentProject();
+
+    if ( project ) {
+        project->focusSearchLine();
+    }
+}
+
+void MainWindow::on_action_Select_triggered() {
+
+    ProjectWidget *project = currentProject();
+
+    if ( !project ) {
+        return;
+    }
+
+    QTime timer;
+    timer.start();
+
+    ui->statusBar->showMessage("Displaying values. Please wait...");
+    QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+
+    //
+
+    project->addSelectedLabels();
 
     //
 
@@ -282,6 +733,12 @@ void MainWindow::on_action_Select_triggered() {
 
 void MainWindow::on_action_Unselect_triggered() {
 
+    ProjectWidget *project = currentProject();
+
+    if ( !project ) {
+        return;
+    }
+
     QTime timer;
     timer.start();
 
@@ -290,29 +747,7 @@ void MainWindow::on_action_Unselect_triggered() {
 
     //
 
-    QTableWidgetSelectionRange selectedRange;
-
-    for ( ptrdiff_t n=0; n<ui->tableWidget_Labels->selectedRanges().size(); n++ ) {
-
-        selectedRange = ui->tableWidget_Labels->selectedRanges()[n];
-
-        for ( ptrdiff_t i=0; i<selectedRange.rowCount(); i++ ) {
-
-            ui->tableWidget_Labels->
-                    item(selectedRange.topRow()+i, selectedRange.leftColumn())->
-                    setTextColor(QColor(Qt::black));
-            deleteParameterFromTable(selectedRange.topRow()+i);
-        }
-    }
-
-    ptrdiff_t ind = ui->tableWidget_Labels->currentRow();
-
-    if ( ind != (ui->tableWidget_Labels->rowCount()-1) ) {
-        ui->tableWidget_Labels->setCurrentCell(ind+1, 0);
-    }
-
-    ui->tableWidget_Scalars->resizeRowsToContents();
-    ui->tableWidget_Scalars->resizeColumnsToContents();
+    project->removeSelectedLabels();
 
     //
 
@@ -329,45 +764,48 @@ void MainWindow::on_action_LabelInfo_triggered() {
     QTableWidget *tableWidget_Description =
             m_labelInfoDialog->findChild<QTableWidget *>("tableWidget_Description");
 
-    ptrdiff_t currItemInd = ui->tableWidget_Labels->currentRow();
+    ProjectWidget *project = currentProject();
 
-    if ( currItemInd < 0 ) {
+    if ( !project || project->currentLabel() < 0 ) {
         return;
     }
 
-    tableWidget_Description->item(0, 1)->setText(m_scalars[currItemInd]->name());
-    tableWidget_Description->item(1, 1)->setText(m_scalars[currItemInd]->shortDescription());
-    tableWidget_Description->item(2, 1)->setText(m_scalars[currItemInd]->address());
-    tableWidget_Description->item(3, 1)->setText(m_scalars[currItemInd]->numType());
+    const QVector< QSharedPointer<ECUScalar> > &scalars = project->scalars();
+    const ptrdiff_t currItemInd = project->currentLabel();
+
+    tableWidget_Description->item(0, 1)->setText(scalars[currItemInd]->name());
+    tableWidget_Description->item(1, 1)->setText(scalars[currItemInd]->shortDescription());
+    tableWidget_Description->item(2, 1)->setText(scalars[currItemInd]->address());
+    tableWidget_Description->item(3, 1)->setText(scalars[currItemInd]->numType());
 
-    if ( m_scalars[currItemInd]->type() == VARTYPE_SCALAR_NUM ) {
+    if ( scalars[currItemInd]->type() == VARTYPE_SCALAR_NUM ) {
         tableWidget_Description->item(4, 1)->setText("Numeric");
     }
-    else if ( m_scalars[currItemInd]->type() == VARTYPE_SCALAR_VTAB ) {
+    else if ( scalars[currItemInd]->type() == VARTYPE_SCALAR_VTAB ) {
         tableWidget_Description->item(4, 1)->setText("VTable");
     }
 
     tableWidget_Description->item(5, 1)->setText(
-                QString::number(m_scalars[currItemInd]->minValueSoft(), 'f', m_scalars[currItemInd]->precision())
+                QString::number(scalars[currItemInd]->minValueSoft(), 'f', scalars[currItemInd]->precision())
                 );
     tableWidget_Description->item(6, 1)->setText(
-                QString::number(m_scalars[currItemInd]->maxValueSoft(), 'f', m_scalars[currItemInd]->precision())
+                QString::number(scalars[currItemInd]->maxValueSoft(), 'f', scalars[currItemInd]->precision())
                 );
     tableWidget_Description->item(7, 1)->setText(
-                QString::number(m_scalars[currItemInd]->minValueHard(), 'f', m_scalars[currItemInd]->precision())
+                QString::number(scalars[currItemInd]->minValueHard(), 'f', scalars[currItemInd]->precision())
                 );
     tableWidget_Description->item(8, 1)->setText(
-                QString::number(m_scalars[currItemInd]->maxValueHard(), 'f', m_scalars[currItemInd]->precision())
+                QString::number(scalars[currItemInd]->maxValueHard(), 'f', scalars[currItemInd]->precision())
                 );
 
-    if ( m_scalars[currItemInd]->isReadOnly() ) {
+    if ( scalars[currItemInd]->isReadOnly() ) {
         tableWidget_Description->item(9, 1)->setText("true");
     }
     else {
         tableWidget_Description->item(9, 1)->setText("false");
     }
 
-    tableWidget_Description->item(10, 1)->setText(m_scalars[currItemInd]->dimension());
+    tableWidget_Description->item(10, 1)->setText(scalars[currItemInd]->dimension());
 
     tableWidget_Description->resizeColumnsToContents();
 
@@ -376,6 +814,12 @@ void MainWindow::on_action_LabelInfo_triggered() {
     m_labelInfoDialog->show();
 }
 
+void MainWindow::on_action_PerformanceSummary_triggered() {
+
+    m_traceDialog->refresh();
+    m_traceDialog->show();
+}
+
 void MainWindow::on_action_About_triggered() {
 
     const QString str =
@@ -404,25 +848,20 @@ void MainWindow::on_action_About_triggered() {
     QMessageBox::about(this, "About " + QString(PROGNAME), str);
 }
 
-void MainWindow::searchTemplChanged(QString templ) {
-
-    QRegExp regexp(R"(^)" + templ.toLower().replace("*", ".*") + R"(.*$)");
-
-    for ( ptrdiff_t i=0; i<ui->tableWidget_Labels->rowCount(); i++ ) {
-
-        if ( regexp.exactMatch(ui->tableWidget_Labels->item(i, 0)->text().toLower()) ) {
-            ui->tableWidget_Labels->setCurrentCell(i, 0);
-            break;
-        }
-    }
-}
-
 void MainWindow::writeProgramSettings() {
 
     m_progSettings.beginGroup("/settings");
     m_progSettings.setValue("/window_geometry", geometry());
     m_progSettings.setValue("/last_a2l_path", m_lastA2LPath);
     m_progSettings.setValue("/last_hex_path", m_lastHEXPath);
+
+    QVariantMap checksums;
+
+    for ( QMap<QString, QStringList>::const_iterator it=m_checksums.constBegin(); it!=m_checksums.constEnd(); ++it ) {
+        checksums.insert(it.key(), it.value());
+    }
+
+    m_progSettings.setValue("/checksums", checksums);
     m_progSettings.endGroup();
 }
 
@@ -432,147 +871,95 @@ void MainWindow::readProgramSettings() {
     setGeometry(m_progSettings.value("/window_geometry", QRect(20, 40, 0, 0)).toRect());
     m_lastA2LPath = m_progSettings.value("/last_a2l_path", QDir::currentPath()).toString();
     m_lastHEXPath = m_progSettings.value("/last_hex_path", QDir::currentPath()).toString();
-    m_progSettings.endGroup();
-}
 
-void MainWindow::addParameterToTable(ptrdiff_t ind) {
+    const QVariantMap checksums = m_progSettings.value("/checksums").toMap();
 
-    if ( m_scalarsInTable[ind] ) {
-        return;
+    for ( QVariantMap::const_iterator it=checksums.constBegin(); it!=checksums.constEnd(); ++it ) {
+        m_checksums.insert(it.key(), it.value().toStringList());
     }
 
-    ptrdiff_t varType = m_scalars[ind]->type();
+    m_progSettings.endGroup();
+}
 
-    ptrdiff_t tblRow = ui->tableWidget_Scalars->rowCount();
-    ui->tableWidget_Scalars->setRowCount(tblRow + 1);
+ProjectWidget *MainWindow::currentProject() const {
+    return qobject_cast<ProjectWidget *>(ui->tabWidget_Projects->currentWidget());
+}
 
-    if ( varType == VARTYPE_SCALAR_NUM ) {
+void MainWindow::openProject(const QString &a2lFileName, const QString &hexFileName) {
 
-        ui->tableWidget_Scalars->setItem(tblRow, 0, new QTableWidgetItem(m_scalars[ind]->name()));
-        ui->tableWidget_Scalars->item(tblRow, 0)->
-                setFlags(ui->tableWidget_Scalars->item(tblRow, 0)->flags() ^ Qt::ItemIsEditable);
+    ProjectWidget *project = new ProjectWidget(ui->tabWidget_Projects);
 
-        ui->tableWidget_Scalars->setItem(tblRow, 1, new QTableWidgetItem(m_scalars[ind]->value()));
-        ui->tableWidget_Scalars->item(tblRow, 1)->setTextColor(QColor(Qt::blue));
+    connect(project, SIGNAL(message(QString)), this, SLOT(appendToLog(QString)));
+    connect(project, SIGNAL(stateChanged()), this, SLOT(updateProjectState()));
 
-        ui->tableWidget_Scalars->setItem(tblRow, 2, new QTableWidgetItem(m_scalars[ind]->dimension()));
-        ui->tableWidget_Scalars->item(tblRow, 2)->
-                setFlags(ui->tableWidget_Scalars->item(tblRow, 2)->flags() ^ Qt::ItemIsEditable);
+    QVector<Checksum> checksums;
+    QString bad;
 
-        m_scalarsInTable[ind] = true;
+    if ( parseChecksums(m_checksums.value(a2lFileName), checksums, bad) ) {
+        project->setChecksums(checksums);
     }
-    else if ( varType == VARTYPE_SCALAR_VTAB ) {
-
-        ui->tableWidget_Scalars->setItem(tblRow, 0, new QTableWidgetItem(m_scalars[ind]->name()));
-        ui->tableWidget_Scalars->item(tblRow, 0)->
-                setFlags(ui->tableWidget_Scalars->item(tblRow, 0)->flags() ^ Qt::ItemIsEditable);
-
-        m_comboBox_vTable = new QComboBox(ui->tableWidget_Scalars);
-        m_comboBox_vTable->setMinimumWidth(230);
-        ui->tableWidget_Scalars->setCellWidget(tblRow, 1, m_comboBox_vTable);
-
-        m_comboBox_vTable->addItems(m_scalars[ind]->vTable());
-        m_comboBox_vTable->setCurrentIndex(m_scalars[ind]->value().toInt());
 
-        ui->tableWidget_Scalars->setItem(tblRow, 2, new QTableWidgetItem(m_scalars[ind]->dimension()));
-        ui->tableWidget_Scalars->item(tblRow, 2)->
-                setFlags(ui->tableWidget_Scalars->item(tblRow, 2)->flags() ^ Qt::ItemIsEditable);
+    const int ind = ui->tabWidget_Projects->addTab(project, project->title());
+    ui->tabWidget_Projects->setCurrentIndex(ind);
 
-        m_scalarsInTable[ind] = true;
-    }
+    project->load(a2lFileName, hexFileName);
 }
 
-void MainWindow::deleteParameterFromTable(ptrdiff_t ind) {
-
-    for ( ptrdiff_t i=0; i<ui->tableWidget_Scalars->rowCount(); i++ ) {
+void MainWindow::closeProject(int ind) {
 
-        if ( ui->tableWidget_Scalars->item(i, 0)->text() ==
-             ui->tableWidget_Labels->item(ind, 0)->text() ) {
+    QWidget *project = ui->tabWidget_Projects->widget(ind);
 
-            ui->tableWidget_Scalars->removeRow(i);
-            m_scalarsInTable[ind] = false;
-        }
+    if ( !project ) {
+        return;
     }
-}
-
-void MainWindow::readA2LInfo(const QString &filepath) {
-
-    ui->statusBar->showMessage("Parsing a2l file. It may take a long time. Please wait...");
-    QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
-
-    //
-
-    QSharedPointer<A2L> a2l(new A2L(filepath));
-    globA2L = a2l.data();
-    globScalars = &m_scalars;
 
-    QFuture<void> sepThrFun = QtConcurrent::run(parseA2L);
-    sepThrFun.waitForFinished();
-
-    globA2L = 0;
-    globScalars = 0;
-
-    //
-
-    ui->statusBar->clearMessage();
+    ui->tabWidget_Projects->removeTab(ind);
+    delete project; // cancels and waits for its loader
 }
 
-void MainWindow::readHEXData(const QString &filepath) {
-
-    ui->statusBar->showMessage("Reading hex file. It may take a long time. Please wait...");
-    QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
-
-    //
-
-    QSharedPointer<IntelHEX> ihex(new IntelHEX(filepath));
-    globIHEX = ihex.data();
-    globScalars = &m_scalars;
-
-    QFuture<void> sepThrFun = QtConcurrent::run(readHEX);
-    sepThrFun.waitForFinished();
-
-    globIHEX = 0;
-    globScalars = 0;
-
-    //
-
-    ui->statusBar->clearMessage();
+void MainWindow::appendToLog(QString str) {
+    ui->plainTextEdit_log->appendPlainText(str);
 }
 
-void MainWindow::showLabels() {
+void MainWindow::updateProjectState() {
 
-    ui->statusBar->showMessage("Displaying labels. Please wait...");
-    QCoreApplication::processEvents(QEventLoop::ExcludeUserInputEvents);
+    for ( ptrdiff_t i=0; i<ui->tabWidget_Projects->count(); i++ ) {
 
-    //
+        const ProjectWidget *project =
+                qobject_cast<const ProjectWidget *>(ui->tabWidget_Projects->widget(i));
 
-    m_scalarsInTable = QVector<bool>(m_scalars.size());
-    ui->tableWidget_Labels->setRowCount(m_scalars.size());
-
-    for ( ptrdiff_t i=0; i<m_scalars.size(); i++ ) {
-        ui->tableWidget_Labels->setItem(i, 0, new QTableWidgetItem(m_scalars[i]->name()));
-        ui->tableWidget_Labels->item(i, 0)->
-                setFlags(ui->tableWidget_Labels->item(i, 0)->flags() ^ Qt::ItemIsEditable);
+        ui->tabWidget_Projects->setTabText(i, project->title());
+        ui->tabWidget_Projects->setTabToolTip(i, project->a2lPath() + "\n" + project->hexPath());
     }
 
-    ui->tableWidget_Labels->resizeRowsToContents();
-    ui->tableWidget_Labels->resizeColumnsToContents();
-
-    //
-
-    ui->statusBar->clearMessage();
+    const ProjectWidget *project = currentProject();
+    const bool ready = project && !project->isLoading();
+
+    ui->action_CloseProject->setEnabled(project != 0);
+    ui->action_CompareHex->setEnabled(ready);
+    ui->action_CompareFleet->setEnabled(ready);
+    ui->action_SaveLimitReport->setEnabled(ready);
+    ui->action_ExportValues->setEnabled(ready);
+    ui->action_ImportDCM->setEnabled(ready && !project->variants().isEmpty());
+    ui->action_NewVariant->setEnabled(ready && !project->variants().isEmpty());
+    ui->action_RemoveVariant->setEnabled(ready && project->variants().size() > 1);
+    ui->action_SaveChangesInHex->setEnabled(ready && project->isModified());
+    ui->action_Checksums->setEnabled(project != 0);
+    ui->action_LiveMeasurement->setEnabled(project != 0);
+    ui->action_SearchLine->setEnabled(project != 0);
+    ui->action_Select->setEnabled(ready);
+    ui->action_Unselect->setEnabled(ready);
+    ui->action_LabelInfo->setEnabled(project != 0);
 }
 
 void MainWindow::blockGUI() {
 
     ui->menuBar->setEnabled(false);
-    ui->groupBox_Labels->setEnabled(false);
-    ui->tabWidget->setEnabled(false);
+    ui->tabWidget_Projects->setEnabled(false);
 }
 
 void MainWindow::unblockGUI() {
 
     ui->menuBar->setEnabled(true);
-    ui->groupBox_Labels->setEnabled(true);
-    ui->tabWidget->setEnabled(true);
+    ui->tabWidget_Projects->setEnabled(true);
 }
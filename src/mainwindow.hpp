@@ -25,10 +25,22 @@
 #include <QString>
 #include <QSettings>
 #include <QDir>
-#include <QComboBox>
-
-#include "ecuscalar.hpp"
+#include <QMap>
+#include <QStringList>
+#include <QFutureWatcher>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QTime>
+#include <QTimer>
+#include <QProgressDialog>
+
+#include "projectwidget.hpp"
 #include "labelinfodialog.hpp"
+#include "tracedialog.hpp"
+#include "livemeasurementdialog.hpp"
+#include "intelhex.hpp"
+#include "fleetcompare.hpp"
+#include "loadcontrol.hpp"
 
 namespace Ui {
 class MainWindow;
@@ -45,35 +57,61 @@ public:
 private slots:
     void on_action_OpenProject_triggered();
     void on_action_OpenA2L_triggered();
+    void on_action_CloseProject_triggered();
+    void on_action_CompareHex_triggered();
+    void on_action_CompareFleet_triggered();
+    void on_action_SaveLimitReport_triggered();
+    void on_action_ExportValues_triggered();
+    void on_action_ImportDCM_triggered();
+    void on_action_NewVariant_triggered();
+    void on_action_RemoveVariant_triggered();
+    void on_action_SaveChangesInHex_triggered();
+    void on_action_Checksums_triggered();
+    void on_action_LiveMeasurement_triggered();
     void on_action_SearchLine_triggered();
     void on_action_Select_triggered();
     void on_action_Unselect_triggered();
     void on_action_LabelInfo_triggered();
+    void on_action_PerformanceSummary_triggered();
     void on_action_About_triggered();
 
-    void searchTemplChanged(QString);
+    void compareHexFinished();
+    void fleetCompareFinished();
+    void fleetCompareProgress();
+
+    void closeProject(int);
+    void appendToLog(QString);
+    void updateProjectState();
 
 private:
     Ui::MainWindow *ui;
     LabelInfoDialog *m_labelInfoDialog;
-
-    QComboBox *m_comboBox_vTable;
+    TraceDialog *m_traceDialog;
+    LiveMeasurementDialog *m_liveDialog;
 
     QString m_lastA2LPath = QDir::currentPath();
     QString m_lastHEXPath = QDir::currentPath();
     QSettings m_progSettings;
-    QVector< QSharedPointer<ECUScalar> > m_scalars;
-    QVector<bool> m_scalarsInTable;
+    QMap<QString, QStringList> m_checksums; // definitions by a2l path
+
+    QFutureWatcher<bool> m_compareWatcher;
+    QSharedPointer<IntelHEX> m_compareHex;
+    QPointer<ProjectWidget> m_compareProject;
+    QTime m_compareTimer;
+
+    QFutureWatcher<bool> m_fleetWatcher;
+    QSharedPointer<FleetCompare> m_fleet;
+    LoadControl m_fleetControl;
+    QTimer m_fleetProgressTimer;
+    QProgressDialog *m_fleetProgress = 0;
+    QString m_fleetCsvPath;
+    QTime m_fleetTimer;
 
     void writeProgramSettings();
     void readProgramSettings();
 
-    void addParameterToTable(ptrdiff_t);
-    void deleteParameterFromTable(ptrdiff_t);
-
-    void readA2LInfo(const QString &);
-    void readHEXData(const QString &);
-    void showLabels();
+    ProjectWidget *currentProject() const;
+    void openProject(const QString &, const QString &);
 
     void blockGUI();
     void unblockGUI();
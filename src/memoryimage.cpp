@@ -0,0 +1,169 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: memoryimage.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "memoryimage.hpp"
+
+#include <QByteArray>
+#include <QMap>
+
+#include <cstring>
+
+MemoryImage::MemoryImage() {
+}
+
+void MemoryImage::write(quint32 addr, const char *src, size_t len) {
+
+    if ( len == 0 ) {
+        return;
+    }
+
+    const quint64 end = quint64(addr) + len;
+    QMap<quint32, QByteArray>::iterator it = m_segments.upperBound(addr);
+
+    if ( it != m_segments.begin() ) {
+
+        --it;
+
+        const quint64 segEnd = quint64(it.key()) + it.value().size();
+
+        if ( segEnd >= addr ) { // overlaps or continues the previous segment
+
+            QByteArray &seg = it.value();
+
+            if ( end > segEnd ) {
+                seg.resize(end - it.key());
+            }
+
+            memcpy(seg.data() + (addr - it.key()), src, len);
+            mergeFollowing(it);
+
+            return;
+        }
+    }
+
+    it = m_segments.insert(addr, QByteArray(src, len));
+    mergeFollowing(it);
+}
+
+bool MemoryImage::read(quint32 addr, size_t len, char *dst) const {
+
+    const char *src = constData(addr, len);
+
+    if ( !src ) {
+        return false;
+    }
+
+    memcpy(dst, src, len);
+
+    return true;
+}
+
+const char *MemoryImage::constData(quint32 addr, size_t len) const {
+
+    QMap<quint32, QByteArray>::const_iterator it = findSegment(addr);
+
+    if ( it == m_segments.constEnd() ) {
+        return 0;
+    }
+
+    if ( quint64(addr) + len > quint64(it.key()) + it.value().size() ) {
+        return 0;
+    }
+
+    return it.value().constData() + (addr - it.key());
+}
+
+char *MemoryImage::data(quint32 addr, size_t len) {
+
+    QMap<quint32, QByteArray>::iterator it = m_segments.upperBound(addr);
+
+    if ( it == m_segments.begin() ) {
+        return 0;
+    }
+
+    --it;
+
+    if ( quint64(addr) + len > quint64(it.key()) + it.value().size() ) {
+        return 0;
+    }
+
+    return it.value().data() + (addr - it.key());
+}
+
+bool MemoryImage::contains(quint32 addr, size_t len) const {
+    return constData(addr, len) != 0;
+}
+
+void MemoryImage::clear() {
+    m_segments.clear();
+}
+
+size_t MemoryImage::size() const {
+
+    size_t ret = 0;
+
+    for ( QMap<quint32, QByteArray>::const_iterator it = m_segments.constBegin();
+          it != m_segments.constEnd(); ++it ) {
+        ret += it.value().size();
+    }
+
+    return ret;
+}
+
+QMap<quint32, QByteArray>::const_iterator MemoryImage::findSegment(quint32 addr) const {
+
+    QMap<quint32, QByteArray>::const_iterator it = m_segments.upperBound(addr);
+
+    if ( it == m_segments.constBegin() ) {
+        return m_segments.constEnd();
+    }
+
+    --it;
+
+    if ( quint64(addr) >= quint64(it.key()) + it.value().size() ) {
+        return m_segments.constEnd();
+    }
+
+    return it;
+}
+
+void MemoryImage::mergeFollowing(QMap<quint32, QByteArray>::iterator it) {
+
+    QMap<quint32, QByteArray>::iterator next = it;
+    ++next;
+
+    while ( next != m_segments.end() ) {
+
+        const quint64 curEnd = quint64(it.key()) + it.value().size();
+
+        if ( next.key() > curEnd ) {
+            break;
+        }
+
+        // the data just written wins, only the tail of the next segment survives
+        const quint64 nextEnd = quint64(next.key()) + next.value().size();
+
+        if ( nextEnd > curEnd ) {
+            it.value().append(next.value().constData() + (curEnd - next.key()), nextEnd - curEnd);
+        }
+
+        next = m_segments.erase(next);
+    }
+}
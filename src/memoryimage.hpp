@@ -0,0 +1,57 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: memoryimage.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef MEMORYIMAGE_HPP
+#define MEMORYIMAGE_HPP
+
+#include <QByteArray>
+#include <QMap>
+
+// Sparse ECU memory: contiguous segments keyed by start address.
+// Adjacent and overlapping writes are merged into one segment.
+
+class MemoryImage {
+
+public:
+    MemoryImage();
+    void write(quint32, const char *, size_t);
+    bool read(quint32, size_t, char *) const;
+    const char *constData(quint32, size_t) const; // 0 if not contiguous
+    char *data(quint32, size_t);                  // 0 if not contiguous
+    bool contains(quint32, size_t) const;
+    void clear();
+
+    bool isEmpty() const {
+        return m_segments.isEmpty();
+    }
+    const QMap<quint32, QByteArray> &segments() const {
+        return m_segments;
+    }
+    size_t size() const; // total number of stored bytes
+
+private:
+    QMap<quint32, QByteArray> m_segments; // start address -> bytes
+
+    QMap<quint32, QByteArray>::const_iterator findSegment(quint32) const;
+    void mergeFollowing(QMap<quint32, QByteArray>::iterator);
+
+};
+
+#endif // MEMORYIMAGE_HPP
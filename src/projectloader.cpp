@@ -0,0 +1,180 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: projectloader.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "projectloader.hpp"
+#include "a2lcache.hpp"
+#include "intelhex.hpp"
+#include "scalarcodec.hpp"
+#include "constants.hpp"
+#include "trace.hpp"
+
+#include <QtConcurrent/QtConcurrentRun>
+
+ProjectLoader::ProjectLoader(QObject *parent) :
+    QObject(parent) {
+
+    m_progressTimer.setInterval(100);
+
+    connect(&m_watcher, SIGNAL(finished()), this, SLOT(stageFinished()));
+    connect(&m_progressTimer, SIGNAL(timeout()), this, SLOT(reportProgress()));
+}
+
+ProjectLoader::~ProjectLoader() {
+
+    m_control.cancel();
+    m_watcher.waitForFinished();
+}
+
+void ProjectLoader::start(const QString &a2lPath, const QString &hexPath) {
+
+    if ( isRunning() ) {
+        return;
+    }
+
+    m_a2lPath = a2lPath;
+    m_hexPath = hexPath;
+    m_readingHex = false;
+    m_scalars.clear();
+    m_image.clear();
+    m_values.clear();
+    m_valueStrings.clear();
+    m_error.clear();
+    m_control.reset();
+
+    m_watcher.setFuture(QtConcurrent::run(this, &ProjectLoader::parseA2L));
+    m_progressTimer.start();
+}
+
+void ProjectLoader::cancel() {
+    m_control.cancel();
+}
+
+void ProjectLoader::stageFinished() {
+
+    const bool ok = m_watcher.result();
+
+    if ( !ok ) {
+
+        m_progressTimer.stop();
+
+        if ( m_control.isCanceled() ) {
+            emit canceled();
+        }
+        else {
+            emit failed(m_error);
+        }
+
+        return;
+    }
+
+    if ( !m_readingHex ) {
+
+        emit labelsLoaded();
+
+        if ( m_hexPath.isEmpty() ) {
+            m_progressTimer.stop();
+            return;
+        }
+
+        m_readingHex = true;
+        m_control.setProgress(0, 0);
+        m_control.setObjects(0);
+        m_watcher.setFuture(QtConcurrent::run(this, &ProjectLoader::readHEX));
+
+        return;
+    }
+
+    m_progressTimer.stop();
+    applyValues();
+
+    emit valuesLoaded();
+}
+
+void ProjectLoader::reportProgress() {
+
+    emit progress(m_readingHex ? "Reading hex file" : "Parsing a2l file",
+                  m_control.bytesDone(), m_control.bytesTotal(), m_control.objects());
+}
+
+bool ProjectLoader::parseA2L() { // runs on the thread pool
+
+    bool ok = false;
+    m_scalars = A2LCache::instance().scalars(m_a2lPath, &ok, &m_control);
+
+    if ( !ok ) {
+        m_error = "Error occured during a2l file parsing!";
+        return false;
+    }
+
+    return !m_control.isCanceled();
+}
+
+bool ProjectLoader::readHEX() { // runs on the thread pool
+
+    bool ok = false;
+    m_image = IntelHEX::load(m_hexPath, &ok, &m_control);
+
+    if ( !ok ) {
+        m_error = "Error occured during hex file reading!";
+        return false;
+    }
+
+    TraceScope trace("hex.decode");
+
+    // the scalars are visible to the GUI already, so values are only
+    // collected here and applied in the GUI thread
+
+    m_values.resize(m_scalars.size());
+    m_valueStrings.resize(m_scalars.size());
+
+    for ( ptrdiff_t i=0; i<m_scalars.size(); i++ ) {
+
+        if ( (i % LOADCHECKINTERVAL) == 0 ) {
+
+            m_control.setObjects(i);
+
+            if ( m_control.isCanceled() ) {
+                return false;
+            }
+        }
+
+        if ( !ScalarCodec::decode(*m_scalars[i], m_image, m_values[i]) ) {
+            m_error = "Error occured during hex file reading: no data for " + m_scalars[i]->name() + "!";
+            return false;
+        }
+
+        m_valueStrings[i] = ScalarCodec::toString(*m_scalars[i], m_values[i]);
+    }
+
+    Trace::instance().count("hex.decoded", m_scalars.size());
+
+    return true;
+}
+
+void ProjectLoader::applyValues() {
+
+    for ( ptrdiff_t i=0; i<m_scalars.size(); i++ ) {
+        m_scalars[i]->setValue(m_valueStrings[i]);
+        m_scalars[i]->setPhysValue(m_values[i]);
+    }
+
+    m_values.clear();
+    m_valueStrings.clear();
+}
@@ -0,0 +1,92 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: projectloader.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROJECTLOADER_HPP
+#define PROJECTLOADER_HPP
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QSharedPointer>
+#include <QFutureWatcher>
+#include <QTimer>
+
+#include "ecuscalar.hpp"
+#include "memoryimage.hpp"
+#include "loadcontrol.hpp"
+
+// Loads an a2l file and (optionally) a hex file on the thread pool.
+// labelsLoaded() is emitted as soon as the a2l file is parsed, so the
+// labels can be browsed while the hex file is still being read.
+
+class ProjectLoader : public QObject {
+
+    Q_OBJECT
+
+public:
+    explicit ProjectLoader(QObject *parent = 0);
+    ~ProjectLoader();
+    void start(const QString &, const QString &); // a2l path, hex path (may be empty)
+
+    bool isRunning() const {
+        return m_watcher.isRunning();
+    }
+    const QVector< QSharedPointer<ECUScalar> > &scalars() const {
+        return m_scalars;
+    }
+    const MemoryImage &image() const {
+        return m_image;
+    }
+
+public slots:
+    void cancel();
+
+signals:
+    void progress(QString, qint64, qint64, qint64); // stage, bytes done, bytes total, objects
+    void labelsLoaded();
+    void valuesLoaded();
+    void failed(QString);
+    void canceled();
+
+private slots:
+    void stageFinished();
+    void reportProgress();
+
+private:
+    QString m_a2lPath;
+    QString m_hexPath;
+    LoadControl m_control;
+    QFutureWatcher<bool> m_watcher;
+    QTimer m_progressTimer;
+    bool m_readingHex = false;
+
+    QVector< QSharedPointer<ECUScalar> > m_scalars;
+    MemoryImage m_image;
+    QVector<double> m_values;
+    QVector<QString> m_valueStrings;
+    QString m_error;
+
+    bool parseA2L();
+    bool readHEX();
+    void applyValues();
+
+};
+
+#endif // PROJECTLOADER_HPP
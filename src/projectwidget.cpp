@@ -0,0 +1,778 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: projectwidget.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "projectwidget.hpp"
+#include "ui_projectwidget.h"
+#include "constants.hpp"
+#include "scalarcodec.hpp"
+#include "intelhex.hpp"
+#include "valuesdelegate.hpp"
+#include "trace.hpp"
+
+#include <QMessageBox>
+#include <QFileInfo>
+#include <QColor>
+#include <QTableWidgetItem>
+#include <QHeaderView>
+#include <QModelIndex>
+#include <QModelIndexList>
+#include <QItemSelectionModel>
+#include <QDateTime>
+#include <QHash>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <limits>
+
+ProjectWidget::ProjectWidget(QWidget *parent) :
+    QWidget(parent),
+    ui(new Ui::ProjectWidget),
+    m_labelsModel(new LabelsModel(this)),
+    m_labelsFilterModel(new LabelsFilterModel(this)),
+    m_valuesModel(new ValuesModel(this)),
+    m_loader(new ProjectLoader(this)),
+    m_fileWatcher(new QFileSystemWatcher(this)) {
+
+    ui->setupUi(this);
+
+    //
+
+    m_labelsFilterModel->setSourceModel(m_labelsModel);
+    ui->tableView_Labels->setModel(m_labelsFilterModel);
+    ui->tableView_Scalars->setModel(m_valuesModel);
+    ui->tableView_Scalars->setItemDelegateForColumn(1, new ValuesDelegate(this));
+
+    // fixed row heights: the views never measure rows
+
+    const int rowHeight = fontMetrics().height() + 6;
+
+    ui->tableView_Labels->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    ui->tableView_Labels->verticalHeader()->setDefaultSectionSize(rowHeight);
+    ui->tableView_Scalars->verticalHeader()->setSectionResizeMode(QHeaderView::Fixed);
+    ui->tableView_Scalars->verticalHeader()->setDefaultSectionSize(rowHeight);
+
+    //
+
+    ui->widget_Progress->hide();
+
+    connect(ui->pushButton_Cancel, SIGNAL(clicked()), m_loader, SLOT(cancel()));
+    connect(m_loader, SIGNAL(progress(QString,qint64,qint64,qint64)),
+            this, SLOT(loadProgress(QString,qint64,qint64,qint64)));
+    connect(m_loader, SIGNAL(labelsLoaded()), this, SLOT(labelsLoaded()));
+    connect(m_loader, SIGNAL(valuesLoaded()), this, SLOT(valuesLoaded()));
+    connect(m_loader, SIGNAL(failed(QString)), this, SLOT(loadFailed(QString)));
+    connect(m_loader, SIGNAL(canceled()), this, SLOT(loadCanceled()));
+
+    connect(ui->lineEdit_QuickSearch, SIGNAL(textChanged(QString)), this, SLOT(searchTemplChanged(QString)));
+    connect(m_valuesModel, SIGNAL(valueEdited(ptrdiff_t,double)), this, SLOT(valueEdited(ptrdiff_t,double)));
+    connect(ui->comboBox_Variant, SIGNAL(activated(QString)), this, SLOT(variantActivated(QString)));
+
+    // hot reload: wait until the flashing tool has finished writing
+
+    m_reloadTimer.setSingleShot(true);
+    m_reloadTimer.setInterval(RELOADDELAY);
+
+    connect(m_fileWatcher, SIGNAL(fileChanged(QString)), this, SLOT(fileChanged(QString)));
+    connect(&m_reloadTimer, SIGNAL(timeout()), this, SLOT(reloadChangedFiles()));
+    connect(&m_reloadWatcher, SIGNAL(finished()), this, SLOT(hexReloaded()));
+}
+
+ProjectWidget::~ProjectWidget() {
+
+    m_reloadWatcher.waitForFinished();
+
+    delete ui;
+}
+
+void ProjectWidget::load(const QString &a2lFileName, const QString &hexFileName) {
+
+    if ( m_loading ) {
+        return;
+    }
+
+    m_reloadWatcher.waitForFinished(); // it reads the scalars and the image
+    m_reloadTimer.stop();
+    m_a2lChanged = false;
+    m_hexChanged = false;
+
+    if ( !m_fileWatcher->files().isEmpty() ) {
+        m_fileWatcher->removePaths(m_fileWatcher->files());
+    }
+
+    ui->lineEdit_QuickSearch->clear();
+    m_labelsFilterModel->clearMatches();
+    m_valuesModel->clear();
+    m_labelsModel->clear();
+    ui->tableWidget_Diff->setRowCount(0);
+    m_labelIndex.clear();
+    m_addressIndex.clear();
+    m_scalars.clear();
+    m_image.clear();
+    m_violations.clear();
+    m_variants.clear();
+    m_variant.clear();
+    updateVariantsBox();
+    ui->groupBox_Labels->setTitle("Labels");
+
+    ui->groupBox_Labels->setEnabled(false);
+    ui->tabWidget->setEnabled(false);
+
+    m_a2lPath = a2lFileName;
+    m_hexPath = hexFileName;
+    m_loading = true;
+
+    ui->label_Progress->clear();
+    ui->progressBar->setValue(0);
+    ui->widget_Progress->show();
+
+    m_loadTimer.start();
+    m_loader->start(a2lFileName, hexFileName);
+
+    emit stateChanged();
+}
+
+void ProjectWidget::addSelectedLabels() {
+
+    const QVector<ptrdiff_t> inds = selectedLabels();
+
+    m_valuesModel->addScalars(inds);
+    m_labelsModel->setInTable(inds, true);
+
+    moveToNextLabel();
+    ui->tableView_Scalars->resizeColumnsToContents();
+}
+
+void ProjectWidget::removeSelectedLabels() {
+
+    const QVector<ptrdiff_t> inds = selectedLabels();
+
+    m_valuesModel->removeScalars(inds);
+    m_labelsModel->setInTable(inds, false);
+
+    moveToNextLabel();
+    ui->tableView_Scalars->resizeColumnsToContents();
+}
+
+ptrdiff_t ProjectWidget::currentLabel() const {
+
+    const QModelIndex curr = ui->tableView_Labels->currentIndex();
+
+    if ( !curr.isValid() ) {
+        return -1;
+    }
+
+    return m_labelsFilterModel->mapToSource(curr).row();
+}
+
+void ProjectWidget::focusSearchLine() {
+
+    ui->lineEdit_QuickSearch->setFocus();
+    ui->lineEdit_QuickSearch->selectAll();
+}
+
+void ProjectWidget::showDifferences(const QVector<ScalarChange> &changes, bool activate) {
+
+    ui->tableWidget_Diff->setRowCount(changes.size());
+
+    for ( ptrdiff_t i=0; i<changes.size(); i++ ) {
+
+        const QSharedPointer<ECUScalar> scal = m_scalars[changes[i].index];
+
+        ui->tableWidget_Diff->setItem(i, 0, new QTableWidgetItem(scal->name()));
+        ui->tableWidget_Diff->setItem(i, 1, new QTableWidgetItem(
+                                          changes[i].oldValid ?
+                                          ScalarCodec::toDisplayString(*scal, changes[i].oldValue) :
+                                          QString("-")));
+        ui->tableWidget_Diff->setItem(i, 2, new QTableWidgetItem(
+                                          changes[i].newValid ?
+                                          ScalarCodec::toDisplayString(*scal, changes[i].newValue) :
+                                          QString("-")));
+        ui->tableWidget_Diff->item(i, 2)->setTextColor(QColor(Qt::blue));
+        ui->tableWidget_Diff->setItem(i, 3, new QTableWidgetItem(scal->dimension()));
+    }
+
+    ui->tableWidget_Diff->resizeColumnsToContents();
+
+    if ( activate ) {
+        ui->tabWidget->setCurrentWidget(ui->tab_diff);
+    }
+}
+
+QString ProjectWidget::title() const {
+
+    if ( !m_hexPath.isEmpty() ) {
+        return QFileInfo(m_hexPath).fileName();
+    }
+
+    return QFileInfo(m_a2lPath).fileName();
+}
+
+void ProjectWidget::searchTemplChanged(QString templ) {
+
+    const ptrdiff_t mode = LabelIndex::queryMode(templ);
+
+    const QVector<ptrdiff_t> found = (mode == SEARCH_ADDRESS) ?
+                m_addressIndex.at(templ.mid(2).toUInt(0, 16)) :
+                m_labelIndex.search(templ);
+    m_labelsFilterModel->setMatches(found, mode == SEARCH_FUZZY);
+
+    ptrdiff_t curr = m_labelIndex.firstPrefixMatch(templ);
+
+    if ( curr < 0 && !found.isEmpty() ) {
+        curr = found.first();
+    }
+
+    if ( curr >= 0 ) {
+        ui->tableView_Labels->setCurrentIndex(
+                    m_labelsFilterModel->mapFromSource(m_labelsModel->index(curr, 0))
+                    );
+    }
+}
+
+void ProjectWidget::loadProgress(QString stage, qint64 done, qint64 total, qint64 objects) {
+
+    ui->label_Progress->setText(stage + ": " + QString::number(objects) + " objects");
+
+    if ( total > 0 ) {
+        ui->progressBar->setValue(int(done * 1000 / total));
+    }
+}
+
+void ProjectWidget::labelsLoaded() {
+
+    emit message(
+                QDateTime::currentDateTime().toString("[yyyy-MM-dd_hh-mm-ss]")
+                + " Parsing " + m_a2lPath + ": "
+                + QString::number(m_loadTimer.elapsed()) + " ms"
+                );
+
+    m_scalars = m_loader->scalars();
+
+    QTime timer;
+    timer.start();
+    showLabels();
+    emit message(
+                QDateTime::currentDateTime().toString("[yyyy-MM-dd_hh-mm-ss]")
+                + " Displaying labels: "
+                + QString::number(timer.elapsed()) + " ms"
+                );
+
+    ui->groupBox_Labels->setTitle("Labels (" + QString::number(m_scalars.size()) + ")");
+
+    restoreLabels();
+
+    if ( m_hexPath.isEmpty() ) {
+        loadingDone();
+        return;
+    }
+
+    // labels can be browsed while the hex file is read
+
+    m_loadTimer.restart();
+    ui->progressBar->setValue(0);
+    ui->groupBox_Labels->setEnabled(true);
+}
+
+void ProjectWidget::valuesLoaded() {
+
+    m_image = m_loader->image();
+    m_valuesModel->refresh();
+    resetVariants();
+
+    emit message(
+                QDateTime::currentDateTime().toString("[yyyy-MM-dd_hh-mm-ss]")
+                + " Reading " + m_hexPath + ": "
+                + QString::number(m_loadTimer.elapsed()) + " ms"
+                );
+
+    checkLimits();
+    loadingDone();
+}
+
+void ProjectWidget::loadFailed(QString message) {
+
+    QMessageBox::critical(this, QString(PROGNAME) + ": error", message);
+    loadingDone();
+}
+
+void ProjectWidget::loadCanceled() {
+
+    emit message(
+                QDateTime::currentDateTime().toString("[yyyy-MM-dd_hh-mm-ss]")
+                + " Loading of " + title() + " canceled"
+                );
+
+    loadingDone();
+}
+
+void ProjectWidget::fileChanged(QString path) {
+
+    if ( path == m_a2lPath ) {
+        m_a2lChanged = true;
+    }
+    else if ( path == m_hexPath ) {
+        m_hexChanged = true;
+    }
+
+    m_reloadTimer.start(); // restarts while the file keeps changing
+}
+
+void ProjectWidget::reloadChangedFiles() {
+
+    if ( m_loading || m_reloadWatcher.isRunning() ) {
+        m_reloadTimer.start();
+        return;
+    }
+
+    // flashing tools often replace the file, and the watcher forgets it
+
+    if ( (m_a2lChanged && !QFileInfo(m_a2lPath).exists()) ||
+         (m_hexChanged && !QFileInfo(m_hexPath).exists()) ) {
+        m_reloadTimer.start();
+        return;
+    }
+
+    watchFiles();
+
+    if ( m_a2lChanged ) {
+
+        emit message(
+                    QDateTime::currentDateTime().toString("[yyyy-MM-dd_hh-mm-ss]")
+                    + " " + m_a2lPath + " changed on disk, reloading the project"
+                    );
+
+        m_restoreLabels.clear();
+
+        for ( ptrdiff_t row=0; row<m_valuesModel->rowCount(); row++ ) {
+            m_restoreLabels.push_back(m_scalars[m_valuesModel->scalarIndex(row)]->name());
+        }
+
+        load(m_a2lPath, m_hexPath);
+
+        return;
+    }
+
+    if ( m_hexChanged ) {
+
+        m_hexChanged = false;
+        m_reloadElapsed.start();
+        m_reloadWatcher.setFuture(QtConcurrent::run(this, &ProjectWidget::readChangedHex));
+    }
+}
+
+void ProjectWidget::hexReloaded() {
+
+    if ( !m_reloadWatcher.result() ) {
+
+        emit message(
+                    QDateTime::currentDateTime().toString("[yyyy-MM-dd_hh-mm-ss]")
+                    + " Reloading " + m_hexPath + " failed, the previous image is kept"
+                    );
+
+        return;
+    }
+
+    m_image = m_reloadedImage;
+    m_reloadedImage.clear();
+
+    // edits of the variants stay on top of the new image
+
+    for ( QMap<QString, ImageOverlay>::iterator it = m_variants.begin(); it != m_variants.end(); ++it ) {
+        it.value().rebase(m_image);
+    }
+
+    const ImageOverlay current = m_variants.value(m_variant, ImageOverlay(m_image));
+    QVector<ptrdiff_t> changed(m_reloadChanges.size());
+
+    for ( ptrdiff_t i=0; i<m_reloadChanges.size(); i++ ) {
+
+        const ScalarChange &change = m_reloadChanges[i];
+        const QSharedPointer<ECUScalar> scal = m_scalars[change.index];
+        double val = 0;
+
+        changed[i] = change.index;
+
+        if ( ScalarCodec::decode(*scal, current, val) ) {
+            scal->setValue(ScalarCodec::toString(*scal, val));
+            scal->setPhysValue(val);
+        }
+        else {
+            scal->setValue(QString());
+            scal->setPhysValue(std::numeric_limits<double>::quiet_NaN());
+        }
+    }
+
+    m_valuesModel->setChanged(changed);
+    showDifferences(m_reloadChanges, false);
+
+    emit message(
+                QDateTime::currentDateTime().toString("[yyyy-MM-dd_hh-mm-ss]")
+                + " Reloading " + m_hexPath + ": "
+                + QString::number(m_reloadChanges.size()) + " labels changed, "
+                + QString::number(m_reloadElapsed.elapsed()) + " ms"
+                );
+
+    m_reloadChanges.clear();
+
+    checkLimits();
+}
+
+void ProjectWidget::valueEdited(ptrdiff_t ind, double val) {
+
+    if ( !m_variants.contains(m_variant) ) {
+        return;
+    }
+
+    const QSharedPointer<ECUScalar> scal = m_scalars[ind];
+
+    if ( scal->isReadOnly() ) { // as in DcmImport::apply()
+
+        emit message(
+                    QDateTime::currentDateTime().toString("[yyyy-MM-dd_hh-mm-ss]")
+                    + " Can not write " + scal->name() + ": read-only label"
+                    );
+
+        return;
+    }
+
+    ImageOverlay &overlay = m_variants[m_variant];
+    char data[sizeof(quint64)];
+
+    if ( !ScalarCodec::encode(*scal, val, data) ||
+         !overlay.write(scal->addressNum(), data, ScalarCodec::length(scal->numType())) ) {
+
+        emit message(
+                    QDateTime::currentDateTime().toString("[yyyy-MM-dd_hh-mm-ss]")
+                    + " Can not write " + scal->name() + " to the image"
+                    );
+    }
+
+    // show what is stored: the raw value is rounded and saturated
+
+    double stored = 0;
+
+    if ( ScalarCodec::decode(*scal, overlay, stored) ) {
+        scal->setValue(ScalarCodec::toString(*scal, stored));
+        scal->setPhysValue(stored);
+    }
+    else {
+        scal->setValue(QString());
+        scal->setPhysValue(std::numeric_limits<double>::quiet_NaN());
+    }
+
+    m_valuesModel->refresh();
+
+    emit stateChanged();
+}
+
+void ProjectWidget::variantActivated(QString name) {
+
+    if ( name == m_variant || !m_variants.contains(name) ) {
+        return;
+    }
+
+    m_variant = name;
+    decodeVariant();
+
+    emit stateChanged();
+}
+
+QVector<ptrdiff_t> ProjectWidget::selectedLabels() const {
+
+    const QModelIndexList selected = ui->tableView_Labels->selectionModel()->selectedRows();
+    QVector<ptrdiff_t> inds(selected.size());
+
+    for ( ptrdiff_t n=0; n<selected.size(); n++ ) {
+        inds[n] = m_labelsFilterModel->mapToSource(selected[n]).row();
+    }
+
+    return inds;
+}
+
+void ProjectWidget::moveToNextLabel() {
+
+    const QModelIndex curr = ui->tableView_Labels->currentIndex();
+
+    if ( curr.isValid() && curr.row() != (m_labelsFilterModel->rowCount()-1) ) {
+        ui->tableView_Labels->setCurrentIndex(m_labelsFilterModel->index(curr.row()+1, 0));
+    }
+}
+
+void ProjectWidget::loadingDone() {
+
+    m_loading = false;
+    m_restoreLabels.clear();
+
+    if ( !m_scalars.isEmpty() ) {
+        watchFiles();
+    }
+
+    ui->widget_Progress->hide();
+    ui->groupBox_Labels->setEnabled(true);
+    ui->tabWidget->setEnabled(true);
+
+    emit stateChanged();
+}
+
+void ProjectWidget::showLabels() {
+
+    TraceScope trace("display.labels");
+
+    m_labelsModel->setScalars(m_scalars);
+    m_valuesModel->setScalars(m_scalars);
+    m_labelsFilterModel->clearMatches();
+
+    m_labelIndex.build(m_scalars);
+    m_addressIndex.build(m_scalars);
+}
+
+void ProjectWidget::restoreLabels() {
+
+    if ( m_restoreLabels.isEmpty() ) {
+        return;
+    }
+
+    QHash<QString, ptrdiff_t> byName;
+    byName.reserve(m_scalars.size());
+
+    for ( ptrdiff_t i=0; i<m_scalars.size(); i++ ) {
+        byName.insert(m_scalars[i]->name(), i);
+    }
+
+    QVector<ptrdiff_t> inds;
+    inds.reserve(m_restoreLabels.size());
+
+    for ( ptrdiff_t n=0; n<m_restoreLabels.size(); n++ ) {
+
+        const QHash<QString, ptrdiff_t>::const_iterator it = byName.constFind(m_restoreLabels[n]);
+
+        if ( it != byName.constEnd() ) {
+            inds.push_back(it.value());
+        }
+    }
+
+    m_restoreLabels.clear();
+
+    m_valuesModel->addScalars(inds);
+    m_labelsModel->setInTable(inds, true);
+    ui->tableView_Scalars->resizeColumnsToContents();
+}
+
+void ProjectWidget::checkLimits() {
+
+    QTime timer;
+    timer.start();
+
+    const LimitCheck limitCheck(m_scalars);
+    m_violations = limitCheck.check();
+
+    ptrdiff_t hardNum = 0;
+
+    for ( ptrdiff_t i=0; i<m_violations.size(); i++ ) {
+
+        if ( m_violations[i].severity == LIMIT_HARD ) {
+            hardNum++;
+        }
+    }
+
+    emit message(
+                QDateTime::currentDateTime().toString("[yyyy-MM-dd_hh-mm-ss]")
+                + " Checking limits of " + title() + ": "
+                + QString::number(hardNum) + " hard, "
+                + QString::number(m_violations.size() - hardNum) + " soft violations, "
+                + QString::number(timer.elapsed()) + " ms"
+                );
+
+    for ( ptrdiff_t i=0; i<m_violations.size() && i<LOGMAXVIOLATIONS; i++ ) {
+
+        const QSharedPointer<ECUScalar> scal = m_scalars[m_violations[i].index];
+        const bool hard = m_violations[i].severity == LIMIT_HARD;
+
+        emit message(
+                    QString(hard ? "    [hard] " : "    [soft] ")
+                    + scal->name() + " = " + scal->value() + " "
+                    + scal->dimension() + ", limits "
+                    + QString::number(hard ? scal->minValueHard() : scal->minValueSoft()) + " .. "
+                    + QString::number(hard ? scal->maxValueHard() : scal->maxValueSoft())
+                    );
+    }
+
+    if ( m_violations.size() > LOGMAXVIOLATIONS ) {
+        emit message(
+                    "    ... " + QString::number(m_violations.size() - LOGMAXVIOLATIONS)
+                    + " more in the limits report"
+                    );
+    }
+}
+
+void ProjectWidget::watchFiles() {
+
+    QStringList paths;
+    paths << m_a2lPath;
+
+    if ( !m_hexPath.isEmpty() ) {
+        paths << m_hexPath;
+    }
+
+    const QStringList watched = m_fileWatcher->files();
+
+    for ( ptrdiff_t n=0; n<paths.size(); n++ ) {
+
+        if ( !watched.contains(paths[n]) && QFileInfo(paths[n]).exists() ) {
+            m_fileWatcher->addPath(paths[n]);
+        }
+    }
+}
+
+bool ProjectWidget::readChangedHex() { // runs on the thread pool
+
+    bool ok = false;
+    m_reloadedImage = IntelHEX::load(m_hexPath, &ok);
+
+    if ( !ok ) {
+        return false;
+    }
+
+    // only the labels whose bytes differ are decoded again
+
+    m_reloadChanges = ImageDiff::changedScalars(m_image, m_reloadedImage, m_scalars, m_addressIndex);
+
+    return true;
+}
+
+QStringList ProjectWidget::variants() const {
+    return m_variants.keys();
+}
+
+void ProjectWidget::addVariant(const QString &name) {
+
+    if ( name.isEmpty() || m_variants.contains(name) || !m_variants.contains(m_variant) ) {
+        return;
+    }
+
+    m_variants.insert(name, m_variants.value(m_variant)); // shares the pages until written
+    m_variant = name;
+    updateVariantsBox();
+
+    emit stateChanged();
+}
+
+void ProjectWidget::removeVariant() {
+
+    if ( m_variants.size() < 2 ) {
+        return;
+    }
+
+    m_variants.remove(m_variant);
+    m_variant = m_variants.firstKey();
+    updateVariantsBox();
+    decodeVariant();
+
+    emit stateChanged();
+}
+
+bool ProjectWidget::saveVariant(const QString &path) const {
+
+    if ( !m_variants.contains(m_variant) ) {
+        return false;
+    }
+
+    MemoryImage image = m_variants.value(m_variant).flatten();
+
+    for ( ptrdiff_t i=0; i<m_checksums.size(); i++ ) {
+
+        if ( !m_checksums[i].update(image) ) {
+            return false;
+        }
+    }
+
+    return IntelHEX::writeHex(path, image);
+}
+
+void ProjectWidget::setChecksums(const QVector<Checksum> &checksums) {
+    m_checksums = checksums;
+}
+
+ptrdiff_t ProjectWidget::applyDcm(const DcmImport &dcm, QStringList &failed) {
+
+    if ( !m_variants.contains(m_variant) ) {
+        return 0;
+    }
+
+    const ptrdiff_t written = dcm.apply(m_variants[m_variant], failed);
+    decodeVariant();
+
+    emit stateChanged();
+
+    return written;
+}
+
+bool ProjectWidget::isModified() const {
+    return m_variants.value(m_variant).isModified();
+}
+
+MemoryImage ProjectWidget::variantImage() const {
+
+    if ( !m_variants.contains(m_variant) ) {
+        return m_image;
+    }
+
+    return m_variants.value(m_variant).flatten();
+}
+
+void ProjectWidget::resetVariants() {
+
+    m_variants.clear();
+    m_variants.insert(DEFAULTVARIANT, ImageOverlay(m_image));
+    m_variant = DEFAULTVARIANT;
+
+    updateVariantsBox();
+}
+
+void ProjectWidget::decodeVariant() {
+
+    const ImageOverlay overlay = m_variants.value(m_variant);
+    double val = 0;
+
+    for ( ptrdiff_t i=0; i<m_scalars.size(); i++ ) {
+
+        if ( ScalarCodec::decode(*m_scalars[i], overlay, val) ) {
+            m_scalars[i]->setValue(ScalarCodec::toString(*m_scalars[i], val));
+            m_scalars[i]->setPhysValue(val);
+        }
+        else {
+            m_scalars[i]->setValue(QString());
+            m_scalars[i]->setPhysValue(std::numeric_limits<double>::quiet_NaN());
+        }
+    }
+
+    m_valuesModel->refresh();
+    checkLimits();
+}
+
+void ProjectWidget::updateVariantsBox() {
+
+    ui->comboBox_Variant->blockSignals(true);
+    ui->comboBox_Variant->clear();
+    ui->comboBox_Variant->addItems(m_variants.keys());
+    ui->comboBox_Variant->setCurrentIndex(ui->comboBox_Variant->findText(m_variant));
+    ui->comboBox_Variant->blockSignals(false);
+
+    ui->comboBox_Variant->setEnabled(!m_variants.isEmpty());
+}
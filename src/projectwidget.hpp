@@ -0,0 +1,183 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: projectwidget.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROJECTWIDGET_HPP
+#define PROJECTWIDGET_HPP
+
+#include <QWidget>
+#include <QString>
+#include <QVector>
+#include <QSharedPointer>
+#include <QStringList>
+#include <QMap>
+#include <QTime>
+#include <QTimer>
+#include <QFileSystemWatcher>
+#include <QFutureWatcher>
+
+#include "ecuscalar.hpp"
+#include "memoryimage.hpp"
+#include "imageoverlay.hpp"
+#include "imagediff.hpp"
+#include "limitcheck.hpp"
+#include "labelindex.hpp"
+#include "addressindex.hpp"
+#include "labelsmodel.hpp"
+#include "labelsfiltermodel.hpp"
+#include "valuesmodel.hpp"
+#include "projectloader.hpp"
+#include "dcmimport.hpp"
+#include "checksum.hpp"
+
+namespace Ui {
+class ProjectWidget;
+}
+
+// One open project (a2l file and optional hex file) in a main window tab.
+// Every project has its own loader, so several projects load at once.
+// The files are watched: a changed hex file is diffed against the current
+// image and only the affected labels are decoded again, a changed a2l
+// file reloads the project and keeps the values table selection.
+// Edited values go to the current variant, a copy-on-write overlay of
+// the hex image; several variants can be kept and switched. Checksums
+// of the image are updated when a variant is saved.
+
+class ProjectWidget : public QWidget {
+
+    Q_OBJECT
+
+public:
+    explicit ProjectWidget(QWidget *parent = 0);
+    ~ProjectWidget();
+    void load(const QString &, const QString &); // a2l path, hex path (may be empty)
+    void addSelectedLabels();
+    void removeSelectedLabels();
+    ptrdiff_t currentLabel() const; // -1 if there is no current label
+    void focusSearchLine();
+    void showDifferences(const QVector<ScalarChange> &, bool activate = true);
+    QString title() const;
+
+    QStringList variants() const;
+    void addVariant(const QString &); // copy of the current variant, becomes current
+    void removeVariant();             // removes the current variant unless it is the last
+    bool saveVariant(const QString &) const; // current variant as hex file, checksums updated
+    ptrdiff_t applyDcm(const DcmImport &, QStringList &); // into the current variant; failed labels
+    bool isModified() const;
+    MemoryImage variantImage() const; // current variant with the edits applied
+    void setChecksums(const QVector<Checksum> &); // updated in the order given
+
+    bool isLoading() const {
+        return m_loading;
+    }
+    QString a2lPath() const {
+        return m_a2lPath;
+    }
+    QString hexPath() const {
+        return m_hexPath;
+    }
+    const QVector< QSharedPointer<ECUScalar> > &scalars() const {
+        return m_scalars;
+    }
+    const MemoryImage &image() const {
+        return m_image;
+    }
+    const AddressIndex &addressIndex() const {
+        return m_addressIndex;
+    }
+    const QVector<LimitViolation> &violations() const {
+        return m_violations;
+    }
+    QString currentVariant() const {
+        return m_variant;
+    }
+    const QVector<Checksum> &checksums() const {
+        return m_checksums;
+    }
+
+signals:
+    void message(QString); // line for the log
+    void stateChanged();
+
+private slots:
+    void searchTemplChanged(QString);
+
+    void loadProgress(QString, qint64, qint64, qint64);
+    void labelsLoaded();
+    void valuesLoaded();
+    void loadFailed(QString);
+    void loadCanceled();
+
+    void fileChanged(QString);
+    void reloadChangedFiles();
+    void hexReloaded();
+
+    void valueEdited(ptrdiff_t, double);
+    void variantActivated(QString);
+
+private:
+    Ui::ProjectWidget *ui;
+
+    LabelsModel *m_labelsModel;
+    LabelsFilterModel *m_labelsFilterModel;
+    ValuesModel *m_valuesModel;
+    ProjectLoader *m_loader;
+
+    QString m_a2lPath;
+    QString m_hexPath;
+    QVector< QSharedPointer<ECUScalar> > m_scalars;
+    MemoryImage m_image;
+    QVector<LimitViolation> m_violations;
+    LabelIndex m_labelIndex;
+    AddressIndex m_addressIndex;
+    bool m_loading = false;
+    QTime m_loadTimer;
+
+    QFileSystemWatcher *m_fileWatcher;
+    QTimer m_reloadTimer;
+    QFutureWatcher<bool> m_reloadWatcher;
+    bool m_a2lChanged = false;
+    bool m_hexChanged = false;
+    MemoryImage m_reloadedImage;
+    QVector<ScalarChange> m_reloadChanges;
+    QStringList m_restoreLabels; // values table contents to restore after a reload
+    QTime m_reloadElapsed;
+
+    QMap<QString, ImageOverlay> m_variants;
+    QString m_variant;
+    QVector<Checksum> m_checksums;
+
+    QVector<ptrdiff_t> selectedLabels() const;
+    void moveToNextLabel();
+
+    void loadingDone();
+    void showLabels();
+    void restoreLabels();
+    void checkLimits();
+
+    void watchFiles();
+    bool readChangedHex();
+
+    void resetVariants();
+    void decodeVariant();
+    void updateVariantsBox();
+
+};
+
+#endif // PROJECTWIDGET_HPP
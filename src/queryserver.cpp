@@ -0,0 +1,477 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: queryserver.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "queryserver.hpp"
+#include "constants.hpp"
+#include "a2lcache.hpp"
+#include "intelhex.hpp"
+#include "scalarcodec.hpp"
+#include "imagediff.hpp"
+
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QFileInfo>
+#include <QtEndian>
+
+#include <limits>
+#include <cmath>
+
+static QString readString(QDataStream &in) {
+
+    quint16 len = 0;
+    in >> len;
+
+    QByteArray str(len, '\0');
+
+    if ( in.readRawData(str.data(), len) != len ) {
+        in.setStatus(QDataStream::ReadPastEnd);
+        return QString();
+    }
+
+    return QString::fromUtf8(str);
+}
+
+static QString canonicalPath(const QString &path) {
+
+    if ( path.isEmpty() ) {
+        return path;
+    }
+
+    return QFileInfo(path).canonicalFilePath();
+}
+
+QueryServer::QueryServer(QObject *parent) :
+    QObject(parent),
+    m_server(new QLocalServer(this)) {
+
+    connect(m_server, SIGNAL(newConnection()), this, SLOT(newConnection()));
+}
+
+QueryServer::~QueryServer() {
+}
+
+bool QueryServer::listen(const QString &name) {
+
+    QLocalServer::removeServer(name); // left over from a crashed daemon
+
+    m_server->setSocketOptions(QLocalServer::UserAccessOption);
+
+    return m_server->listen(name);
+}
+
+QString QueryServer::errorString() const {
+    return m_server->errorString();
+}
+
+void QueryServer::newConnection() {
+
+    while ( m_server->hasPendingConnections() ) {
+
+        QLocalSocket *socket = m_server->nextPendingConnection();
+
+        m_buffers.insert(socket, QByteArray());
+
+        connect(socket, SIGNAL(readyRead()), this, SLOT(readRequests()));
+        connect(socket, SIGNAL(disconnected()), this, SLOT(clientDisconnected()));
+    }
+}
+
+void QueryServer::readRequests() {
+
+    QLocalSocket *socket = qobject_cast<QLocalSocket *>(sender());
+
+    if ( !socket ) {
+        return;
+    }
+
+    QByteArray &buffer = m_buffers[socket];
+    buffer.append(socket->readAll());
+
+    ptrdiff_t pos = 0;
+
+    while ( buffer.size() - pos >= 4 ) {
+
+        const quint32 len = qFromLittleEndian<quint32>(reinterpret_cast<const uchar *>(buffer.constData() + pos));
+
+        if ( len > QUERYMAXFRAME ) {
+
+            emit message("Request of " + QString::number(len) + " bytes rejected, connection closed.");
+
+            buffer.clear();
+            socket->abort();
+
+            return;
+        }
+
+        if ( quint64(buffer.size() - pos - 4) < len ) {
+            break;
+        }
+
+        const QByteArray reply = process(QByteArray::fromRawData(buffer.constData() + pos + 4, len));
+        pos += 4 + len;
+
+        uchar size[4];
+        qToLittleEndian<quint32>(reply.size(), size);
+
+        socket->write(reinterpret_cast<const char *>(size), 4);
+        socket->write(reply);
+    }
+
+    buffer.remove(0, pos);
+}
+
+void QueryServer::clientDisconnected() {
+
+    QLocalSocket *socket = qobject_cast<QLocalSocket *>(sender());
+
+    if ( !socket ) {
+        return;
+    }
+
+    m_buffers.remove(socket);
+    socket->deleteLater();
+}
+
+QByteArray QueryServer::process(const QByteArray &request) {
+
+    QDataStream in(request);
+    in.setByteOrder(QDataStream::LittleEndian);
+    in.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    QByteArray body;
+    QDataStream out(&body, QIODevice::WriteOnly);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out.setFloatingPointPrecision(QDataStream::DoublePrecision);
+
+    quint8 code = 0;
+    in >> code;
+
+    quint8 status = QUERYSTATUS_BADREQUEST;
+
+    if ( code == QUERY_OPEN ) {
+        status = open(in, out);
+    }
+    else if ( code == QUERY_CLOSE ) {
+        status = close(in);
+    }
+    else if ( code == QUERY_LOOKUP ) {
+        status = lookup(in, out);
+    }
+    else if ( code == QUERY_READ ) {
+        status = read(in, out);
+    }
+    else if ( code == QUERY_DIFF ) {
+        status = diff(in, out);
+    }
+    else if ( code == QUERY_RELOAD ) {
+        status = reload(in);
+    }
+    else if ( code == QUERY_ADDRESS ) {
+        status = address(in, out);
+    }
+
+    if ( in.status() != QDataStream::Ok ) {
+        status = QUERYSTATUS_BADREQUEST;
+    }
+
+    QByteArray reply(1, char(status));
+
+    if ( status == QUERYSTATUS_OK ) {
+        reply.append(body);
+    }
+
+    return reply;
+}
+
+quint8 QueryServer::open(QDataStream &in, QDataStream &out) {
+
+    const QString a2lPath = readString(in);
+    const QString hexPath = readString(in);
+
+    if ( in.status() != QDataStream::Ok ) {
+        return QUERYSTATUS_BADREQUEST;
+    }
+
+    const QString a2lKey = canonicalPath(a2lPath);
+    const QString hexKey = canonicalPath(hexPath);
+
+    if ( a2lKey.isEmpty() ) {
+        return QUERYSTATUS_A2L;
+    }
+
+    if ( !hexPath.isEmpty() && hexKey.isEmpty() ) {
+        return QUERYSTATUS_HEX;
+    }
+
+    const QString key = a2lKey + '\n' + hexKey;
+
+    if ( m_projectIds.contains(key) ) {
+
+        const quint32 id = m_projectIds[key];
+
+        out << id << quint32(m_projects[id]->scalars.size());
+
+        return QUERYSTATUS_OK;
+    }
+
+    QSharedPointer<Project> proj(new Project);
+    proj->a2lPath = a2lKey;
+
+    bool ok = false;
+    proj->scalars = A2LCache::instance().scalars(a2lKey, &ok);
+
+    if ( !ok ) {
+        emit message("Error occured during parsing of " + a2lKey + "!");
+        return QUERYSTATUS_A2L;
+    }
+
+    proj->indexOf.reserve(proj->scalars.size());
+
+    for ( ptrdiff_t i=0; i<proj->scalars.size(); i++ ) {
+        proj->indexOf.insert(proj->scalars[i]->name(), i);
+    }
+
+    proj->addresses.build(proj->scalars);
+
+    proj->values.fill(std::numeric_limits<double>::quiet_NaN(), proj->scalars.size());
+
+    if ( !hexKey.isEmpty() && !readHex(*proj, hexKey) ) {
+        emit message("Error occured during reading of " + hexKey + "!");
+        return QUERYSTATUS_HEX;
+    }
+
+    const quint32 id = m_nextId++;
+
+    m_projects.insert(id, proj);
+    m_projectIds.insert(key, id);
+
+    emit message("Project " + QString::number(id) + " opened: " + a2lKey +
+                 (hexKey.isEmpty() ? QString() : ", " + hexKey));
+
+    out << id << quint32(proj->scalars.size());
+
+    return QUERYSTATUS_OK;
+}
+
+quint8 QueryServer::close(QDataStream &in) {
+
+    quint32 id = 0;
+    in >> id;
+
+    const QSharedPointer<Project> proj = m_projects.take(id);
+
+    if ( !proj ) {
+        return QUERYSTATUS_UNKNOWNPROJECT;
+    }
+
+    m_projectIds.remove(proj->a2lPath + '\n' + proj->hexPath);
+
+    emit message("Project " + QString::number(id) + " closed.");
+
+    return QUERYSTATUS_OK;
+}
+
+quint8 QueryServer::lookup(QDataStream &in, QDataStream &out) {
+
+    const QSharedPointer<Project> proj = project(in);
+
+    if ( !proj ) {
+        return QUERYSTATUS_UNKNOWNPROJECT;
+    }
+
+    quint32 n = 0;
+    in >> n;
+
+    if ( in.status() != QDataStream::Ok ) {
+        return QUERYSTATUS_BADREQUEST;
+    }
+
+    out << n;
+
+    for ( quint32 i=0; i<n && in.status() == QDataStream::Ok; i++ ) {
+        out << qint32(proj->indexOf.value(readString(in), -1));
+    }
+
+    return QUERYSTATUS_OK;
+}
+
+quint8 QueryServer::read(QDataStream &in, QDataStream &out) {
+
+    const QSharedPointer<Project> proj = project(in);
+
+    if ( !proj ) {
+        return QUERYSTATUS_UNKNOWNPROJECT;
+    }
+
+    quint32 n = 0;
+    in >> n;
+
+    if ( in.status() != QDataStream::Ok ) {
+        return QUERYSTATUS_BADREQUEST;
+    }
+
+    out << n;
+
+    for ( quint32 i=0; i<n && in.status() == QDataStream::Ok; i++ ) {
+
+        quint32 ind = 0;
+        in >> ind;
+
+        if ( ind >= quint32(proj->values.size()) ) {
+            out << quint8(QUERYVALUE_BADINDEX) << std::numeric_limits<double>::quiet_NaN();
+        }
+        else if ( std::isnan(proj->values[ind]) ) {
+            out << quint8(QUERYVALUE_NODATA) << proj->values[ind];
+        }
+        else {
+            out << quint8(QUERYVALUE_OK) << proj->values[ind];
+        }
+    }
+
+    return QUERYSTATUS_OK;
+}
+
+quint8 QueryServer::diff(QDataStream &in, QDataStream &out) {
+
+    const QSharedPointer<Project> proj = project(in);
+
+    if ( !proj ) {
+        return QUERYSTATUS_UNKNOWNPROJECT;
+    }
+
+    const QString hexPath = readString(in);
+
+    if ( in.status() != QDataStream::Ok ) {
+        return QUERYSTATUS_BADREQUEST;
+    }
+
+    bool ok = false;
+    const MemoryImage image = IntelHEX::load(hexPath, &ok);
+
+    if ( !ok ) {
+        return QUERYSTATUS_HEX;
+    }
+
+    const QVector<ScalarChange> changes = ImageDiff::changedScalars(proj->image, image, proj->scalars, proj->addresses);
+
+    out << quint32(changes.size());
+
+    for ( ptrdiff_t i=0; i<changes.size(); i++ ) {
+        out << quint32(changes[i].index)
+            << quint8(changes[i].oldValid) << quint8(changes[i].newValid)
+            << changes[i].oldValue << changes[i].newValue;
+    }
+
+    return QUERYSTATUS_OK;
+}
+
+quint8 QueryServer::reload(QDataStream &in) {
+
+    quint32 id = 0;
+    in >> id;
+
+    const QString hexPath = readString(in);
+
+    if ( in.status() != QDataStream::Ok ) {
+        return QUERYSTATUS_BADREQUEST;
+    }
+
+    const QSharedPointer<Project> proj = m_projects.value(id);
+
+    if ( !proj ) {
+        return QUERYSTATUS_UNKNOWNPROJECT;
+    }
+
+    const QString hexKey = canonicalPath(hexPath.isEmpty() ? proj->hexPath : hexPath);
+    const QString oldKey = proj->a2lPath + '\n' + proj->hexPath;
+    const QString newKey = proj->a2lPath + '\n' + hexKey;
+
+    if ( m_projectIds.value(newKey, id) != id ) { // would take the key of another project
+        return QUERYSTATUS_DUPLICATE;
+    }
+
+    if ( hexKey.isEmpty() || !readHex(*proj, hexKey) ) {
+        return QUERYSTATUS_HEX;
+    }
+
+    m_projectIds.remove(oldKey);
+    m_projectIds.insert(newKey, id);
+
+    emit message("Project " + QString::number(id) + " reloaded: " + hexKey);
+
+    return QUERYSTATUS_OK;
+}
+
+quint8 QueryServer::address(QDataStream &in, QDataStream &out) {
+
+    const QSharedPointer<Project> proj = project(in);
+
+    if ( !proj ) {
+        return QUERYSTATUS_UNKNOWNPROJECT;
+    }
+
+    quint32 addr = 0;
+    quint32 len = 0;
+    in >> addr >> len;
+
+    if ( in.status() != QDataStream::Ok ) {
+        return QUERYSTATUS_BADREQUEST;
+    }
+
+    const QVector<ptrdiff_t> owners = proj->addresses.overlapping(addr, quint64(addr) + (len ? len : 1));
+
+    out << quint32(owners.size());
+
+    for ( ptrdiff_t i=0; i<owners.size(); i++ ) {
+        out << quint32(owners[i]);
+    }
+
+    return QUERYSTATUS_OK;
+}
+
+QSharedPointer<QueryServer::Project> QueryServer::project(QDataStream &in) const {
+
+    quint32 id = 0;
+    in >> id;
+
+    return m_projects.value(id);
+}
+
+bool QueryServer::readHex(Project &proj, const QString &path) const {
+
+    bool ok = false;
+    MemoryImage image = IntelHEX::load(path, &ok);
+
+    if ( !ok ) {
+        return false;
+    }
+
+    for ( ptrdiff_t i=0; i<proj.scalars.size(); i++ ) {
+
+        if ( !ScalarCodec::decode(*proj.scalars[i], image, proj.values[i]) ) {
+            proj.values[i] = std::numeric_limits<double>::quiet_NaN();
+        }
+    }
+
+    proj.image = image;
+    proj.hexPath = path;
+
+    return true;
+}
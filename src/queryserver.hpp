@@ -0,0 +1,111 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: queryserver.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef QUERYSERVER_HPP
+#define QUERYSERVER_HPP
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QDataStream>
+
+#include "ecuscalar.hpp"
+#include "memoryimage.hpp"
+#include "addressindex.hpp"
+
+class QLocalServer;
+class QLocalSocket;
+
+// Keeps projects loaded and answers queries over a local socket.
+//
+// Every message is a little-endian frame: u32 payload size, payload.
+// A request payload starts with an u8 request code (QUERY_*), a reply
+// payload with an u8 status (QUERYSTATUS_*); the rest is only present
+// for QUERYSTATUS_OK. Strings are u16 length + UTF-8 bytes, values are
+// IEEE 754 doubles.
+//
+//   QUERY_OPEN    str a2l, str hex (may be empty) -> u32 project, u32 labels
+//   QUERY_CLOSE   u32 project                     -> nothing
+//   QUERY_LOOKUP  u32 project, u32 n, n * str     -> u32 n, n * i32 index (-1 if unknown)
+//   QUERY_READ    u32 project, u32 n, n * u32     -> u32 n, n * (u8 QUERYVALUE_*, f64)
+//   QUERY_DIFF    u32 project, str hex            -> u32 n, n * (u32 index, u8 old valid,
+//                                                    u8 new valid, f64 old, f64 new)
+//   QUERY_RELOAD  u32 project, str hex (empty for the current file) -> nothing
+//   QUERY_ADDRESS u32 project, u32 address, u32 length -> u32 n, n * u32 index
+//                 (labels overlapping the range, by address)
+//
+// Opening the same a2l/hex pair again returns the already loaded project,
+// so all clients share it; QUERY_CLOSE unloads it for everyone. Reloading
+// a project with a hex file that another project of the same a2l file
+// has open is refused with QUERYSTATUS_DUPLICATE.
+
+class QueryServer : public QObject {
+
+    Q_OBJECT
+
+public:
+    explicit QueryServer(QObject *parent = 0);
+    ~QueryServer();
+    bool listen(const QString &);
+    QString errorString() const;
+
+signals:
+    void message(QString);
+
+private slots:
+    void newConnection();
+    void readRequests();
+    void clientDisconnected();
+
+private:
+    struct Project {
+        QString a2lPath;
+        QString hexPath;
+        QVector< QSharedPointer<ECUScalar> > scalars;
+        QHash<QString, ptrdiff_t> indexOf;
+        AddressIndex addresses;
+        MemoryImage image;
+        QVector<double> values; // NaN if there is no data
+    };
+
+    QLocalServer *m_server;
+    QHash<QLocalSocket *, QByteArray> m_buffers;
+    QHash< quint32, QSharedPointer<Project> > m_projects;
+    QHash<QString, quint32> m_projectIds; // a2l and hex path -> project
+    quint32 m_nextId = 1;
+
+    QByteArray process(const QByteArray &);
+    quint8 open(QDataStream &, QDataStream &);
+    quint8 close(QDataStream &);
+    quint8 lookup(QDataStream &, QDataStream &);
+    quint8 read(QDataStream &, QDataStream &);
+    quint8 diff(QDataStream &, QDataStream &);
+    quint8 reload(QDataStream &);
+    quint8 address(QDataStream &, QDataStream &);
+
+    QSharedPointer<Project> project(QDataStream &) const;
+    bool readHex(Project &, const QString &) const;
+
+};
+
+#endif // QUERYSERVER_HPP
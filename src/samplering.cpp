@@ -0,0 +1,62 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: samplering.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "samplering.hpp"
+
+SampleRing::SampleRing(quint32 capacity) :
+    m_buf(int(capacity)),
+    m_mask(capacity - 1),
+    m_head(0),
+    m_tail(0),
+    m_dropped(0) {
+
+    Q_ASSERT( capacity > 0 && (capacity & (capacity - 1)) == 0 );
+}
+
+bool SampleRing::push(const Sample &sample) {
+
+    const quint32 head = m_head.loadAcquire(); // only this thread writes it
+    const quint32 tail = m_tail.loadAcquire();
+
+    if ( head - tail > m_mask ) {
+        m_dropped.fetchAndAddRelaxed(1);
+        return false;
+    }
+
+    m_buf[int(head & m_mask)] = sample;
+    m_head.storeRelease(head + 1); // publishes the sample
+
+    return true;
+}
+
+ptrdiff_t SampleRing::pop(QVector<Sample> &out) {
+
+    const quint32 tail = m_tail.loadAcquire(); // only this thread writes it
+    const quint32 head = m_head.loadAcquire();
+    const quint32 count = head - tail;
+
+    for ( quint32 i=0; i<count; i++ ) {
+        out.push_back(m_buf.at(int((tail + i) & m_mask)));
+    }
+
+    m_tail.storeRelease(head); // frees the slots
+
+    return count;
+}
@@ -0,0 +1,61 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: samplering.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SAMPLERING_HPP
+#define SAMPLERING_HPP
+
+#include <QVector>
+#include <QAtomicInteger>
+
+struct Sample {
+    qint64 time; // ms since the start of the measurement
+    double value;
+};
+
+// Fixed size single-producer/single-consumer queue of samples. push() is
+// called only from the acquisition thread and pop() only from the GUI
+// thread; neither locks nor allocates. A full ring drops the new sample.
+
+class SampleRing {
+
+public:
+    explicit SampleRing(quint32); // capacity, power of 2
+    bool push(const Sample &);    // false if full
+    ptrdiff_t pop(QVector<Sample> &); // appends everything available, returns the count
+
+    quint32 capacity() const {
+        return m_mask + 1;
+    }
+    qint64 dropped() const {
+        return m_dropped.loadAcquire();
+    }
+
+private:
+    QVector<Sample> m_buf;
+    const quint32 m_mask;
+    QAtomicInteger<quint32> m_head; // next write, free running
+    QAtomicInteger<quint32> m_tail; // next read, free running
+    QAtomicInteger<qint64> m_dropped;
+
+    Q_DISABLE_COPY(SampleRing)
+
+};
+
+#endif // SAMPLERING_HPP
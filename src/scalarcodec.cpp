@@ -0,0 +1,220 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: scalarcodec.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "scalarcodec.hpp"
+#include "constants.hpp"
+
+#include <QString>
+#include <QVector>
+#include <QStringList>
+
+#include <cstring>
+#include <cmath>
+#include <limits>
+
+size_t ScalarCodec::length(const QString &type) {
+
+    if ( type.size() == 3 ) {
+        return type.right(1).toUInt() / 8;
+    }
+    else if ( type.size() == 4 ) {
+        return type.right(2).toUInt() / 8;
+    }
+
+    return 0;
+}
+
+bool ScalarCodec::decode(const ECUScalar &scalar, const char *data, double &val) {
+
+    const QString numtype = scalar.numType();
+    const size_t len = length(numtype);
+
+    if ( len == 0 || len > sizeof(quint64) ) {
+        return false;
+    }
+
+    quint64 rawVal = 0;
+
+    for ( size_t i=0; i<len; i++ ) {
+        rawVal = (rawVal << 8) | quint8(data[i]);
+    }
+
+    if ( scalar.type() == VARTYPE_SCALAR_VTAB ) {
+        val = static_cast<double>(rawVal);
+        return true;
+    }
+
+    double preVal = 0;
+
+    if ( numtype == "Ws8" ) {
+        preVal = static_cast<double>(qint8(rawVal));
+    }
+    else if ( numtype == "Ws16" ) {
+        preVal = static_cast<double>(qint16(rawVal));
+    }
+    else if ( numtype == "Ws32" ) {
+        preVal = static_cast<double>(qint32(rawVal));
+    }
+    else if ( numtype == "Ws64" ) {
+        preVal = static_cast<double>(qint64(rawVal));
+    }
+    else if ( numtype == "Wr32" ) {
+
+        const quint32 bits = quint32(rawVal);
+        float f = 0;
+        memcpy(&f, &bits, sizeof(f));
+        preVal = static_cast<double>(f);
+    }
+    else if ( numtype == "Wr64" ) {
+        memcpy(&preVal, &rawVal, sizeof(preVal));
+    }
+    else {
+        preVal = static_cast<double>(rawVal);
+    }
+
+    const QVector<double> coeff = scalar.coefficients();
+
+    if ( coeff.size() != A2LCOEFFNUM ) {
+        val = preVal;
+        return true;
+    }
+
+    val = (coeff[5] * preVal - coeff[2]) / (coeff[1] - coeff[4] * preVal);
+
+    return true;
+}
+
+bool ScalarCodec::decode(const ECUScalar &scalar, const MemoryImage &image, double &val) {
+
+    const char *data = image.constData(scalar.addressNum(), length(scalar.numType()));
+
+    if ( !data ) {
+        return false;
+    }
+
+    return decode(scalar, data, val);
+}
+
+bool ScalarCodec::decode(const ECUScalar &scalar, const ImageOverlay &image, double &val) {
+
+    const size_t len = length(scalar.numType());
+    char data[sizeof(quint64)];
+
+    if ( len == 0 || len > sizeof(quint64) || !image.read(scalar.addressNum(), len, data) ) {
+        return false;
+    }
+
+    return decode(scalar, data, val);
+}
+
+bool ScalarCodec::encode(const ECUScalar &scalar, double val, char *data) {
+
+    const QString numtype = scalar.numType();
+    const size_t len = length(numtype);
+
+    if ( len == 0 || len > sizeof(quint64) || std::isnan(val) ) {
+        return false;
+    }
+
+    double preVal = val;
+    const QVector<double> coeff = scalar.coefficients();
+
+    if ( scalar.type() != VARTYPE_SCALAR_VTAB && coeff.size() == A2LCOEFFNUM ) { // inverse of decode()
+
+        const double denom = coeff[5] + coeff[4] * val;
+
+        if ( denom == 0 ) {
+            return false;
+        }
+
+        preVal = (coeff[1] * val + coeff[2]) / denom;
+    }
+
+    quint64 rawVal = 0;
+
+    if ( numtype == "Wr32" ) {
+
+        const float f = static_cast<float>(preVal);
+        quint32 bits = 0;
+        memcpy(&bits, &f, sizeof(bits));
+        rawVal = bits;
+    }
+    else if ( numtype == "Wr64" ) {
+        memcpy(&rawVal, &preVal, sizeof(rawVal));
+    }
+    else {
+
+        const bool isSigned = numtype.startsWith("Ws");
+        const int bits = int(len * 8);
+
+        // limits of the raw type as doubles; 2^63 and 2^64 are exact
+
+        const double maxVal = isSigned ? std::ldexp(1.0, bits - 1) - 1 : std::ldexp(1.0, bits) - 1;
+        const double minVal = isSigned ? -std::ldexp(1.0, bits - 1) : 0;
+
+        double rounded = std::floor(preVal + 0.5);
+
+        if ( rounded < minVal ) {
+            rounded = minVal;
+        }
+        else if ( rounded > maxVal ) {
+            rounded = maxVal;
+        }
+
+        if ( isSigned ) {
+            rawVal = (rounded >= std::ldexp(1.0, 63) - 1) ?
+                        quint64(std::numeric_limits<qint64>::max()) : quint64(qint64(rounded));
+        }
+        else {
+            rawVal = (rounded >= std::ldexp(1.0, 64) - 1) ?
+                        std::numeric_limits<quint64>::max() : quint64(rounded);
+        }
+    }
+
+    for ( size_t i=0; i<len; i++ ) {
+        data[i] = char(rawVal >> (8 * (len - 1 - i)));
+    }
+
+    return true;
+}
+
+QString ScalarCodec::toString(const ECUScalar &scalar, double val) {
+
+    if ( scalar.type() == VARTYPE_SCALAR_VTAB ) {
+        return QString::number(qint64(val));
+    }
+
+    return QString::number(val, 'f', scalar.precision());
+}
+
+QString ScalarCodec::toDisplayString(const ECUScalar &scalar, double val) {
+
+    if ( scalar.type() == VARTYPE_SCALAR_VTAB ) {
+
+        const QStringList vtab = scalar.vTable();
+        const qint64 ind = qint64(val);
+
+        if ( ind >= 0 && ind < vtab.size() ) {
+            return vtab[ind];
+        }
+    }
+
+    return toString(scalar, val);
+}
@@ -0,0 +1,45 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: scalarcodec.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SCALARCODEC_HPP
+#define SCALARCODEC_HPP
+
+#include <QString>
+
+#include "ecuscalar.hpp"
+#include "memoryimage.hpp"
+#include "imageoverlay.hpp"
+
+// Conversion between raw ECU memory (MSB first) and physical values.
+
+class ScalarCodec {
+
+public:
+    static size_t length(const QString &); // numeric type -> bytes
+    static bool decode(const ECUScalar &, const char *, double &);
+    static bool decode(const ECUScalar &, const MemoryImage &, double &);
+    static bool decode(const ECUScalar &, const ImageOverlay &, double &);
+    static bool encode(const ECUScalar &, double, char *); // nearest raw value, saturated
+    static QString toString(const ECUScalar &, double);
+    static QString toDisplayString(const ECUScalar &, double); // VTAB -> text
+
+};
+
+#endif // SCALARCODEC_HPP
@@ -0,0 +1,203 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: signalhistory.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "signalhistory.hpp"
+#include "constants.hpp"
+
+#include <limits>
+
+SignalHistory::SignalHistory() :
+    m_recent(LIVERECENTSAMPLES) {
+
+    m_buckets.reserve(LIVEHISTORYBUCKETS);
+    m_last.time = 0;
+    m_last.value = std::numeric_limits<double>::quiet_NaN();
+}
+
+void SignalHistory::append(const Sample &sample) {
+
+    if ( m_count == 0 ) {
+        m_firstTime = sample.time;
+    }
+
+    m_count++;
+    m_last = sample;
+
+    // newest samples
+
+    if ( m_recentSize < m_recent.size() ) {
+        m_recent[(m_recentStart + m_recentSize) % m_recent.size()] = sample;
+        m_recentSize++;
+    }
+    else {
+        m_recent[m_recentStart] = sample;
+        m_recentStart = (m_recentStart + 1) % m_recent.size();
+    }
+
+    // buckets
+
+    if ( !m_buckets.isEmpty() && m_buckets.last().count < m_bucketSamples ) {
+
+        Bucket &bucket = m_buckets.last();
+
+        bucket.end = sample.time;
+        bucket.count++;
+
+        if ( sample.value < bucket.min ) {
+            bucket.min = sample.value;
+        }
+        if ( sample.value > bucket.max ) {
+            bucket.max = sample.value;
+        }
+
+        return;
+    }
+
+    if ( m_buckets.size() == LIVEHISTORYBUCKETS ) {
+        mergeBuckets();
+    }
+
+    Bucket bucket;
+    bucket.begin = sample.time;
+    bucket.end = sample.time;
+    bucket.min = sample.value;
+    bucket.max = sample.value;
+    bucket.count = 1;
+
+    m_buckets.push_back(bucket);
+}
+
+void SignalHistory::clear() {
+
+    m_recentStart = 0;
+    m_recentSize = 0;
+    m_buckets.clear();
+    m_bucketSamples = 1;
+    m_count = 0;
+    m_firstTime = 0;
+    m_last.time = 0;
+    m_last.value = std::numeric_limits<double>::quiet_NaN();
+}
+
+void SignalHistory::decimate(qint64 begin, qint64 end, ptrdiff_t columns,
+                             QVector<double> &mins, QVector<double> &maxs) const {
+
+    mins.fill(std::numeric_limits<double>::quiet_NaN(), columns);
+    maxs.fill(std::numeric_limits<double>::quiet_NaN(), columns);
+
+    if ( m_count == 0 || columns <= 0 || end <= begin ) {
+        return;
+    }
+
+    const double scale = double(columns) / (end - begin);
+
+    auto add = [&](qint64 from, qint64 to, double min, double max) {
+
+        if ( to < begin || from >= end ) {
+            return;
+        }
+
+        ptrdiff_t first = from < begin ? 0 : ptrdiff_t((from - begin) * scale);
+        ptrdiff_t last = to >= end ? columns - 1 : ptrdiff_t((to - begin) * scale);
+
+        if ( last >= columns ) {
+            last = columns - 1;
+        }
+
+        for ( ptrdiff_t c=first; c<=last; c++ ) {
+
+            if ( !(mins[c] <= min) ) { // also replaces NaN
+                mins[c] = min;
+            }
+            if ( !(maxs[c] >= max) ) {
+                maxs[c] = max;
+            }
+        }
+    };
+
+    // the buckets only where the newest samples do not reach
+
+    const qint64 recentBegin = m_recentSize > 0 ? m_recent[m_recentStart].time : end;
+
+    if ( begin < recentBegin ) {
+
+        for ( ptrdiff_t i=0; i<m_buckets.size() && m_buckets[i].begin < recentBegin; i++ ) {
+            add(m_buckets[i].begin, m_buckets[i].end, m_buckets[i].min, m_buckets[i].max);
+        }
+    }
+
+    // samples are in time order, skip those before the range
+
+    ptrdiff_t lo = 0;
+    ptrdiff_t hi = m_recentSize;
+
+    while ( lo < hi ) {
+
+        const ptrdiff_t mid = lo + (hi - lo) / 2;
+
+        if ( m_recent[(m_recentStart + mid) % m_recent.size()].time < begin ) {
+            lo = mid + 1;
+        }
+        else {
+            hi = mid;
+        }
+    }
+
+    for ( ptrdiff_t i=lo; i<m_recentSize; i++ ) {
+
+        const Sample &sample = m_recent[(m_recentStart + i) % m_recent.size()];
+
+        if ( sample.time >= end ) {
+            break;
+        }
+
+        add(sample.time, sample.time, sample.value, sample.value);
+    }
+}
+
+void SignalHistory::mergeBuckets() {
+
+    ptrdiff_t n = 0;
+
+    for ( ptrdiff_t i=0; i<m_buckets.size(); i+=2, n++ ) {
+
+        Bucket bucket = m_buckets[i];
+
+        if ( i + 1 < m_buckets.size() ) {
+
+            const Bucket &next = m_buckets[i + 1];
+
+            bucket.end = next.end;
+            bucket.count += next.count;
+
+            if ( next.min < bucket.min ) {
+                bucket.min = next.min;
+            }
+            if ( next.max > bucket.max ) {
+                bucket.max = next.max;
+            }
+        }
+
+        m_buckets[n] = bucket;
+    }
+
+    m_buckets.resize(n);
+    m_bucketSamples *= 2;
+}
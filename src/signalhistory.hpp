@@ -0,0 +1,83 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: signalhistory.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SIGNALHISTORY_HPP
+#define SIGNALHISTORY_HPP
+
+#include <QVector>
+
+#include "samplering.hpp"
+
+// Whole history of one live signal in constant memory: the newest samples
+// as they are, everything since the start as min/max buckets. When the
+// buckets run out, neighbours are merged and every bucket covers twice as
+// many samples as before.
+
+class SignalHistory {
+
+public:
+    SignalHistory();
+    void append(const Sample &);
+    void clear();
+
+    // min/max per pixel column of [begin, end) ms; NaN for empty columns
+    void decimate(qint64, qint64, ptrdiff_t, QVector<double> &, QVector<double> &) const;
+
+    bool isEmpty() const {
+        return m_count == 0;
+    }
+    qint64 count() const {
+        return m_count;
+    }
+    qint64 firstTime() const {
+        return m_firstTime;
+    }
+    qint64 lastTime() const {
+        return m_last.time;
+    }
+    double lastValue() const {
+        return m_last.value;
+    }
+
+private:
+    struct Bucket {
+        qint64 begin; // time of the first sample
+        qint64 end;   // time of the last sample
+        double min;
+        double max;
+        quint32 count;
+    };
+
+    QVector<Sample> m_recent; // circular, LIVERECENTSAMPLES
+    ptrdiff_t m_recentStart = 0;
+    ptrdiff_t m_recentSize = 0;
+
+    QVector<Bucket> m_buckets; // never more than LIVEHISTORYBUCKETS
+    quint32 m_bucketSamples = 1;
+
+    qint64 m_count = 0;
+    qint64 m_firstTime = 0;
+    Sample m_last;
+
+    void mergeBuckets();
+
+};
+
+#endif // SIGNALHISTORY_HPP
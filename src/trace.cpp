@@ -0,0 +1,279 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: trace.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "trace.hpp"
+#include "constants.hpp"
+
+#include <QThread>
+#include <QMutexLocker>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QCoreApplication>
+
+#if defined(Q_OS_WIN)
+#include <windows.h>
+#include <psapi.h>
+#elif defined(Q_OS_UNIX)
+#include <sys/resource.h>
+#endif
+
+#ifdef DIECAT_TRACE_ALLOCATIONS
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+static std::atomic<qint64> allocationsNum(0);
+
+void *operator new(size_t size) {
+
+    allocationsNum.fetch_add(1, std::memory_order_relaxed);
+
+    void *ptr = malloc(size ? size : 1);
+
+    if ( !ptr ) {
+        throw std::bad_alloc();
+    }
+
+    return ptr;
+}
+
+void *operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void *ptr) noexcept {
+    free(ptr);
+}
+
+void operator delete[](void *ptr) noexcept {
+    free(ptr);
+}
+
+#endif
+
+Trace::Trace() :
+    m_enabled(1) {
+
+    m_clock.start();
+}
+
+Trace &Trace::instance() {
+
+    static Trace trace;
+    return trace;
+}
+
+void Trace::setEnabled(bool enabled) {
+    m_enabled.store(enabled ? 1 : 0);
+}
+
+void Trace::clear() {
+
+    QMutexLocker locker(&m_mutex);
+
+    m_events.clear();
+    m_stats.clear();
+    m_counters.clear();
+}
+
+void Trace::addScope(const char *name, qint64 begin, qint64 end) {
+
+    const quint64 tid = quint64(QThread::currentThreadId());
+    const qint64 rss = peakRss();
+
+    QMutexLocker locker(&m_mutex);
+
+    Stat &stat = m_stats[name];
+    stat.calls++;
+    stat.totalNs += end - begin;
+    stat.maxNs = qMax(stat.maxNs, end - begin);
+
+    if ( m_events.size() < TRACEMAXEVENTS ) {
+
+        const Event scope = { name, 'X', tid, begin, end - begin };
+        m_events.push_back(scope);
+
+        if ( rss >= 0 ) {
+            const Event mem = { "peakRss", 'C', tid, end, rss };
+            m_events.push_back(mem);
+        }
+    }
+}
+
+void Trace::count(const char *name, qint64 delta) {
+
+    if ( !isEnabled() ) {
+        return;
+    }
+
+    const quint64 tid = quint64(QThread::currentThreadId());
+    const qint64 ts = now();
+
+    QMutexLocker locker(&m_mutex);
+
+    qint64 &value = m_counters[name];
+    value += delta;
+
+    if ( m_events.size() < TRACEMAXEVENTS ) {
+        const Event counter = { name, 'C', tid, ts, value };
+        m_events.push_back(counter);
+    }
+}
+
+QVector<TraceStat> Trace::stats() const {
+
+    QMutexLocker locker(&m_mutex);
+
+    // equal literals from different files may have different addresses
+
+    QMap<QString, TraceStat> merged;
+
+    for ( QHash<const char *, Stat>::const_iterator it = m_stats.constBegin(); it != m_stats.constEnd(); ++it ) {
+
+        const QString name = QString::fromLatin1(it.key());
+        TraceStat &stat = merged[name]; // value-initialized, all zero
+
+        stat.name = name;
+        stat.calls += it.value().calls;
+        stat.totalMs += double(it.value().totalNs) / 1e6;
+        stat.maxMs = qMax(stat.maxMs, double(it.value().maxNs) / 1e6);
+    }
+
+    return merged.values().toVector();
+}
+
+QMap<QString, qint64> Trace::counters() const {
+
+    QMutexLocker locker(&m_mutex);
+
+    QMap<QString, qint64> ret;
+
+    for ( QHash<const char *, qint64>::const_iterator it = m_counters.constBegin(); it != m_counters.constEnd(); ++it ) {
+        ret[QString::fromLatin1(it.key())] += it.value();
+    }
+
+    return ret;
+}
+
+bool Trace::writeChromeTrace(const QString &path) const {
+
+    QJsonArray events;
+
+    {
+        QMutexLocker locker(&m_mutex);
+
+        for ( ptrdiff_t i=0; i<m_events.size(); i++ ) {
+
+            const Event &ev = m_events[i];
+
+            QJsonObject obj;
+            obj["name"] = QString::fromLatin1(ev.name);
+            obj["ph"] = QString(QChar(ev.phase));
+            obj["pid"] = double(QCoreApplication::applicationPid());
+            obj["tid"] = double(ev.tid);
+            obj["ts"] = double(ev.ts) / 1e3; // us
+
+            if ( ev.phase == 'X' ) {
+                obj["cat"] = QString(PROGNAME);
+                obj["dur"] = double(ev.value) / 1e3;
+            }
+            else {
+                QJsonObject args;
+                args["value"] = double(ev.value);
+                obj["args"] = args;
+            }
+
+            events.append(obj);
+        }
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = QString("ms");
+
+    QFile file(path);
+
+    if ( !file.open(QIODevice::WriteOnly | QIODevice::Truncate) ) {
+        return false;
+    }
+
+    const QByteArray json = QJsonDocument(root).toJson(QJsonDocument::Compact);
+
+    return file.write(json) == json.size();
+}
+
+qint64 Trace::peakRss() {
+
+#if defined(Q_OS_WIN)
+
+    PROCESS_MEMORY_COUNTERS pmc;
+
+    if ( GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)) ) {
+        return qint64(pmc.PeakWorkingSetSize);
+    }
+
+    return -1;
+
+#elif defined(Q_OS_UNIX)
+
+    struct rusage usage;
+
+    if ( getrusage(RUSAGE_SELF, &usage) != 0 ) {
+        return -1;
+    }
+
+#if defined(Q_OS_MAC)
+    return qint64(usage.ru_maxrss);
+#else
+    return qint64(usage.ru_maxrss) * 1024;
+#endif
+
+#else
+    return -1;
+#endif
+}
+
+qint64 Trace::allocations() {
+
+#ifdef DIECAT_TRACE_ALLOCATIONS
+    return allocationsNum.load(std::memory_order_relaxed);
+#else
+    return -1;
+#endif
+}
+
+TraceScope::TraceScope(const char *name) :
+    m_name(name),
+    m_begin(-1) {
+
+    if ( Trace::instance().isEnabled() ) {
+        m_begin = Trace::instance().now();
+    }
+}
+
+TraceScope::~TraceScope() {
+
+    if ( m_begin >= 0 ) {
+        Trace::instance().addScope(m_name, m_begin, Trace::instance().now());
+    }
+}
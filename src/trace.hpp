@@ -0,0 +1,105 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: trace.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACE_HPP
+#define TRACE_HPP
+
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+
+struct TraceStat {
+    QString name;
+    qint64 calls;
+    double totalMs;
+    double maxMs;
+};
+
+// Process-wide collector of timed scopes and counters. Scope and counter
+// names must be string literals. The events can be saved as a Chrome
+// trace (chrome://tracing, Perfetto), the statistics feed the summary.
+
+class Trace {
+
+public:
+    static Trace &instance();
+    void setEnabled(bool);
+    void clear();
+    void addScope(const char *, qint64, qint64); // name, begin and end in ns
+    void count(const char *, qint64);            // adds to a counter
+    QVector<TraceStat> stats() const;
+    QMap<QString, qint64> counters() const;
+    bool writeChromeTrace(const QString &) const;
+
+    bool isEnabled() const {
+        return m_enabled.load() != 0;
+    }
+    qint64 now() const { // ns since the start of the process
+        return m_clock.nsecsElapsed();
+    }
+
+    static qint64 peakRss();     // bytes, -1 if unknown
+    static qint64 allocations(); // -1 if not counted (see DIECAT_TRACE_ALLOCATIONS)
+
+private:
+    Trace();
+
+    struct Event {
+        const char *name;
+        char phase;  // 'X' - scope, 'C' - counter
+        quint64 tid;
+        qint64 ts;   // ns
+        qint64 value; // duration in ns or counter value
+    };
+
+    struct Stat {
+        qint64 calls = 0;
+        qint64 totalNs = 0;
+        qint64 maxNs = 0;
+    };
+
+    mutable QMutex m_mutex;
+    QElapsedTimer m_clock;
+    QAtomicInt m_enabled;
+    QVector<Event> m_events;
+    QHash<const char *, Stat> m_stats;
+    QHash<const char *, qint64> m_counters;
+
+};
+
+// Times the enclosing block.
+
+class TraceScope {
+
+public:
+    explicit TraceScope(const char *);
+    ~TraceScope();
+
+private:
+    const char *m_name;
+    qint64 m_begin;
+
+};
+
+#endif // TRACE_HPP
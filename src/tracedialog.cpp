@@ -0,0 +1,124 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: tracedialog.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "tracedialog.hpp"
+#include "ui_tracedialog.h"
+#include "trace.hpp"
+#include "constants.hpp"
+
+#include <QTableWidgetItem>
+#include <QFileDialog>
+#include <QMessageBox>
+#include <QDir>
+#include <QMap>
+
+static QTableWidgetItem *readOnlyItem(const QString &text, bool number) {
+
+    QTableWidgetItem *item = new QTableWidgetItem(text);
+    item->setFlags(item->flags() & ~Qt::ItemIsEditable);
+
+    if ( number ) {
+        item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    }
+
+    return item;
+}
+
+TraceDialog::TraceDialog(QWidget *parent) :
+    QDialog(parent),
+    ui(new Ui::TraceDialog) {
+
+    ui->setupUi(this);
+}
+
+TraceDialog::~TraceDialog() {
+
+    delete ui;
+}
+
+void TraceDialog::refresh() {
+
+    const QVector<TraceStat> stats = Trace::instance().stats();
+
+    ui->tableWidget_Phases->setRowCount(stats.size());
+
+    for ( ptrdiff_t i=0; i<stats.size(); i++ ) {
+        ui->tableWidget_Phases->setItem(i, 0, readOnlyItem(stats[i].name, false));
+        ui->tableWidget_Phases->setItem(i, 1, readOnlyItem(QString::number(stats[i].calls), true));
+        ui->tableWidget_Phases->setItem(i, 2, readOnlyItem(QString::number(stats[i].totalMs, 'f', 3), true));
+        ui->tableWidget_Phases->setItem(i, 3, readOnlyItem(QString::number(stats[i].maxMs, 'f', 3), true));
+    }
+
+    //
+
+    QMap<QString, qint64> counters = Trace::instance().counters();
+
+    const qint64 rss = Trace::peakRss();
+    const qint64 allocs = Trace::allocations();
+
+    ui->tableWidget_Counters->setRowCount(counters.size() + 2);
+
+    ptrdiff_t row = 0;
+
+    for ( QMap<QString, qint64>::const_iterator it = counters.constBegin(); it != counters.constEnd(); ++it ) {
+        ui->tableWidget_Counters->setItem(row, 0, readOnlyItem(it.key(), false));
+        ui->tableWidget_Counters->setItem(row, 1, readOnlyItem(QString::number(it.value()), true));
+        row++;
+    }
+
+    ui->tableWidget_Counters->setItem(row, 0, readOnlyItem("Peak RSS, MiB", false));
+    ui->tableWidget_Counters->setItem(row, 1, readOnlyItem((rss < 0) ? "n/a" : QString::number(double(rss) / 1048576, 'f', 1), true));
+    row++;
+
+    ui->tableWidget_Counters->setItem(row, 0, readOnlyItem("Allocations", false));
+    ui->tableWidget_Counters->setItem(row, 1, readOnlyItem((allocs < 0) ? "n/a" : QString::number(allocs), true));
+
+    ui->tableWidget_Phases->resizeColumnsToContents();
+    ui->tableWidget_Counters->resizeColumnsToContents();
+}
+
+void TraceDialog::on_pushButton_Refresh_clicked() {
+    refresh();
+}
+
+void TraceDialog::on_pushButton_Clear_clicked() {
+
+    Trace::instance().clear();
+    refresh();
+}
+
+void TraceDialog::on_pushButton_SaveTrace_clicked() {
+
+    const QString fileName =
+            QFileDialog::getSaveFileName(
+                this,
+                tr("Save trace..."),
+                QDir::currentPath() + "/trace.json",
+                QString::fromLatin1("Chrome trace (*.json);;All files (*)"),
+                0, 0);
+
+    if ( fileName.isEmpty() ) {
+        return;
+    }
+
+    if ( !Trace::instance().writeChromeTrace(fileName) ) {
+        QMessageBox::critical(this, QString(PROGNAME) + ": error", "Can not write " + fileName + "!");
+    }
+}
@@ -0,0 +1,53 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: tracedialog.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TRACEDIALOG_HPP
+#define TRACEDIALOG_HPP
+
+#include <QDialog>
+
+namespace Ui {
+class TraceDialog;
+}
+
+// Summary of the collected phase timings and counters.
+
+class TraceDialog : public QDialog {
+
+    Q_OBJECT
+
+public:
+    explicit TraceDialog(QWidget *parent = 0);
+    ~TraceDialog();
+
+public slots:
+    void refresh();
+
+private slots:
+    void on_pushButton_Refresh_clicked();
+    void on_pushButton_Clear_clicked();
+    void on_pushButton_SaveTrace_clicked();
+
+private:
+    Ui::TraceDialog *ui;
+
+};
+
+#endif // TRACEDIALOG_HPP
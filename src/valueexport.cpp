@@ -0,0 +1,485 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: valueexport.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "valueexport.hpp"
+#include "constants.hpp"
+#include "trace.hpp"
+
+#include <QFile>
+#include <QStringList>
+#include <QXmlStreamWriter>
+
+#include <cmath>
+
+static void writeCSVField(BufferedWriter &out, const QString &str) {
+
+    bool quote = false;
+
+    for ( ptrdiff_t i=0; i<str.size(); i++ ) {
+
+        const ushort c = str[i].unicode();
+
+        if ( c == ';' || c == '"' || c == '\n' || c == '\r' ) {
+            quote = true;
+            break;
+        }
+    }
+
+    if ( !quote ) {
+        out.write(str);
+        return;
+    }
+
+    out.put('"');
+
+    ptrdiff_t plain = 0; // start of the run without quotes
+
+    for ( ptrdiff_t i=0; i<str.size(); i++ ) {
+
+        if ( str[i] == '"' ) {
+            out.write(str.mid(plain, i + 1 - plain));
+            out.put('"');
+            plain = i + 1;
+        }
+    }
+
+    out.write(str.mid(plain));
+    out.put('"');
+}
+
+static void writeJSONString(BufferedWriter &out, const QString &str) {
+
+    static const char hex[] = "0123456789abcdef";
+
+    out.put('"');
+
+    ptrdiff_t plain = 0; // start of the run without escapes
+
+    for ( ptrdiff_t i=0; i<str.size(); i++ ) {
+
+        const ushort c = str[i].unicode();
+
+        if ( c >= 0x20 && c != '"' && c != '\\' ) {
+            continue;
+        }
+
+        out.write(str.mid(plain, i - plain));
+        plain = i + 1;
+
+        out.put('\\');
+
+        if ( c == '"' || c == '\\' ) {
+            out.put(char(c));
+        }
+        else if ( c == '\n' ) {
+            out.put('n');
+        }
+        else if ( c == '\t' ) {
+            out.put('t');
+        }
+        else if ( c == '\r' ) {
+            out.put('r');
+        }
+        else {
+            out.write("u00", 3);
+            out.put(hex[c >> 4]);
+            out.put(hex[c & 0xF]);
+        }
+    }
+
+    if ( plain == 0 ) {
+        out.write(str);
+    }
+    else {
+        out.write(str.mid(plain));
+    }
+
+    out.put('"');
+}
+
+static void writeDCMString(BufferedWriter &out, const QString &str) {
+
+    // DCM strings have no escapes, a quote would end the string
+
+    out.put('"');
+
+    if ( str.contains('"') ) {
+        out.write(QString(str).replace('"', '\''));
+    }
+    else {
+        out.write(str);
+    }
+
+    out.put('"');
+}
+
+ValueExport::ValueExport(const QVector< QSharedPointer<ECUScalar> > &scalars) :
+    m_scalars(scalars) {
+
+    m_indexes.resize(scalars.size());
+
+    for ( ptrdiff_t i=0; i<m_indexes.size(); i++ ) {
+        m_indexes[i] = i;
+    }
+}
+
+void ValueExport::setIndexes(const QVector<ptrdiff_t> &indexes) {
+    m_indexes = indexes;
+}
+
+void ValueExport::setValues(const QVector<double> &values) {
+    m_values = values;
+}
+
+void ValueExport::setDatasetName(const QString &name) {
+    m_datasetName = name;
+}
+
+bool ValueExport::write(const QString &path, ptrdiff_t format) const {
+
+    QFile file(path);
+
+    if ( !file.open(QIODevice::WriteOnly | QIODevice::Truncate) ) {
+        return false;
+    }
+
+    const bool ok = write(&file, format);
+    file.close();
+
+    return ok;
+}
+
+bool ValueExport::write(QIODevice *device, ptrdiff_t format) const {
+
+    TraceScope trace("export");
+
+    if ( format == EXPORT_CDFX ) { // has its own writer
+        return writeCDFX(device);
+    }
+
+    BufferedWriter out(device);
+
+    if ( format == EXPORT_CSV ) {
+        writeCSV(out);
+    }
+    else if ( format == EXPORT_JSONL ) {
+        writeJSONL(out);
+    }
+    else if ( format == EXPORT_BINARY ) {
+        writeBinary(out);
+    }
+    else if ( format == EXPORT_DCM ) {
+        writeDCM(out);
+    }
+    else {
+        return false;
+    }
+
+    return out.flush();
+}
+
+ptrdiff_t ValueExport::formatByName(const QString &name) {
+
+    const QString str = name.toLower();
+
+    if ( str == "csv" ) {
+        return EXPORT_CSV;
+    }
+    else if ( str == "jsonl" || str == "json" ) {
+        return EXPORT_JSONL;
+    }
+    else if ( str == "bin" || str == "dcv" ) {
+        return EXPORT_BINARY;
+    }
+    else if ( str == "dcm" ) {
+        return EXPORT_DCM;
+    }
+    else if ( str == "cdfx" ) {
+        return EXPORT_CDFX;
+    }
+
+    return -1;
+}
+
+double ValueExport::value(ptrdiff_t ind) const {
+
+    if ( !m_values.isEmpty() ) {
+        return m_values[ind];
+    }
+
+    return m_scalars[ind]->physValue();
+}
+
+void ValueExport::writeCSV(BufferedWriter &out) const {
+
+    out.write("Label;Value;Text;Dimension;Address\n");
+
+    for ( ptrdiff_t n=0; n<m_indexes.size(); n++ ) {
+
+        const ECUScalar &scal = *m_scalars[m_indexes[n]];
+        const double val = value(m_indexes[n]);
+
+        writeCSVField(out, scal.name());
+        out.put(';');
+
+        if ( !std::isnan(val) ) {
+
+            if ( scal.type() == VARTYPE_SCALAR_VTAB ) {
+
+                const qint64 ind = qint64(val);
+                const QStringList vtab = scal.vTable();
+
+                out.writeInt(ind);
+                out.put(';');
+
+                if ( ind >= 0 && ind < vtab.size() ) {
+                    writeCSVField(out, vtab[ind]);
+                }
+            }
+            else {
+                out.writeDouble(val, scal.precision());
+                out.put(';');
+            }
+        }
+        else {
+            out.put(';');
+        }
+
+        out.put(';');
+        writeCSVField(out, scal.dimension());
+        out.put(';');
+        out.write(scal.address());
+        out.put('\n');
+    }
+}
+
+void ValueExport::writeJSONL(BufferedWriter &out) const {
+
+    for ( ptrdiff_t n=0; n<m_indexes.size(); n++ ) {
+
+        const ECUScalar &scal = *m_scalars[m_indexes[n]];
+        const double val = value(m_indexes[n]);
+
+        out.write("{\"name\":", 8);
+        writeJSONString(out, scal.name());
+        out.write(",\"value\":", 9);
+
+        if ( !std::isfinite(val) ) {
+            out.write("null", 4);
+        }
+        else if ( scal.type() == VARTYPE_SCALAR_VTAB ) {
+
+            const qint64 ind = qint64(val);
+            const QStringList vtab = scal.vTable();
+
+            out.writeInt(ind);
+
+            if ( ind >= 0 && ind < vtab.size() ) {
+                out.write(",\"text\":", 8);
+                writeJSONString(out, vtab[ind]);
+            }
+        }
+        else {
+            out.writeDouble(val, scal.precision());
+        }
+
+        out.write(",\"unit\":", 8);
+        writeJSONString(out, scal.dimension());
+        out.write(",\"address\":", 11);
+        writeJSONString(out, scal.address());
+        out.write("}\n", 2);
+    }
+}
+
+void ValueExport::writeBinary(BufferedWriter &out) const {
+
+    const quint32 count = m_indexes.size();
+
+    out.write("DCVB", 4);
+    out.writeLE32(1);
+    out.writeLE32(count);
+
+    // string columns: offsets first, so a reader can map names without parsing
+
+    QVector<QByteArray> names(count);
+    QVector<QByteArray> units(count);
+
+    for ( ptrdiff_t n=0; n<m_indexes.size(); n++ ) {
+        names[n] = m_scalars[m_indexes[n]]->name().toUtf8();
+        units[n] = m_scalars[m_indexes[n]]->dimension().toUtf8();
+    }
+
+    for ( ptrdiff_t c=0; c<2; c++ ) {
+
+        const QVector<QByteArray> &column = c == 0 ? names : units;
+        quint32 offset = 0;
+
+        out.writeLE32(offset);
+
+        for ( ptrdiff_t n=0; n<column.size(); n++ ) {
+            offset += column[n].size();
+            out.writeLE32(offset);
+        }
+
+        for ( ptrdiff_t n=0; n<column.size(); n++ ) {
+            out.write(column[n].constData(), column[n].size());
+        }
+    }
+
+    for ( ptrdiff_t n=0; n<m_indexes.size(); n++ ) {
+        out.writeLE32(m_scalars[m_indexes[n]]->addressNum());
+    }
+
+    for ( ptrdiff_t n=0; n<m_indexes.size(); n++ ) {
+        out.put(char(m_scalars[m_indexes[n]]->type()));
+    }
+
+    for ( ptrdiff_t n=0; n<m_indexes.size(); n++ ) {
+        out.writeLEDouble(value(m_indexes[n]));
+    }
+}
+
+void ValueExport::writeDCM(BufferedWriter &out) const {
+
+    out.write("* ");
+    out.write(PROGNAME);
+    out.write(" " PROGVER "\n\nKONSERVIERUNG_FORMAT 2.0\n");
+
+    for ( ptrdiff_t n=0; n<m_indexes.size(); n++ ) {
+
+        const ECUScalar &scal = *m_scalars[m_indexes[n]];
+        const double val = value(m_indexes[n]);
+
+        if ( !std::isfinite(val) ) { // FESTWERT needs a value
+            continue;
+        }
+
+        out.write("\nFESTWERT ", 10);
+        out.write(scal.name());
+        out.write("\n   LANGNAME ", 13);
+        writeDCMString(out, scal.shortDescription());
+
+        // dimension() is "[unit]"
+
+        QString unit = scal.dimension();
+
+        if ( unit.startsWith('[') && unit.endsWith(']') ) {
+            unit = unit.mid(1, unit.size() - 2);
+        }
+
+        out.write("\n   EINHEIT_W ", 14);
+        writeDCMString(out, unit);
+
+        const qint64 ind = qint64(val);
+        const QStringList vtab = scal.type() == VARTYPE_SCALAR_VTAB ? scal.vTable() : QStringList();
+
+        if ( ind >= 0 && ind < vtab.size() ) {
+            out.write("\n   TEXT ", 9);
+            writeDCMString(out, vtab[ind]);
+        }
+        else {
+            out.write("\n   WERT ", 9);
+            out.writeDouble(val, scal.type() == VARTYPE_SCALAR_VTAB ? 0 : scal.precision());
+        }
+
+        out.write("\nEND\n", 5);
+    }
+}
+
+bool ValueExport::writeCDFX(QIODevice *device) const {
+
+    QXmlStreamWriter xml(device);
+    xml.setAutoFormatting(true);
+    xml.setAutoFormattingIndent(1);
+
+    xml.writeStartDocument();
+    xml.writeDTD("<!DOCTYPE MSRSW PUBLIC \"-//ASAM//DTD CALIBRATION DATA FORMAT:V2.0.0:LAI:IAI:XML:CDF200.XSD//EN\" "
+                 "\"cdf_v2.0.0.sl.dtd\">");
+
+    xml.writeStartElement("MSRSW");
+    xml.writeTextElement("SHORT-NAME", m_datasetName);
+    xml.writeTextElement("CATEGORY", "CDF20");
+
+    xml.writeStartElement("SW-SYSTEMS");
+    xml.writeStartElement("SW-SYSTEM");
+    xml.writeTextElement("SHORT-NAME", m_datasetName);
+    xml.writeStartElement("SW-INSTANCE-SPEC");
+    xml.writeStartElement("SW-INSTANCE-TREE");
+    xml.writeTextElement("SHORT-NAME", m_datasetName);
+    xml.writeTextElement("CATEGORY", "NO_VCD");
+
+    for ( ptrdiff_t n=0; n<m_indexes.size(); n++ ) {
+
+        const ECUScalar &scal = *m_scalars[m_indexes[n]];
+        const double val = value(m_indexes[n]);
+
+        if ( !std::isfinite(val) ) {
+            continue;
+        }
+
+        xml.writeStartElement("SW-INSTANCE");
+        xml.writeTextElement("SHORT-NAME", scal.name());
+
+        if ( !scal.shortDescription().isEmpty() ) {
+            xml.writeTextElement("LONG-NAME", scal.shortDescription());
+        }
+
+        xml.writeTextElement("CATEGORY", "VALUE");
+        xml.writeStartElement("SW-VALUE-CONT");
+
+        // dimension() is "[unit]"
+
+        QString unit = scal.dimension();
+
+        if ( unit.startsWith('[') && unit.endsWith(']') ) {
+            unit = unit.mid(1, unit.size() - 2);
+        }
+
+        if ( !unit.isEmpty() ) {
+            xml.writeTextElement("UNIT-DISPLAY-NAME", unit);
+        }
+
+        xml.writeStartElement("SW-VALUES-PHYS");
+
+        const qint64 ind = qint64(val);
+        const QStringList vtab = scal.type() == VARTYPE_SCALAR_VTAB ? scal.vTable() : QStringList();
+
+        if ( ind >= 0 && ind < vtab.size() ) {
+            xml.writeTextElement("VT", vtab[ind]);
+        }
+        else {
+            const int prec = scal.type() == VARTYPE_SCALAR_VTAB ? 0 : int(scal.precision());
+            xml.writeTextElement("V", QString::number(val, 'f', prec));
+        }
+
+        xml.writeEndElement(); // SW-VALUES-PHYS
+        xml.writeEndElement(); // SW-VALUE-CONT
+        xml.writeEndElement(); // SW-INSTANCE
+    }
+
+    xml.writeEndElement(); // SW-INSTANCE-TREE
+    xml.writeEndElement(); // SW-INSTANCE-SPEC
+    xml.writeEndElement(); // SW-SYSTEM
+    xml.writeEndElement(); // SW-SYSTEMS
+    xml.writeEndElement(); // MSRSW
+    xml.writeEndDocument();
+
+    return !xml.hasError();
+}
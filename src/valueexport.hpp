@@ -0,0 +1,77 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: valueexport.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef VALUEEXPORT_HPP
+#define VALUEEXPORT_HPP
+
+#include <QString>
+#include <QVector>
+#include <QSharedPointer>
+#include <QIODevice>
+
+#include "ecuscalar.hpp"
+#include "bufferedwriter.hpp"
+
+// Streams labels and their physical values to CSV, JSON Lines, DCM, CDFX
+// or a binary columnar file. Values are taken from physValue() of the scalars unless
+// set explicitly; NaN means "no value".
+//
+// Binary layout (little endian):
+//   "DCVB", u32 version (1), u32 count,
+//   u32 name offsets[count+1], UTF-8 names,
+//   u32 unit offsets[count+1], UTF-8 units,
+//   u32 addresses[count], u8 types[count], f64 values[count]
+//
+// DCM gets one FESTWERT block per label with a value; VTAB labels are
+// written as TEXT. The file is UTF-8.
+//
+// CDFX (ASAM CDF 2.0) is written element by element with QXmlStreamWriter,
+// one SW-INSTANCE of category VALUE per label with a value, all in one
+// SW-INSTANCE-TREE named after the dataset.
+
+class ValueExport {
+
+public:
+    ValueExport(const QVector< QSharedPointer<ECUScalar> > &);
+    void setIndexes(const QVector<ptrdiff_t> &); // all scalars by default
+    void setValues(const QVector<double> &);     // one per scalar
+    void setDatasetName(const QString &);        // CDFX only, PROGNAME by default
+    bool write(const QString &, ptrdiff_t) const;
+    bool write(QIODevice *, ptrdiff_t) const;
+
+    static ptrdiff_t formatByName(const QString &); // -1 if unknown
+
+private:
+    QVector< QSharedPointer<ECUScalar> > m_scalars;
+    QVector<ptrdiff_t> m_indexes;
+    QVector<double> m_values;
+    QString m_datasetName = PROGNAME;
+
+    double value(ptrdiff_t) const;
+
+    void writeCSV(BufferedWriter &) const;
+    void writeJSONL(BufferedWriter &) const;
+    void writeBinary(BufferedWriter &) const;
+    void writeDCM(BufferedWriter &) const;
+    bool writeCDFX(QIODevice *) const;
+
+};
+
+#endif // VALUEEXPORT_HPP
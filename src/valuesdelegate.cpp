@@ -0,0 +1,80 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: valuesdelegate.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "valuesdelegate.hpp"
+#include "valuesmodel.hpp"
+
+#include <QComboBox>
+#include <QStringList>
+#include <QVariant>
+
+ValuesDelegate::ValuesDelegate(QObject *parent) :
+    QStyledItemDelegate(parent) {
+}
+
+QWidget *ValuesDelegate::createEditor(QWidget *parent,
+                                      const QStyleOptionViewItem &option,
+                                      const QModelIndex &index) const {
+
+    const QStringList vtab = index.data(ValuesModel::VTableRole).toStringList();
+
+    if ( vtab.isEmpty() ) {
+        return QStyledItemDelegate::createEditor(parent, option, index);
+    }
+
+    QComboBox *comboBox_vTable = new QComboBox(parent);
+    comboBox_vTable->addItems(vtab);
+
+    connect(comboBox_vTable, SIGNAL(activated(int)), this, SLOT(commitAndClose()));
+
+    return comboBox_vTable;
+}
+
+void ValuesDelegate::setEditorData(QWidget *editor, const QModelIndex &index) const {
+
+    QComboBox *comboBox_vTable = qobject_cast<QComboBox *>(editor);
+
+    if ( !comboBox_vTable ) {
+        QStyledItemDelegate::setEditorData(editor, index);
+        return;
+    }
+
+    comboBox_vTable->setCurrentIndex(index.data(Qt::EditRole).toInt());
+}
+
+void ValuesDelegate::setModelData(QWidget *editor, QAbstractItemModel *model, const QModelIndex &index) const {
+
+    QComboBox *comboBox_vTable = qobject_cast<QComboBox *>(editor);
+
+    if ( !comboBox_vTable ) {
+        QStyledItemDelegate::setModelData(editor, model, index);
+        return;
+    }
+
+    model->setData(index, QString::number(comboBox_vTable->currentIndex()), Qt::EditRole);
+}
+
+void ValuesDelegate::commitAndClose() {
+
+    QWidget *editor = qobject_cast<QWidget *>(sender());
+
+    emit commitData(editor);
+    emit closeEditor(editor);
+}
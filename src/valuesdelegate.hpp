@@ -0,0 +1,49 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: valuesdelegate.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef VALUESDELEGATE_HPP
+#define VALUESDELEGATE_HPP
+
+#include <QStyledItemDelegate>
+#include <QWidget>
+#include <QModelIndex>
+#include <QAbstractItemModel>
+#include <QStyleOptionViewItem>
+
+// Editor for the values column. VTAB values are painted as plain text by
+// the view; a combo box is created only while such a cell is edited.
+
+class ValuesDelegate : public QStyledItemDelegate {
+
+    Q_OBJECT
+
+public:
+    explicit ValuesDelegate(QObject *parent = 0);
+
+    QWidget *createEditor(QWidget *, const QStyleOptionViewItem &, const QModelIndex &) const;
+    void setEditorData(QWidget *, const QModelIndex &) const;
+    void setModelData(QWidget *, QAbstractItemModel *, const QModelIndex &) const;
+
+private slots:
+    void commitAndClose();
+
+};
+
+#endif // VALUESDELEGATE_HPP
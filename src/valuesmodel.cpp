@@ -0,0 +1,297 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: valuesmodel.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "valuesmodel.hpp"
+
+#include "constants.hpp"
+
+#include <QColor>
+#include <QStringList>
+
+ValuesModel::ValuesModel(QObject *parent) :
+    QAbstractTableModel(parent) {
+}
+
+void ValuesModel::setScalars(const QVector< QSharedPointer<ECUScalar> > &scalars) {
+
+    beginResetModel();
+    m_scalars = scalars;
+    m_rows.clear();
+    m_rowOf.fill(-1, scalars.size());
+    m_changed.fill(false, scalars.size());
+    endResetModel();
+}
+
+void ValuesModel::clear() {
+
+    beginResetModel();
+    m_scalars.clear();
+    m_rows.clear();
+    m_rowOf.clear();
+    m_changed.clear();
+    endResetModel();
+}
+
+void ValuesModel::refresh() {
+
+    if ( m_rows.isEmpty() ) {
+        return;
+    }
+
+    emit dataChanged(index(0, 1), index(m_rows.size()-1, 1));
+}
+
+void ValuesModel::setChanged(const QVector<ptrdiff_t> &inds) {
+
+    m_changed.fill(false);
+
+    for ( ptrdiff_t n=0; n<inds.size(); n++ ) {
+        m_changed[inds[n]] = true;
+    }
+
+    if ( m_rows.isEmpty() ) {
+        return;
+    }
+
+    emit dataChanged(index(0, 0), index(m_rows.size()-1, columnCount()-1));
+}
+
+ptrdiff_t ValuesModel::addScalar(ptrdiff_t ind) {
+
+    if ( m_rowOf[ind] >= 0 ) {
+        return m_rowOf[ind];
+    }
+
+    const ptrdiff_t row = m_rows.size();
+
+    beginInsertRows(QModelIndex(), row, row);
+    m_rows.push_back(ind);
+    m_rowOf[ind] = row;
+    endInsertRows();
+
+    return row;
+}
+
+void ValuesModel::removeScalar(ptrdiff_t ind) {
+
+    const ptrdiff_t row = m_rowOf[ind];
+
+    if ( row < 0 ) {
+        return;
+    }
+
+    beginRemoveRows(QModelIndex(), row, row);
+    m_rows.remove(row);
+    m_rowOf[ind] = -1;
+    updateRowsFrom(row);
+    endRemoveRows();
+}
+
+ptrdiff_t ValuesModel::addScalars(const QVector<ptrdiff_t> &inds) {
+
+    const ptrdiff_t first = m_rows.size();
+    ptrdiff_t num = 0;
+
+    for ( ptrdiff_t n=0; n<inds.size(); n++ ) { // skip those already shown and duplicates
+
+        if ( m_rowOf[inds[n]] < 0 ) {
+            m_rowOf[inds[n]] = first + num;
+            num++;
+        }
+    }
+
+    if ( num == 0 ) {
+        return first;
+    }
+
+    beginInsertRows(QModelIndex(), first, first + num - 1);
+
+    m_rows.reserve(first + num);
+
+    for ( ptrdiff_t n=0; n<inds.size(); n++ ) {
+
+        if ( m_rowOf[inds[n]] == m_rows.size() ) {
+            m_rows.push_back(inds[n]);
+        }
+    }
+
+    endInsertRows();
+
+    return first;
+}
+
+void ValuesModel::removeScalars(const QVector<ptrdiff_t> &inds) {
+
+    ptrdiff_t firstRow = m_rows.size();
+    ptrdiff_t lastRow = -1;
+    ptrdiff_t num = 0;
+
+    for ( ptrdiff_t n=0; n<inds.size(); n++ ) {
+
+        const ptrdiff_t row = m_rowOf[inds[n]];
+
+        if ( row >= 0 ) {
+            firstRow = qMin(firstRow, row);
+            lastRow = qMax(lastRow, row);
+            m_rowOf[inds[n]] = -1; // marks the row as removed
+            num++;
+        }
+    }
+
+    if ( num == 0 ) {
+        return;
+    }
+
+    // a contiguous block is one ordinary removal, anything else resets
+    // the model once instead of removing row by row
+
+    const bool contiguous = (lastRow - firstRow + 1) == num;
+
+    if ( contiguous ) {
+        beginRemoveRows(QModelIndex(), firstRow, lastRow);
+    }
+    else {
+        beginResetModel();
+    }
+
+    ptrdiff_t kept = firstRow;
+
+    for ( ptrdiff_t row=firstRow; row<m_rows.size(); row++ ) {
+
+        if ( m_rowOf[m_rows[row]] >= 0 ) {
+            m_rows[kept++] = m_rows[row];
+        }
+    }
+
+    m_rows.resize(kept);
+    updateRowsFrom(firstRow);
+
+    if ( contiguous ) {
+        endRemoveRows();
+    }
+    else {
+        endResetModel();
+    }
+}
+
+int ValuesModel::rowCount(const QModelIndex &parent) const {
+
+    if ( parent.isValid() ) {
+        return 0;
+    }
+
+    return m_rows.size();
+}
+
+int ValuesModel::columnCount(const QModelIndex &parent) const {
+
+    if ( parent.isValid() ) {
+        return 0;
+    }
+
+    return 3;
+}
+
+QVariant ValuesModel::data(const QModelIndex &index, int role) const {
+
+    if ( !index.isValid() || index.row() >= m_rows.size() ) {
+        return QVariant();
+    }
+
+    const QSharedPointer<ECUScalar> &scal = m_scalars[m_rows[index.row()]];
+
+    if ( role == Qt::DisplayRole || role == Qt::EditRole ) {
+
+        if ( index.column() == 0 ) {
+            return scal->name();
+        }
+        else if ( index.column() == 1 ) {
+
+            if ( role == Qt::DisplayRole && scal->type() == VARTYPE_SCALAR_VTAB ) {
+
+                const QStringList vtab = scal->vTable();
+                const ptrdiff_t ind = scal->value().toInt();
+
+                if ( ind >= 0 && ind < vtab.size() ) {
+                    return vtab[ind];
+                }
+            }
+
+            return scal->value();
+        }
+        else if ( index.column() == 2 ) {
+            return scal->dimension();
+        }
+    }
+    else if ( role == Qt::ForegroundRole && index.column() == 1 ) {
+        return QColor(Qt::blue);
+    }
+    else if ( role == Qt::BackgroundRole && m_changed[m_rows[index.row()]] ) {
+        return QColor(255, 255, 160);
+    }
+    else if ( role == VTableRole && index.column() == 1 && scal->type() == VARTYPE_SCALAR_VTAB ) {
+        return scal->vTable();
+    }
+
+    return QVariant();
+}
+
+bool ValuesModel::setData(const QModelIndex &index, const QVariant &value, int role) {
+
+    if ( !index.isValid() || index.column() != 1 || role != Qt::EditRole ) {
+        return false;
+    }
+
+    const QSharedPointer<ECUScalar> scal = m_scalars[m_rows[index.row()]];
+    bool ok = false;
+    const double physValue = value.toString().toDouble(&ok);
+
+    if ( !ok ) {
+        return false;
+    }
+
+    scal->setValue(value.toString());
+    scal->setPhysValue(physValue);
+
+    emit dataChanged(index, index);
+    emit valueEdited(m_rows[index.row()], physValue);
+
+    return true;
+}
+
+Qt::ItemFlags ValuesModel::flags(const QModelIndex &index) const {
+
+    if ( !index.isValid() ) {
+        return Qt::NoItemFlags;
+    }
+
+    if ( index.column() == 1 && !m_scalars[m_rows[index.row()]]->isReadOnly() ) {
+        return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsEditable;
+    }
+
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+void ValuesModel::updateRowsFrom(ptrdiff_t first) {
+
+    for ( ptrdiff_t row=first; row<m_rows.size(); row++ ) {
+        m_rowOf[m_rows[row]] = row;
+    }
+}
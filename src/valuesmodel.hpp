@@ -0,0 +1,76 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: valuesmodel.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef VALUESMODEL_HPP
+#define VALUESMODEL_HPP
+
+#include <QAbstractTableModel>
+#include <QVector>
+#include <QSharedPointer>
+#include <QVariant>
+
+#include "ecuscalar.hpp"
+
+class ValuesModel : public QAbstractTableModel {
+
+    Q_OBJECT
+
+public:
+    enum {
+        VTableRole = Qt::UserRole // QStringList, empty for numeric scalars
+    };
+
+    explicit ValuesModel(QObject *parent = 0);
+    void setScalars(const QVector< QSharedPointer<ECUScalar> > &);
+    void clear();
+    void refresh(); // values changed
+    void setChanged(const QVector<ptrdiff_t> &); // highlights these scalars, clears the rest
+    ptrdiff_t addScalar(ptrdiff_t);   // returns the new row
+    void removeScalar(ptrdiff_t);
+    ptrdiff_t addScalars(const QVector<ptrdiff_t> &); // returns the first new row
+    void removeScalars(const QVector<ptrdiff_t> &);
+
+    ptrdiff_t scalarIndex(ptrdiff_t row) const {
+        return m_rows[row];
+    }
+    ptrdiff_t row(ptrdiff_t ind) const { // -1 if not in the table
+        return m_rowOf[ind];
+    }
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const;
+    QVariant data(const QModelIndex &, int role = Qt::DisplayRole) const;
+    bool setData(const QModelIndex &, const QVariant &, int role = Qt::EditRole);
+    Qt::ItemFlags flags(const QModelIndex &) const;
+
+signals:
+    void valueEdited(ptrdiff_t, double); // scalar index, physical value
+
+private:
+    QVector< QSharedPointer<ECUScalar> > m_scalars;
+    QVector<ptrdiff_t> m_rows;  // row -> scalar index
+    QVector<ptrdiff_t> m_rowOf; // scalar index -> row or -1
+    QVector<bool> m_changed;    // changed by the last reload
+
+    void updateRowsFrom(ptrdiff_t);
+
+};
+
+#endif // VALUESMODEL_HPP
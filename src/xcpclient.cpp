@@ -0,0 +1,542 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: xcpclient.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "xcpclient.hpp"
+#include "constants.hpp"
+#include "scalarcodec.hpp"
+#include "trace.hpp"
+
+#include <QUdpSocket>
+#include <QHostAddress>
+#include <QElapsedTimer>
+
+#include <limits>
+
+XcpClient::XcpClient() {
+}
+
+XcpClient::~XcpClient() {
+    disconnectFromSlave();
+}
+
+bool XcpClient::connectToSlave(const QString &host, quint16 port) {
+
+    disconnectFromSlave();
+
+    m_socket.reset(new QUdpSocket());
+    m_socket->connectToHost(host, port);
+
+    if ( !m_socket->waitForConnected(XCPTIMEOUT) ) {
+        m_error = "Can not reach " + host + ": " + m_socket->errorString();
+        m_socket.reset();
+        return false;
+    }
+
+    m_ctr = 0;
+    m_dtos.clear();
+
+    QByteArray cmd;
+    cmd.append(char(XCP_CONNECT));
+    cmd.append(char(0x00)); // normal mode
+
+    QByteArray res;
+
+    if ( !command(cmd, res) ) {
+        m_socket.reset();
+        return false;
+    }
+
+    if ( res.size() < 8 ) {
+        m_error = "Invalid CONNECT response";
+        m_socket.reset();
+        return false;
+    }
+
+    m_intel = (quint8(res[2]) & 0x01) == 0;
+    m_maxCto = quint8(res[3]);
+    m_maxDto = word(res.constData() + 4);
+    m_connected = true;
+
+    return true;
+}
+
+void XcpClient::disconnectFromSlave() {
+
+    if ( !m_socket ) {
+        return;
+    }
+
+    if ( m_connected ) {
+
+        if ( m_running ) {
+            stopDaq();
+        }
+
+        QByteArray res;
+        command(QByteArray(1, char(XCP_DISCONNECT)), res);
+    }
+
+    m_connected = false;
+    m_running = false;
+    m_socket.reset();
+}
+
+bool XcpClient::configureDaq(const QVector< QSharedPointer<ECUScalar> > &sigs, quint16 event, quint8 prescaler) {
+
+    if ( !m_connected || m_running ) {
+        m_error = m_connected ? "DAQ is running" : "Not connected";
+        return false;
+    }
+
+    // pack the signals into ODTs, one DTO each
+
+    m_signals = sigs;
+    m_odts.clear();
+
+    const quint16 capacity = m_maxDto - 1; // the PID comes first
+    quint16 used = capacity;
+
+    for ( ptrdiff_t i=0; i<sigs.size(); i++ ) {
+
+        const size_t size = ScalarCodec::length(sigs[i]->numType());
+
+        if ( size == 0 || size > sizeof(quint64) || size > capacity ) {
+            m_error = "Unsupported data type of " + sigs[i]->name();
+            return false;
+        }
+
+        if ( used + size > capacity || m_odts.last().size() == 255 ) {
+            m_odts.push_back(QVector<Entry>());
+            used = 0;
+        }
+
+        Entry entry;
+        entry.signal = i;
+        entry.size = quint8(size);
+        entry.offset = 1 + used;
+
+        m_odts.last().push_back(entry);
+        used += size;
+    }
+
+    if ( m_odts.isEmpty() || m_odts.size() > XCP_PID_SERV ) {
+        m_error = m_odts.isEmpty() ? "No signals" : "Too many signals for one DAQ list";
+        return false;
+    }
+
+    //
+
+    QByteArray cmd;
+    QByteArray res;
+
+    cmd.append(char(XCP_FREE_DAQ));
+
+    if ( !command(cmd, res) ) {
+        return false;
+    }
+
+    cmd.clear();
+    cmd.append(char(XCP_ALLOC_DAQ));
+    cmd.append(char(0));
+    putWord(cmd, 1);
+
+    if ( !command(cmd, res) ) {
+        return false;
+    }
+
+    cmd.clear();
+    cmd.append(char(XCP_ALLOC_ODT));
+    cmd.append(char(0));
+    putWord(cmd, 0);
+    cmd.append(char(m_odts.size()));
+
+    if ( !command(cmd, res) ) {
+        return false;
+    }
+
+    for ( ptrdiff_t odt=0; odt<m_odts.size(); odt++ ) {
+
+        cmd.clear();
+        cmd.append(char(XCP_ALLOC_ODT_ENTRY));
+        cmd.append(char(0));
+        putWord(cmd, 0);
+        cmd.append(char(odt));
+        cmd.append(char(m_odts[odt].size()));
+
+        if ( !command(cmd, res) ) {
+            return false;
+        }
+    }
+
+    for ( ptrdiff_t odt=0; odt<m_odts.size(); odt++ ) {
+
+        cmd.clear();
+        cmd.append(char(XCP_SET_DAQ_PTR));
+        cmd.append(char(0));
+        putWord(cmd, 0);
+        cmd.append(char(odt));
+        cmd.append(char(0));
+
+        if ( !command(cmd, res) ) {
+            return false;
+        }
+
+        for ( ptrdiff_t e=0; e<m_odts[odt].size(); e++ ) { // the slave moves the pointer
+
+            cmd.clear();
+            cmd.append(char(XCP_WRITE_DAQ));
+            cmd.append(char(0xFF)); // no bit offset
+            cmd.append(char(m_odts[odt][e].size));
+            cmd.append(char(0));    // address extension
+            putLong(cmd, sigs[m_odts[odt][e].signal]->addressNum());
+
+            if ( !command(cmd, res) ) {
+                return false;
+            }
+        }
+    }
+
+    cmd.clear();
+    cmd.append(char(XCP_SET_DAQ_LIST_MODE));
+    cmd.append(char(0x00)); // no timestamps, the arrival time is used
+    putWord(cmd, 0);
+    putWord(cmd, event);
+    cmd.append(char(prescaler ? prescaler : 1));
+    cmd.append(char(0));    // priority
+
+    if ( !command(cmd, res) ) {
+        return false;
+    }
+
+    m_values.fill(std::numeric_limits<double>::quiet_NaN(), sigs.size());
+
+    return true;
+}
+
+bool XcpClient::startDaq() {
+
+    if ( !m_connected || m_odts.isEmpty() ) {
+        m_error = "DAQ is not configured";
+        return false;
+    }
+
+    QByteArray cmd;
+    QByteArray res;
+
+    cmd.append(char(XCP_START_STOP_DAQ_LIST));
+    cmd.append(char(0x02)); // select
+    putWord(cmd, 0);
+
+    if ( !command(cmd, res) ) {
+        return false;
+    }
+
+    if ( res.size() < 2 ) {
+        m_error = "Invalid START_STOP_DAQ_LIST response";
+        return false;
+    }
+
+    m_firstPid = quint8(res[1]);
+
+    if ( m_firstPid + m_odts.size() > XCP_PID_SERV ) { // DTOs would look like responses
+        m_error = "Invalid FIRST_PID " + QString::number(m_firstPid) + " for "
+                + QString::number(m_odts.size()) + " ODTs";
+        return false;
+    }
+
+    m_nextOdt = 0;
+    m_dtos.clear();
+
+    cmd.clear();
+    cmd.append(char(XCP_START_STOP_SYNCH));
+    cmd.append(char(0x01)); // start selected
+
+    if ( !command(cmd, res) ) {
+        return false;
+    }
+
+    m_running = true;
+
+    return true;
+}
+
+bool XcpClient::stopDaq() {
+
+    if ( !m_connected ) {
+        return false;
+    }
+
+    QByteArray cmd;
+    QByteArray res;
+
+    cmd.append(char(XCP_START_STOP_SYNCH));
+    cmd.append(char(0x00)); // stop all
+
+    m_running = false;
+
+    const bool ok = command(cmd, res);
+    m_dtos.clear();
+
+    return ok;
+}
+
+bool XcpClient::readCycle(QVector<double> &values, int timeout) {
+
+    if ( !m_running ) {
+        m_error = "DAQ is not running";
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    forever {
+
+        while ( !m_dtos.isEmpty() ) {
+
+            if ( processDto(m_dtos.takeFirst()) ) {
+                values = m_values;
+                return true;
+            }
+        }
+
+        const int remaining = timeout - int(timer.elapsed());
+        QList<QByteArray> packets;
+
+        if ( remaining <= 0 || !receivePackets(remaining, packets) ) {
+            m_error = "No data from the slave";
+            return false;
+        }
+
+        for ( ptrdiff_t i=0; i<packets.size(); i++ ) {
+
+            if ( !packets[i].isEmpty() && quint8(packets[i][0]) < XCP_PID_SERV ) {
+                m_dtos.push_back(packets[i]);
+            }
+        }
+    }
+}
+
+bool XcpClient::command(const QByteArray &cmd, QByteArray &res) {
+
+    if ( m_connected && cmd.size() > m_maxCto ) {
+        m_error = "Command exceeds MAX_CTO";
+        return false;
+    }
+
+    if ( !sendPacket(cmd) ) {
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    forever {
+
+        const int remaining = XCPTIMEOUT - int(timer.elapsed());
+        QList<QByteArray> packets;
+
+        if ( remaining <= 0 || !receivePackets(remaining, packets) ) {
+            m_error = "No response from the slave";
+            return false;
+        }
+
+        bool answered = false;
+        bool ok = false;
+
+        for ( ptrdiff_t i=0; i<packets.size(); i++ ) {
+
+            if ( packets[i].isEmpty() ) {
+                continue;
+            }
+
+            const quint8 pid = quint8(packets[i][0]);
+
+            if ( pid < XCP_PID_SERV ) { // DAQ keeps running while commands are sent
+                m_dtos.push_back(packets[i]);
+            }
+            else if ( !answered && pid == XCP_PID_RES ) {
+                res = packets[i];
+                answered = ok = true;
+            }
+            else if ( !answered && pid == XCP_PID_ERR ) {
+
+                m_error = "Command 0x" + QString::number(quint8(cmd[0]), 16).toUpper()
+                        + " failed with XCP error 0x"
+                        + QString::number(packets[i].size() > 1 ? quint8(packets[i][1]) : 0, 16).toUpper();
+                answered = true;
+            }
+        }
+
+        if ( answered ) {
+            return ok;
+        }
+    }
+}
+
+bool XcpClient::sendPacket(const QByteArray &packet) {
+
+    // XCP on Ethernet header: LEN and CTR, always Intel byte order
+
+    QByteArray frame;
+    frame.reserve(4 + packet.size());
+    frame.append(char(packet.size() & 0xFF));
+    frame.append(char(packet.size() >> 8));
+    frame.append(char(m_ctr & 0xFF));
+    frame.append(char(m_ctr >> 8));
+    frame.append(packet);
+
+    m_ctr++;
+
+    if ( m_socket->write(frame) != frame.size() ) {
+        m_error = "Can not send: " + m_socket->errorString();
+        return false;
+    }
+
+    return true;
+}
+
+bool XcpClient::receivePackets(int timeout, QList<QByteArray> &packets) {
+
+    if ( !m_socket->hasPendingDatagrams() && !m_socket->waitForReadyRead(timeout) ) {
+        return false;
+    }
+
+    while ( m_socket->hasPendingDatagrams() ) {
+
+        QByteArray datagram(int(m_socket->pendingDatagramSize()), '\0');
+
+        if ( m_socket->readDatagram(datagram.data(), datagram.size()) < 0 ) {
+            break;
+        }
+
+        // one datagram may carry several packets
+
+        ptrdiff_t pos = 0;
+
+        while ( pos + 4 <= datagram.size() ) {
+
+            const ptrdiff_t len = quint8(datagram[int(pos)]) | (quint8(datagram[int(pos) + 1]) << 8);
+
+            if ( pos + 4 + len > datagram.size() ) {
+                break;
+            }
+
+            packets.push_back(datagram.mid(int(pos) + 4, int(len)));
+            pos += 4 + len;
+        }
+    }
+
+    return true;
+}
+
+bool XcpClient::processDto(const QByteArray &dto) {
+
+    const ptrdiff_t odt = ptrdiff_t(quint8(dto[0])) - m_firstPid;
+
+    if ( odt < 0 || odt >= m_odts.size() ) {
+        return false;
+    }
+
+    if ( odt != m_nextOdt ) { // a DTO was lost, wait for the next cycle
+
+        m_nextOdt = 0;
+        Trace::instance().count("xcp.lostCycles", 1);
+
+        if ( odt != 0 ) {
+            return false;
+        }
+    }
+
+    const QVector<Entry> &entries = m_odts[odt];
+
+    for ( ptrdiff_t e=0; e<entries.size(); e++ ) {
+
+        if ( entries[e].offset + entries[e].size > dto.size() ) { // short DTO, as good as lost
+
+            m_nextOdt = 0;
+            Trace::instance().count("xcp.lostCycles", 1);
+
+            return false;
+        }
+    }
+
+    char data[sizeof(quint64)];
+
+    for ( ptrdiff_t e=0; e<entries.size(); e++ ) {
+
+        const Entry &entry = entries[e];
+
+        // the decoders expect MSB first
+
+        for ( ptrdiff_t i=0; i<entry.size; i++ ) {
+            data[i] = m_intel ? dto[entry.offset + entry.size - 1 - i] : dto[entry.offset + i];
+        }
+
+        double val = 0;
+
+        if ( ScalarCodec::decode(*m_signals[entry.signal], data, val) ) {
+            m_values[entry.signal] = val;
+        }
+    }
+
+    m_nextOdt++;
+
+    if ( m_nextOdt < m_odts.size() ) {
+        return false;
+    }
+
+    m_nextOdt = 0;
+
+    return true;
+}
+
+void XcpClient::putWord(QByteArray &out, quint16 val) const {
+
+    if ( m_intel ) {
+        out.append(char(val & 0xFF));
+        out.append(char(val >> 8));
+    }
+    else {
+        out.append(char(val >> 8));
+        out.append(char(val & 0xFF));
+    }
+}
+
+void XcpClient::putLong(QByteArray &out, quint32 val) const {
+
+    if ( m_intel ) {
+        putWord(out, quint16(val & 0xFFFF));
+        putWord(out, quint16(val >> 16));
+    }
+    else {
+        putWord(out, quint16(val >> 16));
+        putWord(out, quint16(val & 0xFFFF));
+    }
+}
+
+quint16 XcpClient::word(const char *data) const {
+
+    if ( m_intel ) {
+        return quint16(quint8(data[0]) | (quint8(data[1]) << 8));
+    }
+
+    return quint16((quint8(data[0]) << 8) | quint8(data[1]));
+}
@@ -0,0 +1,102 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: xcpclient.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef XCPCLIENT_HPP
+#define XCPCLIENT_HPP
+
+#include <QString>
+#include <QVector>
+#include <QList>
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QScopedPointer>
+
+#include "ecuscalar.hpp"
+
+class QUdpSocket;
+
+// XCP-on-UDP master for synchronous data acquisition. The signals are
+// packed into the ODTs of one DAQ list, the slave sends them on an event
+// channel and every complete cycle gives one value per signal, decoded
+// like the hex values (ScalarCodec). Blocking; all calls must be made
+// from the same thread.
+
+class XcpClient {
+
+public:
+    XcpClient();
+    ~XcpClient();
+    bool connectToSlave(const QString &, quint16); // host, port
+    void disconnectFromSlave();
+    bool configureDaq(const QVector< QSharedPointer<ECUScalar> > &, quint16, quint8); // event channel, prescaler
+    bool startDaq();
+    bool stopDaq();
+    bool readCycle(QVector<double> &, int); // waits up to the timeout (ms) for one complete cycle
+
+    bool isConnected() const {
+        return m_connected;
+    }
+    bool isRunning() const {
+        return m_running;
+    }
+    QString errorString() const {
+        return m_error;
+    }
+    quint16 maxDto() const {
+        return m_maxDto;
+    }
+    ptrdiff_t odtCount() const {
+        return m_odts.size();
+    }
+
+private:
+    struct Entry {
+        ptrdiff_t signal;
+        quint8 size;
+        quint16 offset; // in the DTO, after the PID
+    };
+
+    QScopedPointer<QUdpSocket> m_socket;
+    quint16 m_ctr = 0;
+    bool m_connected = false;
+    bool m_running = false;
+    bool m_intel = true;  // byte order of the slave
+    quint8 m_maxCto = 8;
+    quint16 m_maxDto = 8;
+    quint8 m_firstPid = 0;
+    QString m_error;
+
+    QVector< QSharedPointer<ECUScalar> > m_signals;
+    QVector< QVector<Entry> > m_odts;
+    QVector<double> m_values;
+    ptrdiff_t m_nextOdt = 0;  // ODT expected next in the current cycle
+    QList<QByteArray> m_dtos; // received while waiting for a response
+
+    bool command(const QByteArray &, QByteArray &);
+    bool sendPacket(const QByteArray &);
+    bool receivePackets(int, QList<QByteArray> &);
+    bool processDto(const QByteArray &); // true if the cycle is complete
+    void putWord(QByteArray &, quint16) const;
+    void putLong(QByteArray &, quint32) const;
+    quint16 word(const char *) const;
+
+};
+
+#endif // XCPCLIENT_HPP
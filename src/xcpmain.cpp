@@ -0,0 +1,288 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: xcpmain.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "constants.hpp"
+#include "a2l.hpp"
+#include "ecuscalar.hpp"
+#include "scalarcodec.hpp"
+#include "labelindex.hpp"
+#include "xcpclient.hpp"
+#include "xcpsimulator.hpp"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QCommandLineOption>
+#include <QFile>
+#include <QTextStream>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QHash>
+#include <QSharedPointer>
+
+#include <cstdio>
+#include <cmath>
+
+// XCP-on-UDP measurement: records the selected a2l measurements from a
+// slave into a CSV file, or (--simulate) runs a localhost slave that
+// serves all of them.
+
+int main(int argc, char *argv[]) {
+
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QString(PROGNAME) + "-xcp");
+    QCoreApplication::setApplicationVersion(QString(PROGVER));
+
+    QTextStream err(stderr);
+
+    //
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Records a2l measurements over XCP on UDP.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+    parser.addPositionalArgument("a2l", "a2l file.");
+
+    const QCommandLineOption hostOption(
+                "host",
+                "Slave address (127.0.0.1 by default).",
+                "host", "127.0.0.1");
+    const QCommandLineOption portOption(
+                QStringList() << "p" << "port",
+                "Slave UDP port (" + QString::number(XCPDEFAULTPORT) + " by default).",
+                "port", QString::number(XCPDEFAULTPORT));
+    const QCommandLineOption labelsOption(
+                QStringList() << "l" << "labels",
+                "Comma separated measurement names or wild*card templates.",
+                "labels");
+    const QCommandLineOption eventOption(
+                QStringList() << "e" << "event",
+                "Event channel (0 by default).",
+                "channel", "0");
+    const QCommandLineOption prescalerOption(
+                "prescaler",
+                "Sample every n-th event (1 by default).",
+                "n", "1");
+    const QCommandLineOption durationOption(
+                QStringList() << "d" << "duration",
+                "Recording time in seconds (until the slave stops sending by default).",
+                "seconds", "0");
+    const QCommandLineOption outputOption(
+                QStringList() << "o" << "output",
+                "Output file (standard output by default).",
+                "file");
+    const QCommandLineOption simulateOption(
+                "simulate",
+                "Run a slave on the local host serving the a2l measurements.");
+
+    parser.addOption(hostOption);
+    parser.addOption(portOption);
+    parser.addOption(labelsOption);
+    parser.addOption(eventOption);
+    parser.addOption(prescalerOption);
+    parser.addOption(durationOption);
+    parser.addOption(outputOption);
+    parser.addOption(simulateOption);
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+
+    bool portOk = false;
+    const quint16 port = parser.value(portOption).toUShort(&portOk);
+
+    if ( args.size() != 1 || !portOk ) {
+        err << parser.helpText();
+        return CLIEXIT_USAGE;
+    }
+
+    bool ok = false;
+    const QVector< QSharedPointer<ECUScalar> > measurements = A2L::loadMeasurements(args[0], &ok);
+
+    if ( !ok ) {
+        err << "Error occured during a2l file parsing!\n";
+        return CLIEXIT_A2L;
+    }
+
+    //
+
+    if ( parser.isSet(simulateOption) ) {
+
+        XcpSimulator simulator(measurements);
+
+        QObject::connect(&simulator, &XcpSimulator::message, [&err](const QString &msg) {
+            err << QDateTime::currentDateTime().toString("[yyyy-MM-dd_hh-mm-ss]") + " " + msg << "\n";
+            err.flush();
+        });
+
+        if ( !simulator.listen(port) ) {
+            err << "Can not listen on port " << port << ": " << simulator.errorString() << "\n";
+            return CLIEXIT_OUTPUT;
+        }
+
+        err << QDateTime::currentDateTime().toString("[yyyy-MM-dd_hh-mm-ss]") + " Serving "
+            << measurements.size() << " measurements on 127.0.0.1:" << port << "\n";
+        err.flush();
+
+        return app.exec();
+    }
+
+    // measurements to record, in the order they were asked for
+
+    int status = CLIEXIT_OK;
+    QVector< QSharedPointer<ECUScalar> > selected;
+
+    if ( !parser.isSet(labelsOption) ) {
+        selected = measurements;
+    }
+    else {
+
+        const QStringList templs = parser.value(labelsOption).split(',', SKIPEMPTYPARTS);
+
+        QHash<QString, ptrdiff_t> byName;
+        byName.reserve(measurements.size());
+
+        for ( ptrdiff_t i=0; i<measurements.size(); i++ ) {
+            byName.insert(measurements[i]->name(), i);
+        }
+
+        LabelIndex index;
+        QVector<bool> taken(measurements.size(), false);
+
+        for ( ptrdiff_t n=0; n<templs.size(); n++ ) {
+
+            QVector<ptrdiff_t> found;
+
+            if ( LabelIndex::queryMode(templs[n]) == SEARCH_WILDCARD ) {
+
+                if ( index.size() == 0 ) {
+                    index.build(measurements);
+                }
+
+                found = index.search(templs[n]);
+            }
+            else if ( byName.contains(templs[n]) ) {
+                found.push_back(byName.value(templs[n]));
+            }
+
+            if ( found.isEmpty() ) {
+
+                err << "Unknown measurement " << templs[n] << "\n";
+                status = CLIEXIT_UNKNOWNLABEL;
+            }
+
+            for ( ptrdiff_t i=0; i<found.size(); i++ ) {
+
+                if ( !taken[found[i]] ) {
+                    taken[found[i]] = true;
+                    selected.push_back(measurements[found[i]]);
+                }
+            }
+        }
+    }
+
+    if ( selected.isEmpty() ) {
+        err << "Nothing to record!\n";
+        return status == CLIEXIT_OK ? CLIEXIT_USAGE : status;
+    }
+
+    //
+
+    XcpClient client;
+
+    if ( !client.connectToSlave(parser.value(hostOption), port)
+         || !client.configureDaq(selected, parser.value(eventOption).toUShort(),
+                                 quint8(parser.value(prescalerOption).toUShort()))
+         || !client.startDaq() ) {
+
+        err << client.errorString() << "\n";
+        return CLIEXIT_NODATA;
+    }
+
+    err << "Recording " << selected.size() << " measurements in "
+        << client.odtCount() << " ODTs\n";
+    err.flush();
+
+    QFile outFile;
+
+    if ( parser.isSet(outputOption) ) {
+        outFile.setFileName(parser.value(outputOption));
+        ok = outFile.open(QIODevice::WriteOnly | QIODevice::Truncate);
+    }
+    else {
+        ok = outFile.open(stdout, QIODevice::WriteOnly);
+    }
+
+    if ( !ok ) {
+        err << "Can not write " << outFile.fileName() << "!\n";
+        return CLIEXIT_OUTPUT;
+    }
+
+    QTextStream out(&outFile);
+    out.setCodec("UTF-8");
+
+    out << "time [ms]";
+
+    for ( ptrdiff_t i=0; i<selected.size(); i++ ) {
+        out << ";" << selected[i]->name() << " " << selected[i]->dimension();
+    }
+
+    out << "\n";
+
+    //
+
+    const qint64 duration = qint64(parser.value(durationOption).toDouble() * 1000);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QVector<double> values;
+    qint64 cycles = 0;
+
+    while ( duration <= 0 || timer.elapsed() < duration ) {
+
+        if ( !client.readCycle(values, 10 * XCPTIMEOUT) ) {
+            err << client.errorString() << "\n";
+            break;
+        }
+
+        out << timer.elapsed();
+
+        for ( ptrdiff_t i=0; i<values.size(); i++ ) {
+
+            out << ";";
+
+            if ( !std::isnan(values[i]) ) {
+                out << ScalarCodec::toDisplayString(*selected[i], values[i]);
+            }
+        }
+
+        out << "\n";
+        cycles++;
+    }
+
+    out.flush();
+    client.disconnectFromSlave();
+
+    err << cycles << " cycles recorded\n";
+
+    return cycles > 0 ? status : CLIEXIT_NODATA;
+}
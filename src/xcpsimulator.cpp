@@ -0,0 +1,524 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: xcpsimulator.cpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "xcpsimulator.hpp"
+#include "constants.hpp"
+#include "scalarcodec.hpp"
+
+#include <QUdpSocket>
+#include <QTimer>
+
+#include <cmath>
+#include <cstring>
+
+XcpSimulator::XcpSimulator(const QVector< QSharedPointer<ECUScalar> > &measurements, QObject *parent) :
+    QObject(parent),
+    m_socket(new QUdpSocket(this)),
+    m_measurements(measurements) {
+
+    for ( ptrdiff_t i=0; i<m_measurements.size(); i++ ) {
+        m_byAddress.insert(m_measurements[i]->addressNum(), i);
+    }
+
+    const int periods[] = {10, 100, 1000}; // ms, one per event channel
+
+    for ( quint16 ch=0; ch<sizeof(periods)/sizeof(periods[0]); ch++ ) {
+
+        QTimer *timer = new QTimer(this);
+        timer->setTimerType(Qt::PreciseTimer);
+        timer->setInterval(periods[ch]);
+        connect(timer, &QTimer::timeout, [this, ch]() { sendCycle(ch); });
+
+        m_events.push_back(timer);
+    }
+
+    connect(m_socket, SIGNAL(readyRead()), this, SLOT(readCommands()));
+}
+
+XcpSimulator::~XcpSimulator() {
+}
+
+bool XcpSimulator::listen(quint16 port) {
+
+    if ( !m_socket->bind(QHostAddress::LocalHost, port) ) {
+        return false;
+    }
+
+    m_clock.start();
+
+    for ( ptrdiff_t i=0; i<m_events.size(); i++ ) {
+        m_events[i]->start();
+    }
+
+    return true;
+}
+
+QString XcpSimulator::errorString() const {
+    return m_socket->errorString();
+}
+
+void XcpSimulator::readCommands() {
+
+    while ( m_socket->hasPendingDatagrams() ) {
+
+        QByteArray datagram(int(m_socket->pendingDatagramSize()), '\0');
+        QHostAddress sender;
+        quint16 senderPort = 0;
+
+        if ( m_socket->readDatagram(datagram.data(), datagram.size(), &sender, &senderPort) < 0 ) {
+            break;
+        }
+
+        ptrdiff_t pos = 0;
+
+        while ( pos + 4 <= datagram.size() ) {
+
+            const ptrdiff_t len = quint8(datagram[int(pos)]) | (quint8(datagram[int(pos) + 1]) << 8);
+
+            if ( len == 0 || pos + 4 + len > datagram.size() ) {
+                break;
+            }
+
+            const QByteArray cmd = datagram.mid(int(pos) + 4, int(len));
+            pos += 4 + len;
+
+            if ( quint8(cmd[0]) == XCP_CONNECT ) {
+                m_master = sender;
+                m_masterPort = senderPort;
+            }
+            else if ( !m_connected || sender != m_master || senderPort != m_masterPort ) {
+                continue; // a slave ignores everything but CONNECT until connected
+            }
+
+            handleCommand(cmd);
+        }
+    }
+}
+
+void XcpSimulator::handleCommand(const QByteArray &cmd) {
+
+    // Intel byte order, see CONNECT
+
+    const ptrdiff_t size = cmd.size();
+    const quint8 code = quint8(cmd[0]);
+
+    auto word = [&cmd](ptrdiff_t pos) {
+        return quint16(quint8(cmd[int(pos)]) | (quint8(cmd[int(pos) + 1]) << 8));
+    };
+
+    QByteArray res(1, char(XCP_PID_RES));
+
+    switch ( code ) {
+
+    case XCP_CONNECT:
+
+        if ( size < 2 ) {
+            sendError(XCP_ERR_CMD_SYNTAX);
+            return;
+        }
+
+        if ( !m_connected ) {
+            emit message("Master " + m_master.toString() + ":" + QString::number(m_masterPort) + " connected");
+        }
+
+        m_connected = true;
+        resetDaq();
+
+        res.append(char(0x04)); // resources: DAQ only
+        res.append(char(0x00)); // Intel byte order, byte granularity
+        res.append(char(8));    // MAX_CTO
+        res.append(char(XCPMAXDTO & 0xFF));
+        res.append(char(XCPMAXDTO >> 8));
+        res.append(char(1));    // protocol layer version
+        res.append(char(1));    // transport layer version
+        break;
+
+    case XCP_DISCONNECT:
+
+        sendPacket(res);
+        resetDaq();
+        m_connected = false;
+        emit message("Master disconnected");
+        return;
+
+    case XCP_GET_STATUS:
+
+        res.append(char(m_running ? 0x40 : 0x00)); // DAQ_RUNNING
+        res.append(char(0x00)); // no protection
+        res.append(char(0x00));
+        res.append(char(0x00));
+        res.append(char(0x00));
+        break;
+
+    case XCP_FREE_DAQ:
+
+        resetDaq();
+        break;
+
+    case XCP_ALLOC_DAQ:
+
+        if ( size < 4 ) {
+            sendError(XCP_ERR_CMD_SYNTAX);
+            return;
+        }
+
+        if ( m_daqAllocated || !m_odts.isEmpty() ) {
+            sendError(XCP_ERR_SEQUENCE);
+            return;
+        }
+
+        if ( word(2) > 1 ) {
+            sendError(XCP_ERR_MEMORY_OVERFLOW);
+            return;
+        }
+
+        m_daqAllocated = word(2) == 1;
+        break;
+
+    case XCP_ALLOC_ODT:
+
+        if ( size < 5 ) {
+            sendError(XCP_ERR_CMD_SYNTAX);
+            return;
+        }
+
+        if ( word(2) != 0 ) {
+            sendError(XCP_ERR_OUT_OF_RANGE);
+            return;
+        }
+
+        if ( !m_daqAllocated || !m_odts.isEmpty() ) {
+            sendError(XCP_ERR_SEQUENCE);
+            return;
+        }
+
+        if ( quint8(cmd[4]) == 0 || quint8(cmd[4]) > XCP_PID_SERV ) {
+            sendError(XCP_ERR_MEMORY_OVERFLOW);
+            return;
+        }
+
+        m_odts.resize(quint8(cmd[4]));
+        break;
+
+    case XCP_ALLOC_ODT_ENTRY:
+
+        if ( size < 6 ) {
+            sendError(XCP_ERR_CMD_SYNTAX);
+            return;
+        }
+
+        if ( word(2) != 0 || quint8(cmd[4]) >= m_odts.size() ) {
+            sendError(XCP_ERR_OUT_OF_RANGE);
+            return;
+        }
+
+        if ( !m_odts[quint8(cmd[4])].isEmpty() ) {
+            sendError(XCP_ERR_SEQUENCE);
+            return;
+        }
+
+        if ( quint8(cmd[5]) == 0 || quint8(cmd[5]) > XCPMAXDTO - 1 ) {
+            sendError(XCP_ERR_MEMORY_OVERFLOW);
+            return;
+        }
+
+        m_odts[quint8(cmd[4])].fill(Entry{0, 0}, quint8(cmd[5]));
+        break;
+
+    case XCP_SET_DAQ_PTR:
+
+        if ( size < 6 ) {
+            sendError(XCP_ERR_CMD_SYNTAX);
+            return;
+        }
+
+        if ( m_running ) {
+            sendError(XCP_ERR_SEQUENCE);
+            return;
+        }
+
+        if ( word(2) != 0 || quint8(cmd[4]) >= m_odts.size()
+             || quint8(cmd[5]) >= m_odts[quint8(cmd[4])].size() ) {
+            sendError(XCP_ERR_OUT_OF_RANGE);
+            return;
+        }
+
+        m_ptrOdt = quint8(cmd[4]);
+        m_ptrEntry = quint8(cmd[5]);
+        break;
+
+    case XCP_WRITE_DAQ: {
+
+        if ( size < 8 ) {
+            sendError(XCP_ERR_CMD_SYNTAX);
+            return;
+        }
+
+        if ( m_ptrOdt < 0 || m_ptrEntry >= m_odts[m_ptrOdt].size() ) {
+            sendError(XCP_ERR_SEQUENCE);
+            return;
+        }
+
+        const quint8 entrySize = quint8(cmd[2]);
+
+        if ( entrySize == 0 || entrySize > sizeof(quint64) ) {
+            sendError(XCP_ERR_OUT_OF_RANGE);
+            return;
+        }
+
+        QVector<Entry> &odt = m_odts[m_ptrOdt];
+        ptrdiff_t used = entrySize;
+
+        for ( ptrdiff_t i=0; i<odt.size(); i++ ) {
+
+            if ( i != m_ptrEntry ) {
+                used += odt[i].size;
+            }
+        }
+
+        if ( used > XCPMAXDTO - 1 ) {
+            sendError(XCP_ERR_DAQ_CONFIG);
+            return;
+        }
+
+        odt[m_ptrEntry].address = quint32(word(4)) | (quint32(word(6)) << 16);
+        odt[m_ptrEntry].size = entrySize;
+        m_ptrEntry++; // auto increment
+
+        break;
+    }
+
+    case XCP_SET_DAQ_LIST_MODE:
+
+        if ( size < 8 ) {
+            sendError(XCP_ERR_CMD_SYNTAX);
+            return;
+        }
+
+        if ( word(2) != 0 || !m_daqAllocated || word(4) >= m_events.size() ) {
+            sendError(XCP_ERR_OUT_OF_RANGE);
+            return;
+        }
+
+        if ( quint8(cmd[1]) & 0x10 ) { // timestamps are not supported
+            sendError(XCP_ERR_CMD_SYNTAX);
+            return;
+        }
+
+        m_event = word(4);
+        m_prescaler = quint8(cmd[6]) ? quint8(cmd[6]) : 1;
+        m_prescalerCounter = 0;
+        break;
+
+    case XCP_START_STOP_DAQ_LIST: {
+
+        if ( size < 4 ) {
+            sendError(XCP_ERR_CMD_SYNTAX);
+            return;
+        }
+
+        if ( word(2) != 0 || !m_daqAllocated || quint8(cmd[1]) > 2 ) {
+            sendError(XCP_ERR_OUT_OF_RANGE);
+            return;
+        }
+
+        bool configured = !m_odts.isEmpty();
+
+        for ( ptrdiff_t i=0; i<m_odts.size(); i++ ) {
+
+            for ( ptrdiff_t j=0; j<m_odts[i].size(); j++ ) {
+                configured = configured && m_odts[i][j].size != 0;
+            }
+        }
+
+        if ( quint8(cmd[1]) != 0 && !configured ) {
+            sendError(XCP_ERR_DAQ_CONFIG);
+            return;
+        }
+
+        if ( quint8(cmd[1]) == 0 ) {
+            m_running = false;
+        }
+        else if ( quint8(cmd[1]) == 1 ) {
+            m_running = true;
+            m_prescalerCounter = 0;
+        }
+        else {
+            m_selected = true;
+        }
+
+        res.append(char(0)); // FIRST_PID
+        break;
+    }
+
+    case XCP_START_STOP_SYNCH:
+
+        if ( size < 2 ) {
+            sendError(XCP_ERR_CMD_SYNTAX);
+            return;
+        }
+
+        if ( quint8(cmd[1]) == 1 ) {
+
+            if ( !m_selected ) {
+                sendError(XCP_ERR_SEQUENCE);
+                return;
+            }
+
+            m_running = true;
+            m_prescalerCounter = 0;
+            emit message("DAQ started on event " + QString::number(m_event));
+        }
+        else if ( quint8(cmd[1]) == 0 || quint8(cmd[1]) == 2 ) {
+
+            if ( m_running ) {
+                emit message("DAQ stopped");
+            }
+
+            m_running = false;
+        }
+        else {
+            sendError(XCP_ERR_OUT_OF_RANGE);
+            return;
+        }
+
+        m_selected = false;
+        break;
+
+    default:
+
+        sendError(XCP_ERR_CMD_UNKNOWN);
+        return;
+    }
+
+    sendPacket(res);
+}
+
+void XcpSimulator::sendCycle(quint16 ch) {
+
+    if ( !m_running || ch != m_event ) {
+        return;
+    }
+
+    if ( ++m_prescalerCounter < m_prescaler ) {
+        return;
+    }
+
+    m_prescalerCounter = 0;
+
+    for ( ptrdiff_t odt=0; odt<m_odts.size(); odt++ ) {
+
+        QByteArray dto(1, char(odt)); // FIRST_PID is 0
+        char data[sizeof(quint64)];
+
+        for ( ptrdiff_t e=0; e<m_odts[odt].size(); e++ ) {
+
+            const Entry &entry = m_odts[odt][e];
+            sample(entry, data);
+
+            for ( ptrdiff_t i=entry.size-1; i>=0; i-- ) { // MSB first -> Intel
+                dto.append(data[i]);
+            }
+        }
+
+        sendPacket(dto);
+    }
+}
+
+bool XcpSimulator::sendPacket(const QByteArray &packet) {
+
+    QByteArray frame;
+    frame.reserve(4 + packet.size());
+    frame.append(char(packet.size() & 0xFF));
+    frame.append(char(packet.size() >> 8));
+    frame.append(char(m_ctr & 0xFF));
+    frame.append(char(m_ctr >> 8));
+    frame.append(packet);
+
+    m_ctr++;
+
+    return m_socket->writeDatagram(frame, m_master, m_masterPort) == frame.size();
+}
+
+void XcpSimulator::sendError(quint8 err) {
+
+    QByteArray res;
+    res.append(char(XCP_PID_ERR));
+    res.append(char(err));
+
+    sendPacket(res);
+}
+
+void XcpSimulator::resetDaq() {
+
+    m_daqAllocated = false;
+    m_odts.clear();
+    m_ptrOdt = -1;
+    m_ptrEntry = 0;
+    m_event = 0;
+    m_prescaler = 1;
+    m_prescalerCounter = 0;
+    m_selected = false;
+    m_running = false;
+}
+
+void XcpSimulator::sample(const Entry &entry, char *data) const {
+
+    memset(data, 0, entry.size);
+
+    const QHash<quint32, ptrdiff_t>::const_iterator it = m_byAddress.constFind(entry.address);
+
+    if ( it == m_byAddress.constEnd() ) {
+        return;
+    }
+
+    const ECUScalar &meas = *m_measurements[it.value()];
+
+    if ( ScalarCodec::length(meas.numType()) != entry.size ) {
+        return;
+    }
+
+    // every measurement gets its own period so the signals differ
+
+    const double t = m_clock.elapsed() / 1000.0;
+    double val = 0;
+
+    if ( meas.type() == VARTYPE_SCALAR_VTAB ) {
+
+        const ptrdiff_t n = meas.vTable().size();
+        val = n > 0 ? qint64(t) % n : 0;
+    }
+    else {
+
+        double minVal = meas.minValueHard();
+        double maxVal = meas.maxValueHard();
+
+        if ( !(maxVal > minVal) ) {
+            minVal = 0;
+            maxVal = 100;
+        }
+
+        const double period = 2.0 + (it.value() % 8); // s
+        const double phase = 2 * std::acos(-1.0) * t / period;
+        val = minVal + (maxVal - minVal) * (0.5 + 0.5 * std::sin(phase));
+    }
+
+    ScalarCodec::encode(meas, val, data);
+}
@@ -0,0 +1,97 @@
+/*
+    diecat
+    A2L/HEX file reader.
+
+    File: xcpsimulator.hpp
+
+    Copyright (C) 2014 Artem Petrov <pa2311@gmail.com>
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+    GNU General Public License for more details.
+    You should have received a copy of the GNU General Public License
+    along with this program. If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef XCPSIMULATOR_HPP
+#define XCPSIMULATOR_HPP
+
+#include <QObject>
+#include <QString>
+#include <QVector>
+#include <QHash>
+#include <QByteArray>
+#include <QSharedPointer>
+#include <QHostAddress>
+#include <QElapsedTimer>
+
+#include "ecuscalar.hpp"
+
+class QUdpSocket;
+class QTimer;
+
+// XCP-on-UDP slave on the local host for trying the DAQ client without an
+// ECU. It supports the commands XcpClient sends, one DAQ list and three
+// event channels: 0 - 10 ms, 1 - 100 ms, 2 - 1000 ms. Addresses of the a2l
+// measurements give sine waves between their limits (VTAB measurements
+// step through their texts), any other address reads as zero.
+
+class XcpSimulator : public QObject {
+
+    Q_OBJECT
+
+public:
+    explicit XcpSimulator(const QVector< QSharedPointer<ECUScalar> > &, QObject *parent = 0);
+    ~XcpSimulator();
+    bool listen(quint16);
+    QString errorString() const;
+
+signals:
+    void message(QString);
+
+private slots:
+    void readCommands();
+
+private:
+    struct Entry {
+        quint32 address;
+        quint8 size;
+    };
+
+    QUdpSocket *m_socket;
+    QVector<QTimer *> m_events;
+    QElapsedTimer m_clock;
+
+    QVector< QSharedPointer<ECUScalar> > m_measurements;
+    QHash<quint32, ptrdiff_t> m_byAddress;
+
+    QHostAddress m_master;
+    quint16 m_masterPort = 0;
+    quint16 m_ctr = 0;
+    bool m_connected = false;
+
+    bool m_daqAllocated = false;
+    QVector< QVector<Entry> > m_odts;
+    ptrdiff_t m_ptrOdt = -1;
+    ptrdiff_t m_ptrEntry = 0;
+    quint16 m_event = 0;
+    quint8 m_prescaler = 1;
+    quint8 m_prescalerCounter = 0;
+    bool m_selected = false;
+    bool m_running = false;
+
+    void handleCommand(const QByteArray &);
+    void sendCycle(quint16);
+    bool sendPacket(const QByteArray &);
+    void sendError(quint8);
+    void resetDaq();
+    void sample(const Entry &, char *) const;
+
+};
+
+#endif // XCPSIMULATOR_HPP